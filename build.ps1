@@ -1 +1,11 @@
-tcc -mwindows src\mamba.c src\spider_bmp.c -o mamba.exe
\ No newline at end of file
+tcc -mwindows src\old\mamba.c src\old\game.c src\old\snake.c src\old\render.c src\old\counter.c src\old\spider_bmp.c src\old\platform.c src\old\asset_pack.c src\old\bmp.c src\old\bmp_stream.c src\old\audio_mixer.c src\old\input_queue.c src\old\input_thread.c src\old\level.c src\old\prefs.c src\old\rewind.c src\old\scaler.c src\old\triple_buffer.c src\old\frame_stats.c src\old\work_pool.c src\old\trace.c -lwinmm -o mamba.exe
+tcc src\old\pack_assets.c src\old\asset_pack.c src\old\bmp.c src\old\level.c src\old\game.c src\old\snake.c src\old\platform.c src\old\spider_bmp.c src\old\trace.c -o pack_assets.exe
+.\pack_assets.exe mamba.pak background=src\resource_chunk.bin levels=src\levels.txt
+tcc src\old\bench.c src\old\counter.c src\old\snapshot.c src\old\spider_batch.c src\old\scaler.c src\old\work_pool.c src\old\game.c src\old\snake.c src\old\render.c src\old\bmp_stream.c src\old\bmp.c src\old\platform.c src\old\spider_bmp.c src\old\trace.c -o bench.exe
+tcc src\old\simulate.c src\old\batch.c src\old\level.c src\old\game.c src\old\snake.c src\old\work_pool.c src\old\platform.c src\old\trace.c -o simulate.exe
+tcc src\old\solve.c src\old\solver.c src\old\level.c src\old\game.c src\old\snake.c src\old\work_pool.c src\old\platform.c src\old\trace.c -o solve.exe
+tcc src\old\rules_check.c src\old\game.c src\old\snake.c src\old\platform.c src\old\trace.c -o rules_check.exe
+.\rules_check.exe
+tcc src\old\gen_levels.c src\old\level_gen.c src\old\batch.c src\old\level.c src\old\game.c src\old\snake.c src\old\work_pool.c src\old\platform.c src\old\trace.c -o gen_levels.exe
+tcc src\old\input_probe.c src\old\input_thread.c src\old\input_queue.c src\old\game.c src\old\snake.c src\old\platform.c src\old\trace.c -o input_probe.exe
+tcc -shared src\old\mamba_env.c src\old\game.c src\old\snake.c src\old\render.c src\old\bmp_stream.c src\old\bmp.c src\old\platform.c src\old\spider_bmp.c src\old\trace.c -o mamba_env.dll
@@ -0,0 +1,152 @@
+#include "asset_pack.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- START: Reader ---
+bool asset_pack_open(AssetPack* pack, const char* path) {
+    memset(pack, 0, sizeof(*pack));
+    if (!platform_map_file(path, &pack->file)) return false;
+
+    const uint8_t* base = pack->file.data;
+    size_t size = pack->file.size;
+    if (size < sizeof(AssetPackHeader)) goto invalid;
+
+    const AssetPackHeader* header = (const AssetPackHeader*)base;
+    if (header->magic != ASSET_PACK_MAGIC || header->version != ASSET_PACK_VERSION) goto invalid;
+    if (sizeof(AssetPackHeader) + (size_t)header->entry_count * sizeof(AssetPackEntry) > size) goto invalid;
+
+    const AssetPackEntry* entries = (const AssetPackEntry*)(base + sizeof(AssetPackHeader));
+    for (uint32_t i = 0; i < header->entry_count; i++) {
+        const AssetPackEntry* e = &entries[i];
+        if (e->offset % ASSET_PACK_ALIGN != 0) goto invalid;
+        if ((size_t)e->offset + e->size > size) goto invalid;
+        if (e->kind == ASSET_IMAGE && (uint64_t)e->width * e->height * 4 != e->size) goto invalid;
+    }
+
+    pack->header = header;
+    pack->entries = entries;
+    return true;
+
+invalid:
+    platform_unmap_file(&pack->file);
+    memset(pack, 0, sizeof(*pack));
+    return false;
+}
+
+void asset_pack_close(AssetPack* pack) {
+    platform_unmap_file(&pack->file);
+    memset(pack, 0, sizeof(*pack));
+}
+
+const AssetPackEntry* asset_pack_find(const AssetPack* pack, const char* name) {
+    if (!pack->header) return NULL;
+    for (uint32_t i = 0; i < pack->header->entry_count; i++) {
+        if (strncmp(pack->entries[i].name, name, ASSET_NAME_MAX) == 0) return &pack->entries[i];
+    }
+    return NULL;
+}
+
+const void* asset_pack_data(const AssetPack* pack, const AssetPackEntry* entry) {
+    return pack->file.data + entry->offset;
+}
+
+const uint32_t* asset_pack_image(const AssetPack* pack, const char* name, int width, int height) {
+    const AssetPackEntry* e = asset_pack_find(pack, name);
+    if (!e || e->kind != ASSET_IMAGE || e->width != (uint32_t)width || e->height != (uint32_t)height) return NULL;
+    return (const uint32_t*)asset_pack_data(pack, e);
+}
+// --- END: Reader ---
+
+// --- START: Writer (offline tools) ---
+void asset_pack_writer_init(AssetPackWriter* w) {
+    memset(w, 0, sizeof(*w));
+}
+
+bool asset_pack_writer_add(AssetPackWriter* w, const char* name, AssetKind kind,
+                           uint32_t width, uint32_t height, const void* data, uint32_t size) {
+    if (strlen(name) >= ASSET_NAME_MAX) return false;
+
+    int slot = w->count;
+    for (int i = 0; i < w->count; i++) {
+        if (strncmp(w->entries[i].name, name, ASSET_NAME_MAX) == 0) { slot = i; break; }
+    }
+
+    if (slot == w->count && w->count == w->capacity) {
+        int new_capacity = w->capacity ? w->capacity * 2 : 16;
+        AssetPackEntry* entries = realloc(w->entries, (size_t)new_capacity * sizeof(AssetPackEntry));
+        if (!entries) return false;
+        w->entries = entries;
+        uint8_t** payloads = realloc(w->payloads, (size_t)new_capacity * sizeof(uint8_t*));
+        if (!payloads) return false;
+        w->payloads = payloads;
+        w->capacity = new_capacity;
+    }
+
+    uint8_t* copy = malloc(size ? size : 1);
+    if (!copy) return false;
+    memcpy(copy, data, size);
+
+    if (slot < w->count) {
+        free(w->payloads[slot]);
+    } else {
+        w->count++;
+    }
+
+    AssetPackEntry* e = &w->entries[slot];
+    memset(e, 0, sizeof(*e));
+    memcpy(e->name, name, strlen(name));
+    e->kind = kind;
+    e->width = width;
+    e->height = height;
+    e->size = size;
+    w->payloads[slot] = copy;
+    return true;
+}
+
+static uint32_t align_up(uint32_t v) {
+    return (v + ASSET_PACK_ALIGN - 1) & ~(uint32_t)(ASSET_PACK_ALIGN - 1);
+}
+
+bool asset_pack_writer_save(const AssetPackWriter* w, const char* path) {
+    AssetPackHeader header = { ASSET_PACK_MAGIC, ASSET_PACK_VERSION, (uint32_t)w->count, 0 };
+
+    // Lay out payloads after the table of contents
+    AssetPackEntry* toc = malloc((size_t)(w->count ? w->count : 1) * sizeof(AssetPackEntry));
+    if (!toc) return false;
+    uint32_t offset = align_up((uint32_t)(sizeof(header) + (size_t)w->count * sizeof(AssetPackEntry)));
+    for (int i = 0; i < w->count; i++) {
+        toc[i] = w->entries[i];
+        toc[i].offset = offset;
+        offset = align_up(offset + toc[i].size);
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) { free(toc); return false; }
+
+    static const uint8_t zeros[ASSET_PACK_ALIGN];
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    if (w->count) ok = ok && fwrite(toc, sizeof(AssetPackEntry), (size_t)w->count, f) == (size_t)w->count;
+    uint32_t pos = (uint32_t)(sizeof(header) + (size_t)w->count * sizeof(AssetPackEntry));
+    for (int i = 0; ok && i < w->count; i++) {
+        ok = fwrite(zeros, 1, toc[i].offset - pos, f) == toc[i].offset - pos;
+        ok = ok && fwrite(w->payloads[i], 1, toc[i].size, f) == toc[i].size;
+        pos = toc[i].offset + toc[i].size;
+    }
+    // Pad the tail so the last payload can be read in whole aligned blocks
+    uint32_t tail = align_up(pos) - pos;
+    if (ok && tail) ok = fwrite(zeros, 1, tail, f) == tail;
+
+    ok = (fclose(f) == 0) && ok;
+    free(toc);
+    return ok;
+}
+
+void asset_pack_writer_free(AssetPackWriter* w) {
+    for (int i = 0; i < w->count; i++) free(w->payloads[i]);
+    free(w->payloads);
+    free(w->entries);
+    memset(w, 0, sizeof(*w));
+}
+// --- END: Writer ---
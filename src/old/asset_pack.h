@@ -0,0 +1,79 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "platform.h"
+
+// mamba.pak: one file holding every bitmap and sound the game needs, already in
+// the format the game uses, so startup is a single map and assets are used in place.
+//
+// Layout (all little-endian):
+//   AssetPackHeader
+//   AssetPackEntry[entry_count]     table of contents
+//   payloads, each starting on an ASSET_PACK_ALIGN boundary
+//
+// Images are stored as width * height uint32_t pixels in 0xAARRGGBB, i.e. the
+// framebuffer format, rows top-down with no padding. Sounds are stored as the
+// original RIFF/WAVE blob.
+
+#define ASSET_PACK_MAGIC 0x4B41504Du // "MPAK"
+#define ASSET_PACK_VERSION 1
+#define ASSET_PACK_ALIGN 64
+#define ASSET_NAME_MAX 24
+
+typedef enum {
+    ASSET_IMAGE = 1,
+    ASSET_WAVE = 2,
+    ASSET_BLOB = 3
+} AssetKind;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t reserved;
+} AssetPackHeader;
+
+typedef struct {
+    char name[ASSET_NAME_MAX]; // NUL-padded
+    uint32_t kind;             // AssetKind
+    uint32_t width;            // Images only
+    uint32_t height;           // Images only
+    uint32_t offset;           // From start of file, multiple of ASSET_PACK_ALIGN
+    uint32_t size;             // Payload bytes
+    uint32_t reserved;
+} AssetPackEntry;
+
+// --- START: Reader ---
+typedef struct {
+    MappedFile file;
+    const AssetPackHeader* header;
+    const AssetPackEntry* entries;
+} AssetPack;
+
+bool asset_pack_open(AssetPack* pack, const char* path);
+void asset_pack_close(AssetPack* pack);
+const AssetPackEntry* asset_pack_find(const AssetPack* pack, const char* name);
+const void* asset_pack_data(const AssetPack* pack, const AssetPackEntry* entry);
+// Convenience: returns the pixels of an image entry if it exists with the given size, else NULL.
+const uint32_t* asset_pack_image(const AssetPack* pack, const char* name, int width, int height);
+// --- END: Reader ---
+
+// --- START: Writer (offline tools) ---
+typedef struct {
+    AssetPackEntry* entries;
+    uint8_t** payloads;
+    int count;
+    int capacity;
+} AssetPackWriter;
+
+void asset_pack_writer_init(AssetPackWriter* w);
+// Copies data. Adding a name that already exists replaces the earlier entry.
+bool asset_pack_writer_add(AssetPackWriter* w, const char* name, AssetKind kind,
+                           uint32_t width, uint32_t height, const void* data, uint32_t size);
+bool asset_pack_writer_save(const AssetPackWriter* w, const char* path);
+void asset_pack_writer_free(AssetPackWriter* w);
+// --- END: Writer ---
+
+#endif // ASSET_PACK_H
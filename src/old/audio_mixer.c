@@ -0,0 +1,363 @@
+#include "audio_mixer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#elif defined(MIXER_WITH_ALSA)
+#include <alsa/asoundlib.h>
+#endif
+
+enum { MIXER_CMD_PLAY, MIXER_CMD_STOP_ALL };
+
+static uint32_t read_u16(const uint8_t* p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8); }
+static uint32_t read_u32(const uint8_t* p) { return read_u16(p) | (read_u16(p + 2) << 16); }
+
+void mixer_init(AudioMixer* m) {
+    memset(m, 0, sizeof(*m));
+}
+
+// --- START: Sound loading ---
+bool mixer_load_wave(AudioMixer* m, SoundId id, const void* riff, size_t size) {
+    const uint8_t* data = (const uint8_t*)riff;
+    int slot = (int)id - SOUND_ID_FIRST;
+    if (slot < 0 || slot >= SOUND_ID_COUNT) return false;
+    if (size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) return false;
+
+    int channels = 0, rate = 0, bits = 0;
+    const uint8_t* pcm = NULL;
+    size_t pcm_bytes = 0;
+    for (size_t pos = 12; pos + 8 <= size;) {
+        uint32_t chunk_size = read_u32(data + pos + 4);
+        const uint8_t* body = data + pos + 8;
+        if (pos + 8 + chunk_size > size) chunk_size = (uint32_t)(size - pos - 8);
+        if (memcmp(data + pos, "fmt ", 4) == 0 && chunk_size >= 16) {
+            if (read_u16(body) != 1) return false; // PCM only
+            channels = (int)read_u16(body + 2);
+            rate = (int)read_u32(body + 4);
+            bits = (int)read_u16(body + 14);
+        } else if (memcmp(data + pos, "data", 4) == 0) {
+            pcm = body;
+            pcm_bytes = chunk_size;
+        }
+        pos += 8 + chunk_size + (chunk_size & 1);
+    }
+    if (!pcm || channels < 1 || channels > 2 || rate <= 0 || (bits != 8 && bits != 16)) return false;
+
+    int frame_bytes = channels * bits / 8;
+    int src_frames = (int)(pcm_bytes / (size_t)frame_bytes);
+    if (src_frames == 0) return false;
+
+    // Downmix to mono int16 first
+    int16_t* mono = malloc((size_t)src_frames * sizeof(int16_t));
+    if (!mono) return false;
+    for (int i = 0; i < src_frames; i++) {
+        int sum = 0;
+        for (int c = 0; c < channels; c++) {
+            const uint8_t* s = pcm + (size_t)i * frame_bytes + (size_t)c * (bits / 8);
+            sum += bits == 8 ? ((int)s[0] - 128) << 8 : (int)(int16_t)read_u16(s);
+        }
+        mono[i] = (int16_t)(sum / channels);
+    }
+
+    // Linear resample to the mixer rate
+    int dst_frames = (int)((int64_t)src_frames * MIXER_SAMPLE_RATE / rate);
+    if (dst_frames < 1) dst_frames = 1;
+    int16_t* out = malloc((size_t)dst_frames * sizeof(int16_t));
+    if (!out) { free(mono); return false; }
+    for (int i = 0; i < dst_frames; i++) {
+        int64_t pos_q16 = ((int64_t)i * rate << 16) / MIXER_SAMPLE_RATE;
+        int idx = (int)(pos_q16 >> 16);
+        int frac = (int)(pos_q16 & 0xFFFF);
+        int a = mono[idx];
+        int b = idx + 1 < src_frames ? mono[idx + 1] : a;
+        out[i] = (int16_t)(a + (((b - a) * frac) >> 16));
+    }
+    free(mono);
+
+    free(m->sounds[slot].samples);
+    m->sounds[slot].samples = out;
+    m->sounds[slot].length = dst_frames;
+    return true;
+}
+
+void mixer_load_beep(AudioMixer* m, SoundId id) {
+    int slot = (int)id - SOUND_ID_FIRST;
+    if (slot < 0 || slot >= SOUND_ID_COUNT) return;
+
+    int length = MIXER_SAMPLE_RATE / 10; // 100 ms at ~880 Hz
+    int16_t* out = malloc((size_t)length * sizeof(int16_t));
+    if (!out) return;
+    int half_period = MIXER_SAMPLE_RATE / 880 / 2;
+    for (int i = 0; i < length; i++) {
+        int fade = i < length - 256 ? 256 : length - i; // Avoid a click at the end
+        out[i] = (int16_t)((((i / half_period) & 1) ? 6000 : -6000) * fade / 256);
+    }
+    free(m->sounds[slot].samples);
+    m->sounds[slot].samples = out;
+    m->sounds[slot].length = length;
+}
+// --- END: Sound loading ---
+
+// --- START: Command queue ---
+static void push_command(AudioMixer* m, MixerCommand cmd) {
+    unsigned write = m->queue_write; // Only this thread writes it
+    unsigned read = platform_atomic_load(&m->queue_read);
+    if (write - read >= MIXER_QUEUE_SIZE) {
+        m->dropped_commands++;
+        return;
+    }
+    m->queue[write & (MIXER_QUEUE_SIZE - 1)] = cmd;
+    platform_atomic_store(&m->queue_write, write + 1);
+}
+
+void mixer_play(AudioMixer* m, SoundId id) {
+    int slot = (int)id - SOUND_ID_FIRST;
+    if (slot < 0 || slot >= SOUND_ID_COUNT) return;
+    MixerCommand cmd = { MIXER_CMD_PLAY, (uint8_t)slot, 256 };
+    push_command(m, cmd);
+}
+
+void mixer_stop_all(AudioMixer* m) {
+    MixerCommand cmd = { MIXER_CMD_STOP_ALL, 0, 0 };
+    push_command(m, cmd);
+}
+
+static void start_voice(AudioMixer* m, const MixerSound* sound, int gain) {
+    if (!sound->samples) return;
+    MixerVoice* target = NULL;
+    for (int i = 0; i < MIXER_MAX_VOICES; i++) {
+        MixerVoice* v = &m->voices[i];
+        if (!v->sound) { target = v; break; }
+        // Pool exhausted: steal the voice closest to finishing
+        if (!target || v->sound->length - v->position < target->sound->length - target->position) target = v;
+    }
+    target->sound = sound;
+    target->position = 0;
+    target->gain = gain;
+}
+
+static void drain_commands(AudioMixer* m) {
+    unsigned read = m->queue_read; // Only this thread writes it
+    unsigned write = platform_atomic_load(&m->queue_write);
+    for (; read != write; read++) {
+        MixerCommand cmd = m->queue[read & (MIXER_QUEUE_SIZE - 1)];
+        if (cmd.type == MIXER_CMD_PLAY) {
+            start_voice(m, &m->sounds[cmd.sound], cmd.gain);
+        } else {
+            memset(m->voices, 0, sizeof(m->voices));
+        }
+    }
+    platform_atomic_store(&m->queue_read, read);
+}
+// --- END: Command queue ---
+
+// --- START: Mixing ---
+void mixer_render(AudioMixer* m, int16_t* out, int frames) {
+    if (frames > MIXER_PERIOD_FRAMES) frames = MIXER_PERIOD_FRAMES;
+    drain_commands(m);
+
+    int32_t* acc = m->mix_buffer;
+    memset(acc, 0, (size_t)frames * sizeof(int32_t));
+    for (int i = 0; i < MIXER_MAX_VOICES; i++) {
+        MixerVoice* v = &m->voices[i];
+        if (!v->sound) continue;
+        int n = v->sound->length - v->position;
+        if (n > frames) n = frames;
+        const int16_t* src = v->sound->samples + v->position;
+        for (int f = 0; f < n; f++) acc[f] += (src[f] * v->gain) >> 8;
+        v->position += n;
+        if (v->position >= v->sound->length) v->sound = NULL;
+    }
+    for (int f = 0; f < frames; f++) {
+        int32_t s = acc[f];
+        out[f] = (int16_t)(s > 32767 ? 32767 : (s < -32768 ? -32768 : s));
+    }
+}
+// --- END: Mixing ---
+
+// --- START: WAV file sink ---
+static void write_wav_header(FILE* f, uint32_t data_bytes) {
+    uint8_t h[44];
+    memcpy(h, "RIFF", 4);
+    uint32_t riff_size = 36 + data_bytes;
+    uint32_t fields[] = { 16, 1 | (1u << 16), MIXER_SAMPLE_RATE, MIXER_SAMPLE_RATE * 2, 2 | (16u << 16) };
+    memcpy(h + 4, &riff_size, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    memcpy(h + 16, fields, sizeof(fields));
+    memcpy(h + 36, "data", 4);
+    memcpy(h + 40, &data_bytes, 4);
+    fwrite(h, 1, sizeof(h), f);
+}
+
+static void wav_sink_thread(void* arg) {
+    AudioMixer* m = (AudioMixer*)arg;
+    FILE* f = (FILE*)m->device;
+    int16_t period[MIXER_PERIOD_FRAMES];
+    uint32_t data_bytes = 0;
+    uint64_t period_ns = (uint64_t)MIXER_PERIOD_FRAMES * 1000000000ull / MIXER_SAMPLE_RATE;
+    uint64_t next = platform_time_ns();
+
+    while (platform_atomic_load(&m->running)) {
+        mixer_render(m, period, MIXER_PERIOD_FRAMES);
+        data_bytes += (uint32_t)fwrite(period, sizeof(int16_t), MIXER_PERIOD_FRAMES, f) * sizeof(int16_t);
+        next += period_ns;
+        uint64_t now = platform_time_ns();
+        if (next > now) platform_sleep_ms((int)((next - now) / 1000000ull));
+    }
+
+    fseek(f, 0, SEEK_SET);
+    write_wav_header(f, data_bytes);
+    fclose(f);
+}
+// --- END: WAV file sink ---
+
+// --- START: Device sink ---
+#ifdef _WIN32
+
+static void device_thread(void* arg) {
+    AudioMixer* m = (AudioMixer*)arg;
+    HWAVEOUT wave_out = (HWAVEOUT)m->device;
+    HANDLE done_event = (HANDLE)m->device_event;
+    WAVEHDR headers[MIXER_PERIOD_COUNT];
+    static int16_t buffers[MIXER_PERIOD_COUNT][MIXER_PERIOD_FRAMES];
+
+    memset(headers, 0, sizeof(headers));
+    for (int i = 0; i < MIXER_PERIOD_COUNT; i++) {
+        headers[i].lpData = (LPSTR)buffers[i];
+        headers[i].dwBufferLength = sizeof(buffers[i]);
+        waveOutPrepareHeader(wave_out, &headers[i], sizeof(WAVEHDR));
+        mixer_render(m, buffers[i], MIXER_PERIOD_FRAMES);
+        waveOutWrite(wave_out, &headers[i], sizeof(WAVEHDR));
+    }
+
+    while (platform_atomic_load(&m->running)) {
+        bool refilled = false;
+        for (int i = 0; i < MIXER_PERIOD_COUNT; i++) {
+            if (headers[i].dwFlags & WHDR_DONE) {
+                mixer_render(m, buffers[i], MIXER_PERIOD_FRAMES);
+                waveOutWrite(wave_out, &headers[i], sizeof(WAVEHDR));
+                refilled = true;
+            }
+        }
+        // The driver signals the event whenever a buffer comes back (CALLBACK_EVENT)
+        if (!refilled) WaitForSingleObject(done_event, 20);
+    }
+
+    waveOutReset(wave_out);
+    for (int i = 0; i < MIXER_PERIOD_COUNT; i++) waveOutUnprepareHeader(wave_out, &headers[i], sizeof(WAVEHDR));
+    waveOutClose(wave_out);
+    CloseHandle(done_event);
+    m->device_event = NULL;
+}
+
+static bool open_device(AudioMixer* m) {
+    WAVEFORMATEX fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.wFormatTag = WAVE_FORMAT_PCM;
+    fmt.nChannels = 1;
+    fmt.nSamplesPerSec = MIXER_SAMPLE_RATE;
+    fmt.wBitsPerSample = 16;
+    fmt.nBlockAlign = 2;
+    fmt.nAvgBytesPerSec = MIXER_SAMPLE_RATE * 2;
+
+    HANDLE done_event = CreateEventA(NULL, FALSE, FALSE, NULL);
+    if (!done_event) return false;
+    HWAVEOUT wave_out;
+    if (waveOutOpen(&wave_out, WAVE_MAPPER, &fmt, (DWORD_PTR)done_event, 0, CALLBACK_EVENT) != 0) {
+        CloseHandle(done_event);
+        return false;
+    }
+    m->device = wave_out;
+    m->device_event = done_event;
+    return true;
+}
+
+// For a device opened but never handed to device_thread
+static void close_device(AudioMixer* m) {
+    waveOutClose((HWAVEOUT)m->device);
+    CloseHandle((HANDLE)m->device_event);
+    m->device_event = NULL;
+}
+
+#elif defined(MIXER_WITH_ALSA)
+
+static void device_thread(void* arg) {
+    AudioMixer* m = (AudioMixer*)arg;
+    snd_pcm_t* pcm = (snd_pcm_t*)m->device;
+    int16_t period[MIXER_PERIOD_FRAMES];
+
+    // snd_pcm_writei blocks until the device has room, which makes this loop the callback
+    while (platform_atomic_load(&m->running)) {
+        mixer_render(m, period, MIXER_PERIOD_FRAMES);
+        snd_pcm_sframes_t written = snd_pcm_writei(pcm, period, MIXER_PERIOD_FRAMES);
+        if (written < 0) snd_pcm_recover(pcm, (int)written, 1);
+    }
+
+    snd_pcm_drop(pcm);
+    snd_pcm_close(pcm);
+}
+
+static bool open_device(AudioMixer* m) {
+    snd_pcm_t* pcm;
+    if (snd_pcm_open(&pcm, "default", SND_PCM_STREAM_PLAYBACK, 0) < 0) return false;
+    unsigned latency_us = (unsigned)((uint64_t)MIXER_PERIOD_FRAMES * MIXER_PERIOD_COUNT * 1000000ull / MIXER_SAMPLE_RATE);
+    if (snd_pcm_set_params(pcm, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                           1, MIXER_SAMPLE_RATE, 1, latency_us) < 0) {
+        snd_pcm_close(pcm);
+        return false;
+    }
+    m->device = pcm;
+    return true;
+}
+
+static void close_device(AudioMixer* m) {
+    snd_pcm_close((snd_pcm_t*)m->device);
+}
+
+#else
+
+static void device_thread(void* arg) { (void)arg; }
+static bool open_device(AudioMixer* m) { (void)m; return false; }
+static void close_device(AudioMixer* m) { (void)m; }
+
+#endif
+// --- END: Device sink ---
+
+bool mixer_start(AudioMixer* m, MixerOutput output, const char* wav_path) {
+    m->output = output;
+    if (output == MIXER_OUTPUT_WAV_FILE) {
+        FILE* f = fopen(wav_path, "wb");
+        if (!f) return false;
+        write_wav_header(f, 0); // Patched with the real size on stop
+        m->device = f;
+    } else if (!open_device(m)) {
+        return false;
+    }
+
+    platform_atomic_store(&m->running, 1);
+    if (!platform_thread_start(&m->thread, output == MIXER_OUTPUT_WAV_FILE ? wav_sink_thread : device_thread, m)) {
+        platform_atomic_store(&m->running, 0);
+        if (output == MIXER_OUTPUT_WAV_FILE) fclose((FILE*)m->device);
+        else close_device(m);
+        m->device = NULL;
+        return false;
+    }
+    return true;
+}
+
+void mixer_stop(AudioMixer* m) {
+    if (!platform_atomic_load(&m->running)) return;
+    platform_atomic_store(&m->running, 0);
+    platform_thread_join(&m->thread);
+    m->device = NULL;
+}
+
+void mixer_free(AudioMixer* m) {
+    mixer_stop(m);
+    for (int i = 0; i < SOUND_ID_COUNT; i++) free(m->sounds[i].samples);
+    memset(m, 0, sizeof(*m));
+}
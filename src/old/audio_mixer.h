@@ -0,0 +1,93 @@
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "platform.h"
+
+// Software mixer replacing FUN_1040_0000's sndPlaySound dispatch.
+//
+// The game thread only ever calls mixer_play/mixer_stop_all, which push a command
+// into a single-producer/single-consumer ring and return immediately. The output
+// thread drains the ring at the start of every period and mixes up to
+// MIXER_MAX_VOICES sounds at once. Sounds are decoded and resampled once at load.
+
+// Effect ids as passed to FUN_1040_0000 in the original
+typedef enum {
+    SOUND_SNAKE_STEP = 0x65,   // FUN_1038_0ffc
+    SOUND_CLAIM = 0x66,        // FUN_1038_3f12, area filled
+    SOUND_SNAKE_KILLED = 0x68, // FUN_1038_1f90
+    SOUND_SPIDER_HIT = 0x69,   // FUN_1038_366e/399a
+    SOUND_SPIDER_DIED = 0x6a,  // FUN_1038_2da0
+    SOUND_GAME_OVER = 0x6b,    // FUN_1038_02d2, out of lives
+    SOUND_DIALOG = 0x6c,       // PICTUREDLGPROC
+    SOUND_STARTUP = 0x6d,      // setup_game_ui_windows
+    SOUND_TIME_LOW = 0x6e      // FUN_1038_02d2, timer below 6
+} SoundId;
+
+#define SOUND_ID_FIRST SOUND_SNAKE_STEP
+#define SOUND_ID_COUNT (SOUND_TIME_LOW - SOUND_ID_FIRST + 1)
+
+#define MIXER_SAMPLE_RATE 22050
+#define MIXER_PERIOD_FRAMES 256   // ~11.6 ms per period
+#define MIXER_PERIOD_COUNT 3      // Periods queued at the device
+#define MIXER_MAX_VOICES 16
+#define MIXER_QUEUE_SIZE 64       // Power of two
+
+typedef enum {
+    MIXER_OUTPUT_DEVICE,   // waveOut on Windows, ALSA on Linux (build with MIXER_WITH_ALSA)
+    MIXER_OUTPUT_WAV_FILE  // Real-time paced file sink for headless runs
+} MixerOutput;
+
+typedef struct {
+    int16_t* samples; // Mono, MIXER_SAMPLE_RATE
+    int length;
+} MixerSound;
+
+typedef struct {
+    const MixerSound* sound; // NULL when free
+    int position;
+    int gain;                // Q8, 256 = unity
+} MixerVoice;
+
+typedef struct {
+    uint8_t type;
+    uint8_t sound;
+    uint16_t gain;
+} MixerCommand;
+
+typedef struct {
+    MixerSound sounds[SOUND_ID_COUNT];
+    MixerVoice voices[MIXER_MAX_VOICES];
+
+    MixerCommand queue[MIXER_QUEUE_SIZE];
+    unsigned queue_read;  // Owned by the output thread; atomic
+    unsigned queue_write; // Owned by the game thread; atomic
+    int dropped_commands; // Queue-full drops, for diagnostics
+
+    MixerOutput output;
+    PlatformThread thread;
+    int running;          // atomic
+    void* device;         // HWAVEOUT / snd_pcm_t* / FILE*
+    void* device_event;   // waveOut completion event
+    int32_t mix_buffer[MIXER_PERIOD_FRAMES];
+} AudioMixer;
+
+void mixer_init(AudioMixer* m);
+// Decodes a RIFF/WAVE blob (8/16-bit PCM, mono or stereo, any rate). Call before mixer_start.
+bool mixer_load_wave(AudioMixer* m, SoundId id, const void* riff, size_t size);
+// Short square-wave tone, standing in for MESSAGEBEEP when a sound is missing.
+void mixer_load_beep(AudioMixer* m, SoundId id);
+bool mixer_start(AudioMixer* m, MixerOutput output, const char* wav_path);
+void mixer_stop(AudioMixer* m);
+void mixer_free(AudioMixer* m);
+
+// Game thread, wait-free. Drops the command if the ring is full.
+void mixer_play(AudioMixer* m, SoundId id);
+void mixer_stop_all(AudioMixer* m);
+
+// Output side: mixes the next `frames` frames (<= MIXER_PERIOD_FRAMES). Exposed for custom sinks.
+void mixer_render(AudioMixer* m, int16_t* out, int frames);
+
+#endif // AUDIO_MIXER_H
@@ -0,0 +1,188 @@
+#include "batch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "platform.h"
+#include "snake.h"
+#include "work_pool.h"
+
+void batch_default_config(BatchConfig* config) {
+    config->board_w = GAME_DEFAULT_W;
+    config->board_h = GAME_DEFAULT_H;
+    config->level = 1;
+    config->snakes = 1;
+    config->lives = 3;
+    config->max_ticks = 100000; // Almost an hour at the original's 18 ticks per second
+    config->seed = 1;
+    config->layout = NULL;
+}
+
+// --- START: Bot ---
+// Roams the claimed border for a few vertices, then draws a box out into the free
+// area: out, sideways, and back until the path meets claimed ground again.
+typedef enum {
+    BOT_ROAM,
+    BOT_OUT,
+    BOT_SIDE,
+    BOT_BACK
+} BotLeg;
+
+typedef struct {
+    uint32_t rng;
+    BotLeg leg;
+    int out_dir, side_dir;
+    int out_steps, side_steps;
+    int steps;              // Vertices reached on the current leg
+    int last_x, last_y;     // Vertex of the last decision
+} Bot;
+
+static const int bot_dx[4] = { 0, 1, 0, -1 };
+static const int bot_dy[4] = { -1, 0, 1, 0 };
+
+static int bot_random(Bot* b, int n) {
+    uint32_t x = b->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    b->rng = x;
+    return (int)((x >> 8) % (uint32_t)n);
+}
+
+static void bot_intent(Game* g, int dir) {
+    g->input_vx_intent = bot_dx[dir];
+    g->input_vy_intent = bot_dy[dir];
+}
+
+static void bot_steer(Game* g, Bot* b) {
+    if (!is_spider_on_cross_section(g)) return;
+    int vx = g->spider_x / CELL_PITCH, vy = g->spider_y / CELL_PITCH;
+    // Still on the vertex of the last decision a tick later: that move went nowhere
+    bool stuck = (g->spider_vx == 0 && g->spider_vy == 0) || (vx == b->last_x && vy == b->last_y);
+    b->last_x = vx;
+    b->last_y = vy;
+
+    if (g->spider_state != SPIDER_DRAWING_PATH) {
+        if (b->leg != BOT_ROAM) { // Path just ended, claimed or not
+            b->leg = BOT_ROAM;
+            b->steps = bot_random(b, 6);
+        }
+        if (b->steps > 0 && !stuck) {
+            b->steps--;
+            return;
+        }
+        if (b->steps > 0 || bot_random(b, 3) == 0) { // Stuck: try another way along the border
+            bot_intent(g, bot_random(b, 4));
+            return;
+        }
+        b->out_dir = bot_random(b, 4);
+        b->side_dir = (b->out_dir + (bot_random(b, 2) ? 1 : 3)) % 4;
+        b->out_steps = 1 + bot_random(b, 5);
+        b->side_steps = 1 + bot_random(b, 8);
+        b->leg = BOT_OUT;
+        b->steps = 0;
+        bot_intent(g, b->out_dir);
+        return;
+    }
+
+    b->steps++;
+    if (b->leg == BOT_OUT && b->steps >= b->out_steps) {
+        b->leg = BOT_SIDE;
+        b->steps = 0;
+        bot_intent(g, b->side_dir);
+    } else if (b->leg == BOT_SIDE && b->steps >= b->side_steps) {
+        b->leg = BOT_BACK;
+        b->steps = 0;
+        bot_intent(g, (b->out_dir + 2) % 4);
+    }
+}
+// --- END: Bot ---
+
+void batch_play_game(Game* g, const BatchConfig* config, int index, GameResult* result) {
+    initialize_game_state(g);
+    game_seed(g, config->seed * 0x100000001B3ull + (uint64_t)index);
+    g->level = config->level;
+    level_apply(g, config->layout);
+    snakes_spawn(g, config->snakes);
+
+    Bot bot;
+    memset(&bot, 0, sizeof(bot));
+    bot.rng = ((uint32_t)game_random(g) << 16 ^ (uint32_t)game_random(g)) | 1;
+    bot.last_x = bot.last_y = -1;
+
+    while (g->tick < (uint32_t)config->max_ticks && g->deaths < config->lives && !game_is_won(g)) {
+        bot_steer(g, &bot);
+        game_tick(g);
+    }
+
+    result->ticks = g->tick;
+    result->claims = g->claims - g->failed_claims;
+    result->failed_claims = g->failed_claims;
+    result->deaths = g->deaths;
+    result->snakes_killed = g->snakes_killed;
+    result->claimed_percent = g->total_cells ? 100.0f * (float)g->claimed_cell_count / (float)g->total_cells : 0.0f;
+    result->won = game_is_won(g);
+}
+
+// --- START: Batch ---
+typedef struct {
+    const BatchConfig* config;
+    GameResult* results;
+    Game games[WORK_POOL_MAX_THREADS]; // One per worker, allocated on its first game
+    bool out_of_memory[WORK_POOL_MAX_THREADS];
+} BatchJob;
+
+static void run_game(void* ctx, int index, int worker) {
+    BatchJob* job = ctx;
+    Game* g = &job->games[worker];
+    if (!g->block && !game_init(g, job->config->board_w, job->config->board_h, job->config->snakes)) {
+        job->out_of_memory[worker] = true;
+        return;
+    }
+    batch_play_game(g, job->config, index, &job->results[index]);
+}
+
+bool batch_run(const BatchConfig* config, int games, int threads, GameResult* results, BatchStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (threads <= 0) threads = platform_cpu_count();
+    if (threads > WORK_POOL_MAX_THREADS) threads = WORK_POOL_MAX_THREADS;
+    if (games <= 0) return true;
+
+    BatchJob* job = calloc(1, sizeof(BatchJob));
+    GameResult* own_results = results ? NULL : malloc((size_t)games * sizeof(GameResult));
+    if (!job || (!results && !own_results)) {
+        free(job);
+        free(own_results);
+        return false;
+    }
+    job->config = config;
+    job->results = results ? results : own_results;
+
+    uint64_t t0 = platform_time_ns();
+    work_pool_run(threads, games, run_game, job);
+    stats->seconds = (double)(platform_time_ns() - t0) * 1e-9;
+
+    bool ok = true;
+    for (int i = 0; i < WORK_POOL_MAX_THREADS; i++) {
+        if (job->out_of_memory[i]) ok = false;
+        if (job->games[i].block) game_free(&job->games[i]);
+    }
+
+    stats->games = games;
+    stats->threads = threads < games ? threads : games;
+    for (int i = 0; ok && i < games; i++) {
+        const GameResult* r = &job->results[i];
+        stats->won += r->won;
+        stats->ticks += r->ticks;
+        stats->claims += (uint64_t)r->claims;
+        stats->failed_claims += (uint64_t)r->failed_claims;
+        stats->deaths += (uint64_t)r->deaths;
+        stats->snakes_killed += (uint64_t)r->snakes_killed;
+        stats->claimed_percent_mean += r->claimed_percent;
+    }
+    stats->claimed_percent_mean /= games;
+
+    free(own_results);
+    free(job);
+    return ok;
+}
+// --- END: Batch ---
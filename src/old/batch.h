@@ -0,0 +1,58 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+#include "level.h"
+
+// Headless games played by a simple bot, many at once.
+//
+// Every game owns its Game (one per worker, reused) and random state seeded from
+// BatchConfig.seed and its index, so a batch gives the same results on any number
+// of threads. Nothing is shared between games while they run; the summary is
+// computed from the per-game results afterwards. game_sound_handler and
+// game_claim_clock must stay NULL: the handler is called from every worker, and
+// the claim time adds up in game_claim_ns, a plain global.
+
+typedef struct {
+    int board_w, board_h;
+    int level;       // 1..10, see Game.level
+    int snakes;      // Per game; the original had 1..3
+    int lives;       // Game over after this many hits
+    int max_ticks;   // Game over when the level isn't won by then
+    uint64_t seed;
+    const LevelDef* layout; // Walls of every game, scaled to the board; NULL = none
+} BatchConfig;
+
+typedef struct {
+    uint32_t ticks;
+    int claims, failed_claims;
+    int deaths;
+    int snakes_killed;
+    float claimed_percent;
+    bool won;
+} GameResult;
+
+typedef struct {
+    int games;
+    int threads;
+    int won;
+    uint64_t ticks;
+    uint64_t claims, failed_claims;
+    uint64_t deaths;
+    uint64_t snakes_killed;
+    double claimed_percent_mean;
+    double seconds;  // Wall clock for the whole batch
+} BatchStats;
+
+void batch_default_config(BatchConfig* config);
+
+// Plays game `index` of the batch on g, which must be sized for the config
+void batch_play_game(Game* g, const BatchConfig* config, int index, GameResult* result);
+
+// Plays `games` games on `threads` threads (0 = one per processor). `results` may be
+// NULL; otherwise it receives one entry per game. False if out of memory.
+bool batch_run(const BatchConfig* config, int games, int threads, GameResult* results, BatchStats* stats);
+
+#endif // BATCH_H
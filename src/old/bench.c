@@ -0,0 +1,445 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "game.h"
+#include "render.h"
+#include "scaler.h"
+#include "snapshot.h"
+#include "spider_batch.h"
+#include "platform.h"
+
+// Benchmarks for the remake's simulation and rendering hot paths.
+//
+//     bench [--filter text] [--min-time ms] [--repetitions n] [--board WxH] [--out results.json]
+//
+// Every benchmark is run for `repetitions` rounds of roughly min-time/repetitions
+// each; the JSON (stdout unless --out is given) reports per-iteration times in ns
+// in the same shape as Google Benchmark's, so results from fixed hardware can be
+// compared across commits with the usual tooling. A summary goes to stderr.
+// Benchmarks that advance several games per iteration also report items_per_second
+// (game ticks); build with -mavx2 or -mavx512f to get the vector spider_batch path.
+
+// --- START: Board Scripts ---
+static Game game;
+static Game snapshot; // Board after setup, restored before every claim
+
+static void claim_cell(Game* g, int x, int y) {
+    if (!GAME_CLAIMED(g, x, y)) {
+        game_set_flag(g, g->claimed, GAME_HASH_CLAIMED, (size_t)y * (size_t)g->w + (size_t)x);
+        g->claimed_cell_count++;
+    }
+}
+
+// Vertical path along vertex column x from vertex row y0 to y1, spider sitting on its end
+static void script_vertical_path(Game* g, int x, int y0, int y1) {
+    for (int y = y0; y <= y1; y++) g->current_path_vertices[g->current_path_len++] = (Point){x, y};
+    for (int y = y0; y < y1; y++) game_set_flag(g, g->path_v, GAME_HASH_PATH_V, (size_t)y * (size_t)(g->w + 1) + (size_t)x);
+    g->path_start_vertex_x = x;
+    g->path_start_vertex_y = y0;
+    g->last_vertex_x = x;
+    g->last_vertex_y = y1;
+    g->spider_x = x * CELL_PITCH;
+    g->spider_y = y1 * CELL_PITCH;
+    g->spider_state = SPIDER_DRAWING_PATH;
+}
+
+// Fresh board split in two by a path from top to bottom
+static void script_empty(Game* g) {
+    initialize_game_state(g);
+    script_vertical_path(g, g->w / 2, 0, g->h);
+}
+
+// Every other cell claimed: hundreds of one-cell regions
+static void script_checkerboard(Game* g) {
+    initialize_game_state(g);
+    for (int y = 0; y < g->h; y++) {
+        for (int x = 0; x < g->w; x++) {
+            if ((x + y) % 2 == 0) claim_cell(g, x, y);
+        }
+    }
+    script_vertical_path(g, g->w / 2, 0, g->h);
+}
+
+// Claimed walls leave one corridor winding through the whole board, cut near its start
+static void script_serpentine(Game* g) {
+    initialize_game_state(g);
+    for (int y = 1; y < g->h; y += 2) {
+        int gap_x = (y / 2) % 2 == 0 ? g->w - 1 : 0;
+        for (int x = 0; x < g->w; x++) {
+            if (x != gap_x) claim_cell(g, x, y);
+        }
+    }
+    script_vertical_path(g, g->w / 2, 0, 1);
+}
+
+// Everything claimed except a 5x5 pocket in the middle, which the path splits
+static void script_nearly_full(Game* g) {
+    initialize_game_state(g);
+    int x0 = g->w / 2 - 2, y0 = g->h / 2 - 2;
+    for (int y = 0; y < g->h; y++) {
+        for (int x = 0; x < g->w; x++) {
+            bool in_pocket = x >= x0 && x < x0 + 5 && y >= y0 && y < y0 + 5;
+            if (!in_pocket) claim_cell(g, x, y);
+        }
+    }
+    script_vertical_path(g, x0 + 2, y0, y0 + 5);
+}
+// --- END: Board Scripts ---
+
+// --- START: Benchmarks ---
+typedef struct {
+    const char* name;
+    void (*setup)(Game* g);       // Once, untimed
+    void (*run)(Game* g);         // Timed
+    bool reset_each_iteration;    // Restore the board after setup before every (individually timed) run
+    int items;                    // Game ticks per run, when more than one
+} Benchmark;
+
+// Steers the spider clockwise around the outer border forever
+static void steer_along_border(Game* g) {
+    if (!is_spider_on_cross_section(g)) return;
+    int vx = g->spider_x / CELL_PITCH;
+    int vy = g->spider_y / CELL_PITCH;
+    if (vy == 0 && vx < g->w) { g->input_vx_intent = 1; g->input_vy_intent = 0; }
+    else if (vx == g->w && vy < g->h) { g->input_vx_intent = 0; g->input_vy_intent = 1; }
+    else if (vy == g->h && vx > 0) { g->input_vx_intent = -1; g->input_vy_intent = 0; }
+    else { g->input_vx_intent = 0; g->input_vy_intent = -1; }
+}
+
+static void run_tick(Game* g) {
+    steer_along_border(g);
+    update_spider(g);
+}
+
+// The same border lap on LOCKSTEP_GAMES boards, each a few pixels further on so
+// they reach vertices on different ticks, as independent games would
+#define LOCKSTEP_GAMES 64
+static Game lockstep_games[LOCKSTEP_GAMES];
+static SpiderBatch lockstep_batch;
+
+static void setup_lockstep(Game* g) {
+    Game* lanes[LOCKSTEP_GAMES];
+    for (int i = 0; i < LOCKSTEP_GAMES; i++) {
+        Game* lane = &lockstep_games[i];
+        if (!lane->block && !game_init(lane, g->w, g->h, 0)) {
+            fprintf(stderr, "Out of memory for the lockstep boards\n");
+            exit(1);
+        }
+        initialize_game_state(lane);
+        for (int t = 0; t < i * 5; t++) run_tick(lane);
+        lanes[i] = lane;
+    }
+    spider_batch_free(&lockstep_batch);
+    if (!spider_batch_init(&lockstep_batch, lanes, LOCKSTEP_GAMES)) {
+        fprintf(stderr, "Out of memory for the spider batch\n");
+        exit(1);
+    }
+}
+
+static void run_lockstep_scalar(Game* g) {
+    (void)g;
+    for (int i = 0; i < LOCKSTEP_GAMES; i++) run_tick(&lockstep_games[i]);
+}
+
+static void steer_lane(Game* g, int lane, void* ctx) {
+    (void)lane; (void)ctx;
+    steer_along_border(g);
+}
+
+static void run_lockstep_batch(Game* g) {
+    (void)g;
+    spider_batch_tick(&lockstep_batch, steer_lane, NULL);
+}
+
+// A border lap saving every tick against the previous save, the oldest of
+// SNAPSHOT_RING released as it goes, as a rewind buffer would
+#define SNAPSHOT_RING 1024
+static SnapshotPool* snapshot_pool;
+static SnapshotId snapshot_ring[SNAPSHOT_RING];
+static int snapshot_next;
+
+static void setup_snapshots(Game* g) {
+    initialize_game_state(g);
+    snapshot_pool_destroy(snapshot_pool);
+    snapshot_pool = snapshot_pool_create(g, 0);
+    if (!snapshot_pool) {
+        fprintf(stderr, "Out of memory for the snapshot pool\n");
+        exit(1);
+    }
+    for (int i = 0; i < SNAPSHOT_RING; i++) snapshot_ring[i] = SNAPSHOT_NONE;
+    snapshot_next = 0;
+}
+
+static void run_snapshot_save(Game* g) {
+    run_tick(g);
+    SnapshotId previous = snapshot_ring[(snapshot_next + SNAPSHOT_RING - 1) % SNAPSHOT_RING];
+    snapshot_release(snapshot_pool, snapshot_ring[snapshot_next]);
+    snapshot_ring[snapshot_next] = snapshot_save(snapshot_pool, g, previous);
+    snapshot_next = (snapshot_next + 1) % SNAPSHOT_RING;
+}
+
+static void run_snapshot_restore(Game* g) {
+    snapshot_restore(snapshot_pool, snapshot_ring[snapshot_next], g);
+    snapshot_next = (snapshot_next + 1) % SNAPSHOT_RING;
+}
+
+static void setup_snapshot_ring(Game* g) {
+    setup_snapshots(g);
+    for (int i = 0; i < SNAPSHOT_RING; i++) run_snapshot_save(g);
+}
+
+static void setup_render_board(Game* g) {
+    script_checkerboard(g);
+    g->spider_vx = 1; // Rotated sprite
+}
+
+static void run_hash_recompute(Game* g) {
+    g->hash = game_hash_recompute(g); // What keeping Game.hash current saves per comparison
+}
+
+// A score going up by one per call, as the counters see it during a claim
+static Counter bench_counter;
+static uint32_t bench_counter_value;
+
+static void setup_counter(Game* g) {
+    (void)g;
+    counter_init(&bench_counter, WIN_BORDER, WIN_BORDER, 6);
+    bench_counter_value = 0;
+    counter_draw(&bench_counter, bench_counter_value);
+}
+
+static void run_counter_draw(Game* g) {
+    (void)g;
+    counter_draw(&bench_counter, ++bench_counter_value);
+}
+
+// The frame of setup_render_board scaled up for presenting, on one thread
+static Scaler bench_scaler;
+
+static void setup_scaler(Game* g, int scale, ScalerFilter filter) {
+    setup_render_board(g);
+    render_frame(g);
+    render_present(NULL, NULL);
+    scaler_free(&bench_scaler);
+    if (!scaler_init(&bench_scaler, win_w, win_h, scale, filter, 1)) {
+        fprintf(stderr, "Out of memory for the scaler\n");
+        exit(1);
+    }
+    scaler_run(&bench_scaler, pixels, NULL);
+}
+
+static void setup_scaler_2x(Game* g) { setup_scaler(g, 2, SCALER_SMOOTH); }
+static void setup_scaler_3x(Game* g) { setup_scaler(g, 3, SCALER_SMOOTH); }
+static void setup_scaler_4x(Game* g) { setup_scaler(g, 4, SCALER_SMOOTH); }
+static void setup_scaler_2x_nearest(Game* g) { setup_scaler(g, 2, SCALER_NEAREST); }
+
+// Every tile, as after a resize
+static void run_scaler_full(Game* g) {
+    (void)g;
+    scaler_invalidate(&bench_scaler);
+    scaler_run(&bench_scaler, pixels, NULL);
+}
+
+static void mark_scaler_tile(void* ctx, int x, int y, int w, int h) {
+    scaler_mark_dirty(ctx, x, y, w, h);
+}
+
+// A frame of the border lap as mamba.exe composes it: the spider moved, so only
+// the tiles around it are expanded and scaled
+static void run_scaler_tick(Game* g) {
+    run_tick(g);
+    render_frame(g);
+    render_present(mark_scaler_tile, &bench_scaler);
+    scaler_run(&bench_scaler, pixels, NULL);
+}
+
+static void setup_scaler_tick(Game* g) {
+    setup_scaler(g, 2, SCALER_SMOOTH);
+    bench_scaler.marked_only = true;
+}
+
+// Every tile expanded, as after palette_set
+static void run_render_present_full(Game* g) {
+    (void)g;
+    palette_set(color_cyan, palette[color_cyan] ^ 1);
+    render_present(NULL, NULL);
+}
+
+static void run_draw_cells(Game* g) { draw_cells(g); }
+static void run_draw_paths_past(Game* g) { draw_paths(g, false); }
+static void run_draw_paths_current(Game* g) { draw_paths(g, true); }
+static void run_draw_spider(Game* g) { draw_spider(g); }
+static void run_render_frame(Game* g) { render_frame(g); }
+
+static const Benchmark benchmarks[] = {
+    { "update_spider/border_lap", initialize_game_state, run_tick, false, 0 },
+    { "update_spider/border_lap_x64", setup_lockstep, run_lockstep_scalar, false, LOCKSTEP_GAMES },
+    { "spider_batch_tick/border_lap_x64", setup_lockstep, run_lockstep_batch, false, LOCKSTEP_GAMES },
+    { "attempt_claim_territory/empty", script_empty, attempt_claim_territory, true, 0 },
+    { "attempt_claim_territory/checkerboard", script_checkerboard, attempt_claim_territory, true, 0 },
+    { "attempt_claim_territory/serpentine", script_serpentine, attempt_claim_territory, true, 0 },
+    { "attempt_claim_territory/nearly_full", script_nearly_full, attempt_claim_territory, true, 0 },
+    { "snapshot_save/border_lap", setup_snapshots, run_snapshot_save, false, 0 },
+    { "snapshot_restore/border_lap", setup_snapshot_ring, run_snapshot_restore, false, 0 },
+    { "game_hash_recompute/checkerboard", script_checkerboard, run_hash_recompute, false, 0 },
+    { "draw_cells/checkerboard", setup_render_board, run_draw_cells, false, 0 },
+    { "draw_paths/past", setup_render_board, run_draw_paths_past, false, 0 },
+    { "draw_paths/current", setup_render_board, run_draw_paths_current, false, 0 },
+    { "draw_spider", setup_render_board, run_draw_spider, false, 0 },
+    { "render_frame/checkerboard", setup_render_board, run_render_frame, false, 0 },
+    { "counter_draw/increment", setup_counter, run_counter_draw, false, 0 },
+    { "scaler_run/2x_smooth_full", setup_scaler_2x, run_scaler_full, false, 0 },
+    { "scaler_run/3x_smooth_full", setup_scaler_3x, run_scaler_full, false, 0 },
+    { "scaler_run/4x_smooth_full", setup_scaler_4x, run_scaler_full, false, 0 },
+    { "scaler_run/2x_nearest_full", setup_scaler_2x_nearest, run_scaler_full, false, 0 },
+    { "render_frame+scaler_run/2x_smooth_tick", setup_scaler_tick, run_scaler_tick, false, 0 },
+    { "render_present/palette_change", setup_scaler_2x, run_render_present_full, false, 0 },
+};
+
+#define BENCHMARK_COUNT (int)(sizeof(benchmarks) / sizeof(benchmarks[0]))
+#define MAX_REPETITIONS 32
+
+typedef struct {
+    int64_t iterations;
+    double ns_per_iteration[MAX_REPETITIONS];
+    double mean, median, min, max;
+} BenchmarkResult;
+
+// Runs `iterations` iterations and returns the timed nanoseconds
+static uint64_t run_iterations(const Benchmark* b, int64_t iterations) {
+    if (!b->reset_each_iteration) {
+        uint64_t t0 = platform_time_ns();
+        for (int64_t i = 0; i < iterations; i++) b->run(&game);
+        return platform_time_ns() - t0;
+    }
+    uint64_t total = 0;
+    for (int64_t i = 0; i < iterations; i++) {
+        game_copy(&game, &snapshot);
+        uint64_t t0 = platform_time_ns();
+        b->run(&game);
+        total += platform_time_ns() - t0;
+    }
+    return total;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void run_benchmark(const Benchmark* b, double min_time_ms, int repetitions, BenchmarkResult* r) {
+    b->setup(&game);
+    game_copy(&snapshot, &game);
+
+    // Grow the batch until one repetition takes its share of the time budget
+    uint64_t target_ns = (uint64_t)(min_time_ms * 1e6 / repetitions);
+    int64_t iterations = 1;
+    for (;;) {
+        uint64_t ns = run_iterations(b, iterations);
+        if (ns >= target_ns || iterations >= ((int64_t)1 << 40)) break;
+        int64_t next = ns > 0 ? (int64_t)((double)iterations * (double)target_ns * 1.2 / (double)ns) : iterations * 10;
+        if (next > iterations * 10) next = iterations * 10;
+        iterations = next > iterations ? next : iterations + 1;
+    }
+
+    r->iterations = iterations;
+    double sorted[MAX_REPETITIONS];
+    double sum = 0.0;
+    for (int i = 0; i < repetitions; i++) {
+        game_copy(&game, &snapshot);
+        r->ns_per_iteration[i] = (double)run_iterations(b, iterations) / (double)iterations;
+        sorted[i] = r->ns_per_iteration[i];
+        sum += sorted[i];
+    }
+    qsort(sorted, (size_t)repetitions, sizeof(double), compare_doubles);
+    r->mean = sum / repetitions;
+    r->median = repetitions % 2 ? sorted[repetitions / 2] : (sorted[repetitions / 2 - 1] + sorted[repetitions / 2]) / 2.0;
+    r->min = sorted[0];
+    r->max = sorted[repetitions - 1];
+}
+// --- END: Benchmarks ---
+
+// --- START: Output ---
+static void write_json(FILE* f, double min_time_ms, int repetitions,
+                       const BenchmarkResult* results, const bool* selected) {
+    char date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    fprintf(f, "{\n  \"context\": {\n");
+    fprintf(f, "    \"date\": \"%s\",\n", date);
+    fprintf(f, "    \"executable\": \"mamba bench\",\n");
+    fprintf(f, "    \"board\": \"%dx%d\",\n", game.w, game.h);
+    fprintf(f, "    \"min_time_ms\": %.1f,\n", min_time_ms);
+    fprintf(f, "    \"repetitions\": %d\n  },\n  \"benchmarks\": [", repetitions);
+    bool first = true;
+    for (int i = 0; i < BENCHMARK_COUNT; i++) {
+        if (!selected[i]) continue;
+        const BenchmarkResult* r = &results[i];
+        fprintf(f, "%s\n    {\"name\": \"%s\", \"iterations\": %lld, \"real_time\": %.2f, \"median\": %.2f, "
+                   "\"min\": %.2f, \"max\": %.2f, \"time_unit\": \"ns\"",
+                first ? "" : ",", benchmarks[i].name, (long long)r->iterations, r->mean, r->median, r->min, r->max);
+        if (benchmarks[i].items > 0) fprintf(f, ", \"items_per_second\": %.0f", benchmarks[i].items * 1e9 / r->median);
+        fprintf(f, "}");
+        first = false;
+    }
+    fprintf(f, "\n  ]\n}\n");
+}
+// --- END: Output ---
+
+int main(int argc, char** argv) {
+    const char* filter = NULL;
+    const char* out_path = NULL;
+    double min_time_ms = 500.0;
+    int repetitions = 5;
+    int board_w = GAME_DEFAULT_W, board_h = GAME_DEFAULT_H;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) out_path = argv[++i];
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) min_time_ms = atof(argv[++i]);
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) repetitions = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--board") == 0 && i + 1 < argc && sscanf(argv[++i], "%dx%d", &board_w, &board_h) == 2) {}
+        else {
+            fprintf(stderr, "usage: %s [--filter text] [--min-time ms] [--repetitions n] [--board WxH] [--out results.json]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (repetitions < 1) repetitions = 1;
+    if (repetitions > MAX_REPETITIONS) repetitions = MAX_REPETITIONS;
+    if (min_time_ms <= 0.0) min_time_ms = 500.0;
+
+    if (!game_init(&game, board_w, board_h, 0) || !game_init(&snapshot, board_w, board_h, 0) || !render_init(&game)) {
+        fprintf(stderr, "Out of memory for a %dx%d board\n", board_w, board_h);
+        return 1;
+    }
+
+    static BenchmarkResult results[BENCHMARK_COUNT];
+    bool selected[BENCHMARK_COUNT];
+    for (int i = 0; i < BENCHMARK_COUNT; i++) {
+        selected[i] = !filter || strstr(benchmarks[i].name, filter) != NULL;
+        if (!selected[i]) continue;
+        run_benchmark(&benchmarks[i], min_time_ms, repetitions, &results[i]);
+        fprintf(stderr, "%-40s %12.1f ns  (min %.1f, %lld iterations x %d)", benchmarks[i].name,
+                results[i].median, results[i].min, (long long)results[i].iterations, repetitions);
+        if (benchmarks[i].items > 0) fprintf(stderr, "  %.1f M ticks/s", benchmarks[i].items * 1e3 / results[i].median);
+        fprintf(stderr, "\n");
+    }
+
+    FILE* f = out_path ? fopen(out_path, "w") : stdout;
+    if (!f) {
+        fprintf(stderr, "Cannot write %s\n", out_path);
+        return 1;
+    }
+    write_json(f, min_time_ms, repetitions, results, selected);
+    if (out_path) fclose(f);
+    render_free();
+    spider_batch_free(&lockstep_batch);
+    for (int i = 0; i < LOCKSTEP_GAMES; i++) game_free(&lockstep_games[i]);
+    game_free(&snapshot);
+    game_free(&game);
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include "bmp.h"
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#define BMP_FILE_HEADER_SIZE 14
+#define BMP_BI_RGB 0
+#define BMP_BI_BITFIELDS 3
+
+static uint32_t read_u16(const uint8_t* p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8); }
+static uint32_t read_u32(const uint8_t* p) { return read_u16(p) | (read_u16(p + 2) << 16); }
+
+static int mask_shift(uint32_t mask) {
+    int shift = 0;
+    if (mask == 0) return 0;
+    while (!(mask & 1)) { mask >>= 1; shift++; }
+    return shift;
+}
+
+static uint32_t extract_channel(uint32_t value, uint32_t mask) {
+    if (mask == 0) return 0;
+    uint32_t v = (value & mask) >> mask_shift(mask);
+    uint32_t max = mask >> mask_shift(mask);
+    return max == 0xFF ? v : (v * 255 + max / 2) / max;
+}
+
+bool bmp_parse_header(const uint8_t* data, size_t size, BmpInfo* info) {
+    memset(info, 0, sizeof(*info));
+
+    size_t dib_offset = 0;
+    size_t file_pixel_offset = 0;
+    if (size >= 2 && data[0] == 'B' && data[1] == 'M') {
+        if (size < BMP_FILE_HEADER_SIZE + 40) return false;
+        file_pixel_offset = read_u32(data + 10);
+        dib_offset = BMP_FILE_HEADER_SIZE;
+    } else if (size < 40) {
+        return false;
+    }
+
+    const uint8_t* dib = data + dib_offset;
+    uint32_t header_size = read_u32(dib);
+    if (header_size < 40 || dib_offset + header_size > size) return false;
+
+    int32_t width = (int32_t)read_u32(dib + 4);
+    int32_t height = (int32_t)read_u32(dib + 8);
+    info->bits_per_pixel = (int)read_u16(dib + 14);
+    info->compression = read_u32(dib + 16);
+    uint32_t colors_used = read_u32(dib + 32);
+
+    if (width <= 0 || height == 0) return false;
+    info->width = width;
+    info->top_down = height < 0;
+    info->height = height < 0 ? -height : height;
+
+    switch (info->bits_per_pixel) {
+        case 1: case 4: case 8: case 24: case 32: break;
+        default: return false;
+    }
+    if (info->compression != BMP_BI_RGB && info->compression != BMP_BI_BITFIELDS) return false;
+
+    size_t after_header = dib_offset + header_size;
+    if (info->compression == BMP_BI_BITFIELDS) {
+        if (header_size >= 52) { // V2+ headers carry the masks inline
+            info->masks[0] = read_u32(dib + 40);
+            info->masks[1] = read_u32(dib + 44);
+            info->masks[2] = read_u32(dib + 48);
+            info->masks[3] = header_size >= 56 ? read_u32(dib + 52) : 0;
+        } else { // Plain BITMAPINFOHEADER: three masks follow the header
+            if (after_header + 12 > size) return false;
+            info->masks[0] = read_u32(data + after_header);
+            info->masks[1] = read_u32(data + after_header + 4);
+            info->masks[2] = read_u32(data + after_header + 8);
+            after_header += 12;
+        }
+    } else if (info->bits_per_pixel == 32) {
+        info->masks[0] = 0x00FF0000; info->masks[1] = 0x0000FF00; info->masks[2] = 0x000000FF;
+    }
+
+    if (info->bits_per_pixel <= 8) {
+        int max_colors = 1 << info->bits_per_pixel;
+        info->palette_size = (colors_used == 0 || colors_used > (uint32_t)max_colors) ? max_colors : (int)colors_used;
+        if (after_header + (size_t)info->palette_size * 4 > size) return false;
+        for (int i = 0; i < info->palette_size; i++) {
+            // RGBQUAD is stored B, G, R, reserved - exactly our little-endian layout minus alpha
+            info->palette[i] = read_u32(data + after_header + (size_t)i * 4) | 0xFF000000u;
+        }
+        after_header += (size_t)info->palette_size * 4;
+    }
+
+    info->row_stride = (((size_t)info->width * (size_t)info->bits_per_pixel + 31) / 32) * 4;
+    info->pixel_offset = file_pixel_offset ? file_pixel_offset : after_header;
+    if (info->pixel_offset + info->row_stride * (size_t)info->height > size) return false;
+    return true;
+}
+
+// --- START: Palette lookup ---
+// 8-bit rows: AVX2 gathers eight palette entries per instruction.
+static void expand_indexed8(const uint8_t* src, uint32_t* dst, int w, const uint32_t* palette) {
+    int x = 0;
+#if defined(__AVX2__)
+    for (; x + 8 <= w; x += 8) {
+        __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + x)));
+        _mm256_storeu_si256((__m256i*)(dst + x), _mm256_i32gather_epi32((const int*)palette, idx, 4));
+    }
+#else
+    for (; x + 4 <= w; x += 4) {
+        dst[x] = palette[src[x]];
+        dst[x + 1] = palette[src[x + 1]];
+        dst[x + 2] = palette[src[x + 2]];
+        dst[x + 3] = palette[src[x + 3]];
+    }
+#endif
+    for (; x < w; x++) dst[x] = palette[src[x]];
+}
+
+// 4-bit rows: the 16-entry palette fits in a register, so with SSSE3 each colour
+// channel is a single pshufb of the nibble indices (16 pixels per iteration).
+static void expand_indexed4(const uint8_t* src, uint32_t* dst, int w, const uint32_t* palette) {
+    int x = 0;
+#if defined(__SSSE3__) || defined(__AVX2__)
+    uint8_t planes[4][16];
+    for (int i = 0; i < 16; i++) {
+        planes[0][i] = (uint8_t)palette[i];
+        planes[1][i] = (uint8_t)(palette[i] >> 8);
+        planes[2][i] = (uint8_t)(palette[i] >> 16);
+        planes[3][i] = (uint8_t)(palette[i] >> 24);
+    }
+    __m128i plane_b = _mm_loadu_si128((const __m128i*)planes[0]);
+    __m128i plane_g = _mm_loadu_si128((const __m128i*)planes[1]);
+    __m128i plane_r = _mm_loadu_si128((const __m128i*)planes[2]);
+    __m128i plane_a = _mm_loadu_si128((const __m128i*)planes[3]);
+    __m128i low_nibble = _mm_set1_epi8(0x0F);
+
+    for (; x + 16 <= w; x += 16) {
+        __m128i packed = _mm_loadl_epi64((const __m128i*)(src + x / 2));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(packed, 4), low_nibble);
+        __m128i lo = _mm_and_si128(packed, low_nibble);
+        __m128i idx = _mm_unpacklo_epi8(hi, lo); // left pixel is the high nibble
+
+        __m128i b = _mm_shuffle_epi8(plane_b, idx);
+        __m128i g = _mm_shuffle_epi8(plane_g, idx);
+        __m128i r = _mm_shuffle_epi8(plane_r, idx);
+        __m128i a = _mm_shuffle_epi8(plane_a, idx);
+
+        __m128i bg_lo = _mm_unpacklo_epi8(b, g), bg_hi = _mm_unpackhi_epi8(b, g);
+        __m128i ra_lo = _mm_unpacklo_epi8(r, a), ra_hi = _mm_unpackhi_epi8(r, a);
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_unpacklo_epi16(bg_lo, ra_lo));
+        _mm_storeu_si128((__m128i*)(dst + x + 4), _mm_unpackhi_epi16(bg_lo, ra_lo));
+        _mm_storeu_si128((__m128i*)(dst + x + 8), _mm_unpacklo_epi16(bg_hi, ra_hi));
+        _mm_storeu_si128((__m128i*)(dst + x + 12), _mm_unpackhi_epi16(bg_hi, ra_hi));
+    }
+#endif
+    for (; x < w; x++) dst[x] = palette[(src[x >> 1] >> ((x & 1) ? 0 : 4)) & 0x0F];
+}
+// --- END: Palette lookup ---
+
+void bmp_decode_row(const BmpInfo* info, const uint8_t* src_row, uint32_t* dst_row) {
+    int w = info->width;
+    switch (info->bits_per_pixel) {
+        case 1:
+            for (int x = 0; x < w; x++) dst_row[x] = info->palette[(src_row[x >> 3] >> (7 - (x & 7))) & 1];
+            break;
+        case 4:
+            expand_indexed4(src_row, dst_row, w, info->palette);
+            break;
+        case 8:
+            expand_indexed8(src_row, dst_row, w, info->palette);
+            break;
+        case 24:
+            for (int x = 0; x < w; x++) {
+                const uint8_t* p = src_row + x * 3;
+                dst_row[x] = 0xFF000000u | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+            }
+            break;
+        case 32:
+            if (info->masks[0] == 0x00FF0000 && info->masks[1] == 0x0000FF00 && info->masks[2] == 0x000000FF) {
+                uint32_t alpha_fill = info->masks[3] == 0xFF000000u ? 0 : 0xFF000000u;
+                for (int x = 0; x < w; x++) dst_row[x] = read_u32(src_row + x * 4) | alpha_fill;
+            } else {
+                for (int x = 0; x < w; x++) {
+                    uint32_t v = read_u32(src_row + x * 4);
+                    uint32_t a = info->masks[3] ? extract_channel(v, info->masks[3]) : 0xFF;
+                    dst_row[x] = (a << 24) | (extract_channel(v, info->masks[0]) << 16) |
+                                 (extract_channel(v, info->masks[1]) << 8) | extract_channel(v, info->masks[2]);
+                }
+            }
+            break;
+    }
+}
+
+bool bmp_decode(const uint8_t* data, size_t size, BmpInfo* info, uint32_t* dst) {
+    if (!bmp_parse_header(data, size, info)) return false;
+    for (int row = 0; row < info->height; row++) {
+        int y = info->top_down ? row : info->height - 1 - row;
+        bmp_decode_row(info, data + info->pixel_offset + (size_t)row * info->row_stride, dst + (size_t)y * info->width);
+    }
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef BMP_H
+#define BMP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Minimal BMP/DIB reader. Accepts a full .bmp file (BITMAPFILEHEADER first) or a
+// bare DIB as it sits in the exe's resource section (BITMAPINFOHEADER first, like
+// src/resource_chunk.bin). Output pixels are 0xAARRGGBB, same as the framebuffer.
+
+typedef struct {
+    int width;
+    int height;            // Always positive, see top_down
+    bool top_down;
+    int bits_per_pixel;    // 1, 4, 8, 24 or 32
+    uint32_t compression;  // BI_RGB (0) or BI_BITFIELDS (3), RLE is not supported
+    uint32_t masks[4];     // R, G, B, A for BI_BITFIELDS
+    uint32_t palette[256]; // Already converted to 0xAARRGGBB
+    int palette_size;
+    size_t pixel_offset;   // Offset of the first stored row from the start of the data
+    size_t row_stride;     // Bytes per stored row, padded to 4
+} BmpInfo;
+
+bool bmp_parse_header(const uint8_t* data, size_t size, BmpInfo* info);
+
+// Converts one stored row to 32-bit. src_row points at the row as stored in the file.
+void bmp_decode_row(const BmpInfo* info, const uint8_t* src_row, uint32_t* dst_row);
+
+// Decodes the whole image top-down into dst (width * height pixels).
+bool bmp_decode(const uint8_t* data, size_t size, BmpInfo* info, uint32_t* dst);
+
+#endif // BMP_H
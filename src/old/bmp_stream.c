@@ -0,0 +1,75 @@
+#include "bmp_stream.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void decode_worker(void* arg) {
+    BmpStream* s = (BmpStream*)arg;
+    const BmpInfo* info = &s->info;
+
+    int rows_per_chunk = (int)(BMP_STREAM_CHUNK_BYTES / info->row_stride);
+    if (rows_per_chunk < 1) rows_per_chunk = 1;
+    size_t chunk_bytes = (size_t)rows_per_chunk * info->row_stride;
+
+    // Double buffering through the page cache: ask for chunk N+1 to be read in
+    // while chunk N is being converted.
+    platform_prefetch(&s->file, info->pixel_offset, chunk_bytes);
+
+    for (int row = 0; row < info->height; row += rows_per_chunk) {
+        if (platform_atomic_load(&s->cancel)) return;
+
+        size_t chunk_offset = info->pixel_offset + (size_t)row * info->row_stride;
+        platform_prefetch(&s->file, chunk_offset + chunk_bytes, chunk_bytes);
+
+        int chunk_end = row + rows_per_chunk;
+        if (chunk_end > info->height) chunk_end = info->height;
+        for (int r = row; r < chunk_end; r++) {
+            int y = info->top_down ? r : info->height - 1 - r;
+            bmp_decode_row(info, s->file.data + info->pixel_offset + (size_t)r * info->row_stride,
+                           s->pixels + (size_t)y * info->width);
+        }
+        platform_atomic_store(&s->rows_decoded, chunk_end);
+    }
+    platform_atomic_store(&s->state, BMP_STREAM_DONE);
+}
+
+bool bmp_stream_open(BmpStream* s, const char* path) {
+    memset(s, 0, sizeof(*s));
+    if (!platform_map_file(path, &s->file)) return false;
+
+    if (!bmp_parse_header(s->file.data, s->file.size, &s->info)) goto fail;
+
+    s->pixels = malloc((size_t)s->info.width * s->info.height * sizeof(uint32_t));
+    if (!s->pixels) goto fail;
+
+    s->state = BMP_STREAM_LOADING;
+    if (!platform_thread_start(&s->worker, decode_worker, s)) goto fail;
+    return true;
+
+fail:
+    free(s->pixels);
+    platform_unmap_file(&s->file);
+    memset(s, 0, sizeof(*s));
+    s->state = BMP_STREAM_FAILED;
+    return false;
+}
+
+BmpStreamState bmp_stream_ready_rows(BmpStream* s, int* y_begin, int* y_end) {
+    int rows = platform_atomic_load(&s->rows_decoded);
+    if (s->info.top_down) {
+        *y_begin = 0;
+        *y_end = rows;
+    } else { // Bottom-up files fill the picture from the bottom
+        *y_begin = s->info.height - rows;
+        *y_end = s->info.height;
+    }
+    return (BmpStreamState)platform_atomic_load(&s->state);
+}
+
+void bmp_stream_close(BmpStream* s) {
+    platform_atomic_store(&s->cancel, 1);
+    platform_thread_join(&s->worker);
+    free(s->pixels);
+    platform_unmap_file(&s->file);
+    memset(s, 0, sizeof(*s));
+}
@@ -0,0 +1,43 @@
+#ifndef BMP_STREAM_H
+#define BMP_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bmp.h"
+#include "platform.h"
+
+// Background picture loader (the remake's FUN_1020_07c2). The header is parsed
+// on the caller's thread, then a worker decodes the mapped file in chunks while
+// the OS pages in the next one. Rows become visible to the renderer as soon as
+// they are decoded, so the game keeps running while a large picture loads.
+
+#define BMP_STREAM_CHUNK_BYTES (256 * 1024)
+
+typedef enum {
+    BMP_STREAM_IDLE,
+    BMP_STREAM_LOADING,
+    BMP_STREAM_DONE,
+    BMP_STREAM_FAILED
+} BmpStreamState;
+
+typedef struct {
+    BmpInfo info;
+    uint32_t* pixels;    // width * height, top-down, 0xAARRGGBB
+    MappedFile file;
+    PlatformThread worker;
+    int rows_decoded;    // In file order; atomic
+    int state;           // BmpStreamState; atomic
+    int cancel;          // Set by bmp_stream_close; atomic
+} BmpStream;
+
+// Parses the header and starts decoding. Returns false if the file can't be used.
+bool bmp_stream_open(BmpStream* s, const char* path);
+
+// Image rows [*y_begin, *y_end) (top-down) are fully decoded and may be read.
+// Returns the current BmpStreamState.
+BmpStreamState bmp_stream_ready_rows(BmpStream* s, int* y_begin, int* y_end);
+
+// Stops the worker if it is still running and frees everything.
+void bmp_stream_close(BmpStream* s);
+
+#endif // BMP_STREAM_H
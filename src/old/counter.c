@@ -0,0 +1,104 @@
+#include "counter.h"
+
+#include <string.h>
+#include "render.h"
+#include "trace.h"
+
+#define STRIP_W (COUNTER_GLYPH_COUNT * COUNTER_DIGIT_W)
+
+static uint32_t builtin_strip[STRIP_W * COUNTER_DIGIT_H];
+static uint8_t glyph_strip[STRIP_W * COUNTER_DIGIT_H]; // As palette indices
+static bool glyphs_set = false;
+
+// --- START: Glyphs ---
+// Seven segments a..g as {x, y, w, h} in a digit cell
+static const uint8_t segment_rects[7][4] = {
+    {3, 2, 7, 2},   // a, top
+    {10, 4, 2, 6},  // b, upper right
+    {10, 12, 2, 6}, // c, lower right
+    {3, 18, 7, 2},  // d, bottom
+    {1, 12, 2, 6},  // e, lower left
+    {1, 4, 2, 6},   // f, upper left
+    {3, 10, 7, 2}   // g, middle
+};
+
+// Lit segments of 0-9 (bit 0 = a); the blank glyph has none
+static const uint8_t digit_segments[COUNTER_GLYPH_COUNT] = {
+    0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x07, 0x7f, 0x6f, 0x00
+};
+
+static void build_builtin_strip(void) {
+    const uint32_t background = 0x000000, unlit = 0x300000, lit = 0xFF0000;
+    for (int i = 0; i < STRIP_W * COUNTER_DIGIT_H; i++) builtin_strip[i] = background;
+    for (int glyph = 0; glyph < COUNTER_GLYPH_COUNT; glyph++) {
+        for (int s = 0; s < 7; s++) {
+            uint32_t color = (digit_segments[glyph] >> s & 1) ? lit : unlit;
+            const uint8_t* r = segment_rects[s];
+            for (int y = r[1]; y < r[1] + r[3]; y++) {
+                for (int x = r[0]; x < r[0] + r[2]; x++) {
+                    builtin_strip[y * STRIP_W + glyph * COUNTER_DIGIT_W + x] = color;
+                }
+            }
+        }
+    }
+}
+
+void counter_set_glyphs(const uint32_t* strip) {
+    if (!strip) {
+        build_builtin_strip();
+        strip = builtin_strip;
+    }
+    for (int i = 0; i < STRIP_W * COUNTER_DIGIT_H; i++) glyph_strip[i] = palette_index(strip[i]);
+    glyphs_set = true;
+}
+
+static void blit_glyph(int glyph, int x, int y) {
+    TRACE_COUNT(TRACE_COUNTER_BLITS, 1);
+    int frame_w = win_w, frame_h = win_h;
+    if (x < 0 || y < 0 || x + COUNTER_DIGIT_W > frame_w || y + COUNTER_DIGIT_H > frame_h) return;
+    const uint8_t* src = glyph_strip + glyph * COUNTER_DIGIT_W;
+    uint8_t* dst = frame + (size_t)y * frame_w + x;
+    for (int row = 0; row < COUNTER_DIGIT_H; row++) {
+        memcpy(dst, src, COUNTER_DIGIT_W);
+        src += STRIP_W;
+        dst += frame_w;
+    }
+}
+// --- END: Glyphs ---
+
+void counter_init(Counter* c, int x, int y, int digits) {
+    memset(c, 0, sizeof(Counter));
+    c->x = x;
+    c->y = y;
+    c->digits = digits < 1 ? 1 : digits > COUNTER_MAX_DIGITS ? COUNTER_MAX_DIGITS : digits;
+}
+
+void counter_invalidate(Counter* c) {
+    c->valid = false;
+}
+
+int counter_draw(Counter* c, uint32_t value) {
+    if (!glyphs_set) counter_set_glyphs(NULL);
+
+    // Right to left; v * ceil(2^35 / 10) >> 35 is v / 10 for every 32-bit v
+    uint8_t glyphs[COUNTER_MAX_DIGITS];
+    for (int i = c->digits - 1; i >= 0; i--) {
+        uint32_t quotient = (uint32_t)((uint64_t)value * 0xCCCCCCCDu >> 35);
+        glyphs[i] = (uint8_t)(value - quotient * 10);
+        value = quotient;
+        if (value == 0) {
+            for (int k = 0; k < i; k++) glyphs[k] = COUNTER_GLYPH_BLANK;
+            break;
+        }
+    }
+
+    int blitted = 0;
+    for (int i = 0; i < c->digits; i++) {
+        if (c->valid && c->shown[i] == glyphs[i]) continue;
+        blit_glyph(glyphs[i], c->x + i * COUNTER_DIGIT_W, c->y);
+        c->shown[i] = glyphs[i];
+        blitted++;
+    }
+    c->valid = true;
+    return blitted;
+}
@@ -0,0 +1,43 @@
+#ifndef COUNTER_H
+#define COUNTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Digit counters in the frame's status bar, after the original's COUNTERWNDPROC.
+//
+// FUN_1028_0170 redrew every digit of a counter on each 0x402 update, with a
+// 32-bit divide and mod (FUN_1048_0784/0850) and a BitBlt from the digit strip
+// per digit. A Counter instead remembers the glyph in each of its cells and
+// blits only the cells whose glyph changed, so a score going up by one costs
+// one 13x21 copy. Digits come from a multiply by the reciprocal of ten, which
+// tcc would not derive from a plain `/ 10` itself.
+//
+// Glyphs are cut from one strip, 0-9 then blank, like the original's: "digits"
+// from mamba.pak when present, otherwise seven-segment glyphs drawn once.
+
+#define COUNTER_DIGIT_W 13
+#define COUNTER_DIGIT_H 21
+#define COUNTER_GLYPH_BLANK 10 // Leading zeros, as in FUN_1028_0170
+#define COUNTER_GLYPH_COUNT 11
+#define COUNTER_MAX_DIGITS 10  // Enough for any uint32_t
+
+typedef struct {
+    int x, y;   // Top left in the frame
+    int digits; // Cells, 1..COUNTER_MAX_DIGITS; larger values show their low digits
+    uint8_t shown[COUNTER_MAX_DIGITS]; // Glyph in each cell, left to right
+    bool valid; // False until drawn into the current frame
+} Counter;
+
+// Sets the glyph strip: COUNTER_GLYPH_COUNT * COUNTER_DIGIT_W by COUNTER_DIGIT_H
+// pixels, or NULL for the built-in glyphs. Its colors go into render.h's palette,
+// so call it after render_init.
+void counter_set_glyphs(const uint32_t* strip);
+
+void counter_init(Counter* c, int x, int y, int digits);
+// Makes the next counter_draw redraw every cell, e.g. after the frame was reallocated
+void counter_invalidate(Counter* c);
+// Shows value in `frame`, blitting only the cells that change. Returns the cells blitted.
+int counter_draw(Counter* c, uint32_t value);
+
+#endif // COUNTER_H
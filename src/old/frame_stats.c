@@ -0,0 +1,178 @@
+#include "frame_stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "platform.h"
+#include "render.h"
+
+static const int spike_percent[FRAME_STATS_SPIKE_BUCKETS] = { 150, 200, 300, 500 };
+
+void frame_stats_init(FrameStats* s, uint64_t target_ns) {
+    memset(s, 0, sizeof(FrameStats));
+    s->target_ns = target_ns;
+}
+
+void frame_stats_enable(FrameStats* s, bool enabled) {
+    if (enabled && !s->enabled) s->frame_start = 0; // The first interval would span the pause
+    s->enabled = enabled || s->csv;
+}
+
+bool frame_stats_open_csv(FrameStats* s, const char* path) {
+    s->csv = fopen(path, "w");
+    if (!s->csv) return false;
+    fprintf(s->csv, "frame,interval_us,sim_us,claim_us,compose_us,present_us,tiles\n");
+    frame_stats_enable(s, true);
+    return true;
+}
+
+void frame_stats_close(FrameStats* s) {
+    if (s->csv) fclose(s->csv);
+    s->csv = NULL;
+    s->enabled = false;
+}
+
+// --- START: Recording ---
+static void complete_frame(FrameStats* s) {
+    FrameSample* f = &s->current;
+    s->window[s->frames % FRAME_STATS_WINDOW] = *f;
+    s->frames++;
+    for (int i = 0; i < FRAME_STATS_SPIKE_BUCKETS; i++) {
+        if (f->interval_ns * 100 >= s->target_ns * (uint64_t)spike_percent[i]) s->spikes[i]++;
+    }
+    if (s->csv) {
+        fprintf(s->csv, "%u,%.1f,%.1f,%.1f,%.1f,%.1f,%u\n", s->frames, f->interval_ns * 1e-3,
+                f->phase_ns[FRAME_PHASE_SIM] * 1e-3, f->phase_ns[FRAME_PHASE_CLAIM] * 1e-3,
+                f->phase_ns[FRAME_PHASE_COMPOSE] * 1e-3, f->phase_ns[FRAME_PHASE_PRESENT] * 1e-3, f->tiles);
+    }
+}
+
+void frame_stats_begin_frame(FrameStats* s) {
+    if (!s->enabled) return;
+    uint64_t now = platform_time_ns();
+    if (s->frame_start) {
+        s->current.interval_ns = now - s->frame_start;
+        complete_frame(s);
+    }
+    memset(&s->current, 0, sizeof(FrameSample));
+    s->frame_start = now;
+}
+
+void frame_stats_begin(FrameStats* s, FramePhase phase) {
+    if (!s->enabled) return;
+    s->phase_start[phase] = platform_time_ns();
+}
+
+void frame_stats_end(FrameStats* s, FramePhase phase) {
+    if (!s->enabled) return;
+    s->current.phase_ns[phase] += platform_time_ns() - s->phase_start[phase];
+}
+
+void frame_stats_add(FrameStats* s, FramePhase phase, uint64_t ns) {
+    if (!s->enabled) return;
+    s->current.phase_ns[phase] += ns;
+}
+
+void frame_stats_add_tiles(FrameStats* s, int tiles) {
+    if (!s->enabled) return;
+    s->current.tiles += (uint32_t)tiles;
+}
+// --- END: Recording ---
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+double frame_stats_percentile_ms(const FrameStats* s, int phase, double fraction) {
+    int n = s->frames < FRAME_STATS_WINDOW ? (int)s->frames : FRAME_STATS_WINDOW;
+    if (n == 0) return 0.0;
+    uint64_t values[FRAME_STATS_WINDOW];
+    for (int i = 0; i < n; i++) {
+        values[i] = phase == FRAME_PHASE_COUNT ? s->window[i].interval_ns : s->window[i].phase_ns[phase];
+    }
+    qsort(values, (size_t)n, sizeof(uint64_t), compare_u64);
+    int k = (int)(fraction * n + 0.5) - 1; // Nearest rank
+    if (k < 0) k = 0;
+    if (k > n - 1) k = n - 1;
+    return values[k] * 1e-6;
+}
+
+// --- START: Overlay ---
+#define GRAPH_W 128
+#define GRAPH_H 48    // Twice the target interval
+#define TEXT_ROWS 7
+#define PANEL_W (GRAPH_W + 8)
+#define PANEL_H (GRAPH_H + 12 + TEXT_ROWS * 7)
+
+// 3x5 glyphs, rows top to bottom, 3 bits each with the leftmost pixel highest
+static const char font_chars[] = "0123456789.ACEFIKLMNOPRST";
+static const uint16_t font_glyphs[] = {
+    075557, 026227, 071747, 071717, 055711, 074717, 074757, 071111, 075757, 075717, 000002,
+    025755, 074447, 074647, 074644, 072227, 055655, 044447, 057755, 065555, 075557, 065644,
+    065655, 074717, 072222
+};
+
+static void put_pixel(int x, int y, uint8_t color) {
+    if (x >= 0 && y >= 0 && x < win_w && y < win_h) frame[(size_t)y * win_w + x] = color;
+}
+
+static void draw_text(int x, int y, const char* text, uint8_t color) {
+    for (; *text; text++, x += 4) {
+        const char* at = strchr(font_chars, *text);
+        if (*text == ' ' || !at) continue;
+        uint16_t glyph = font_glyphs[at - font_chars];
+        for (int row = 0; row < 5; row++) {
+            for (int col = 0; col < 3; col++) {
+                if (glyph >> (14 - row * 3 - col) & 1) put_pixel(x + col, y + row, color);
+            }
+        }
+    }
+}
+
+// Pixels of graph for ns, GRAPH_H being twice the target
+static int graph_height(const FrameStats* s, uint64_t ns) {
+    uint64_t h = s->target_ns ? ns * (GRAPH_H / 2) / s->target_ns : 0;
+    return h > GRAPH_H ? GRAPH_H : (int)h;
+}
+
+void frame_stats_draw(const FrameStats* s, int x, int y) {
+    uint8_t panel = palette_index(0x202020), text = color_white, target = palette_index(0x808080);
+    uint8_t phase_colors[FRAME_PHASE_COUNT] = {
+        palette_index(0x00C000), palette_index(0xFF4040), palette_index(0xFFC000), palette_index(0x4080FF)
+    };
+    draw_rect(x, y, PANEL_W, PANEL_H, panel);
+
+    // One column per frame, newest on the right: the phases stacked, the interval as a dot
+    int gx = x + 4, gy = y + 4 + GRAPH_H; // Bottom left
+    for (int i = 0; i < GRAPH_W; i++) put_pixel(gx + i, gy - GRAPH_H / 2, target);
+    int n = s->frames < GRAPH_W ? (int)s->frames : GRAPH_W;
+    for (int i = 0; i < n; i++) {
+        const FrameSample* f = &s->window[(s->frames - n + i) % FRAME_STATS_WINDOW];
+        int column = gx + GRAPH_W - n + i, top = 0;
+        for (int p = 0; p < FRAME_PHASE_COUNT; p++) {
+            int h = graph_height(s, f->phase_ns[p]);
+            if (f->phase_ns[p] && h == 0) h = 1; // Still there
+            if (top + h > GRAPH_H) h = GRAPH_H - top;
+            for (int k = 0; k < h; k++) put_pixel(column, gy - 1 - top - k, phase_colors[p]);
+            top += h;
+        }
+        put_pixel(column, gy - graph_height(s, f->interval_ns), text);
+    }
+
+    static const char* const labels[FRAME_PHASE_COUNT + 1] = { "SIM", "CLAIM", "COMPOSE", "PRESENT", "FRAME" };
+    char line[40];
+    int ty = gy + 8;
+    draw_text(x + 4 + 8 * 4, ty, "P50   P99", text);
+    for (int p = 0; p <= FRAME_PHASE_COUNT; p++) {
+        ty += 7;
+        double p50 = frame_stats_percentile_ms(s, p, 0.5), p99 = frame_stats_percentile_ms(s, p, 0.99);
+        snprintf(line, sizeof(line), "%-7s %5.2f %5.2f", labels[p], p50 < 100.0 ? p50 : 99.99, p99 < 100.0 ? p99 : 99.99);
+        draw_text(x + 4, ty, line, p < FRAME_PHASE_COUNT ? phase_colors[p] : text);
+    }
+    ty += 7;
+    const FrameSample* last = s->frames ? &s->window[(s->frames - 1) % FRAME_STATS_WINDOW] : &s->current;
+    snprintf(line, sizeof(line), "TILES %u SPIKES %u %u %u %u", last->tiles % 1000,
+             s->spikes[0] % 1000, s->spikes[1] % 1000, s->spikes[2] % 1000, s->spikes[3] % 1000);
+    draw_text(x + 4, ty, line, text);
+}
+// --- END: Overlay ---
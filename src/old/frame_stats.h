@@ -0,0 +1,70 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Per-frame timings of the window's pipeline, shown as an overlay and/or logged to CSV.
+//
+// A frame runs from one composed snapshot to the next on the render thread: the
+// simulation step that produced the snapshot and the claim in it (if any, and
+// not counted in the step), both timed on the sim thread and added here, then
+// composing (render_frame, present, scaling) and the StretchDIBits copy to the
+// window. The stats belong to the render thread. The last FRAME_STATS_WINDOW frames
+// give rolling p50/p99 per phase; frames that start late by a good margin are
+// counted in a spike histogram for the whole run. Every call returns right away
+// while the stats are disabled, so leaving the calls in costs a branch each.
+
+#define FRAME_STATS_WINDOW 256
+#define FRAME_STATS_SPIKE_BUCKETS 4 // Frame interval at least 1.5, 2, 3 and 5 times the target
+
+typedef enum {
+    FRAME_PHASE_SIM,
+    FRAME_PHASE_CLAIM,
+    FRAME_PHASE_COMPOSE,
+    FRAME_PHASE_PRESENT,
+    FRAME_PHASE_COUNT
+} FramePhase;
+
+typedef struct {
+    uint64_t interval_ns; // Start of this frame to the start of the next
+    uint64_t phase_ns[FRAME_PHASE_COUNT];
+    uint32_t tiles;       // Tiles redrawn, see render_present (the overlay changes a few itself)
+} FrameSample;
+
+typedef struct {
+    bool enabled;
+    uint64_t target_ns;   // Intended frame interval (the tick period)
+    uint32_t frames;      // Completed frames
+    FrameSample current;  // Frame in progress
+    uint64_t frame_start;
+    uint64_t phase_start[FRAME_PHASE_COUNT];
+    FrameSample window[FRAME_STATS_WINDOW]; // Ring of the last completed frames
+    uint32_t spikes[FRAME_STATS_SPIKE_BUCKETS];
+    FILE* csv;
+} FrameStats;
+
+// Disabled until frame_stats_enable or frame_stats_open_csv
+void frame_stats_init(FrameStats* s, uint64_t target_ns);
+void frame_stats_enable(FrameStats* s, bool enabled);
+// Logs every completed frame to path and enables the stats. False if it cannot be created.
+bool frame_stats_open_csv(FrameStats* s, const char* path);
+// Flushes and closes the log
+void frame_stats_close(FrameStats* s);
+
+// Completes the previous frame and starts the next
+void frame_stats_begin_frame(FrameStats* s);
+void frame_stats_begin(FrameStats* s, FramePhase phase);
+void frame_stats_end(FrameStats* s, FramePhase phase);
+// Adds ns timed elsewhere (on another thread) to a phase of this frame
+void frame_stats_add(FrameStats* s, FramePhase phase, uint64_t ns);
+void frame_stats_add_tiles(FrameStats* s, int tiles);
+
+// Percentile (0..1) over the window, in ms: of a phase, or of the frame interval for FRAME_PHASE_COUNT
+double frame_stats_percentile_ms(const FrameStats* s, int phase, double fraction);
+
+// Draws the stats into render.h's frame, top left at (x, y)
+void frame_stats_draw(const FrameStats* s, int x, int y);
+
+#endif // FRAME_STATS_H
@@ -0,0 +1,731 @@
+#include "game.h"
+
+#include <stdlib.h>
+#include <string.h> // For memset/memcpy
+#include "snake.h"
+#include "trace.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define GAME_KERNEL static inline __attribute__((always_inline))
+#else
+#define GAME_KERNEL static inline
+#endif
+
+#define CLAIM_MAX_REGIONS 10 // Distinct regions considered per claim, as before
+
+void (*game_sound_handler)(SoundId id) = NULL;
+uint64_t (*game_claim_clock)(void) = NULL;
+uint64_t game_claim_ns = 0;
+
+static void play_sound(SoundId id) {
+    if (game_sound_handler) game_sound_handler(id);
+}
+
+// --- START: Allocation ---
+static size_t align_up(size_t n) {
+    return (n + 15) & ~(size_t)15;
+}
+
+// Points the arrays into g->block (when set) and returns the bytes they need: state first, then scratch
+static size_t layout_block(Game* g, size_t* state_size) {
+    size_t w = (size_t)g->w, h = (size_t)g->h;
+    size_t cells = align_up(w * h);
+    size_t edges_h = align_up(w * (h + 1));
+    size_t edges_v = align_up((w + 1) * h);
+    size_t vertices = align_up((size_t)g->path_capacity * sizeof(Point));
+    size_t snakes = align_up((size_t)g->snake_capacity * sizeof(Snake));
+    size_t past_path_h = cells;
+    size_t past_path_v = past_path_h + edges_h;
+    size_t path_h = past_path_v + edges_v;
+    size_t path_v = path_h + edges_h;
+    size_t path_vertices = path_v + edges_v;
+    size_t snake_records = path_vertices + vertices;
+    size_t snake_cells = snake_records + snakes;
+    size_t region_labels = snake_cells + cells;
+    size_t fill_queue = region_labels + cells;
+    size_t danger_bits = fill_queue + align_up(w * h * sizeof(uint32_t));
+    size_t danger_cells = danger_bits + align_up((w * h + 63) / 64 * sizeof(uint64_t));
+    *state_size = region_labels;
+
+    uint8_t* base = g->block;
+    if (base) {
+        g->claimed = base;
+        g->past_path_h = base + past_path_h;
+        g->past_path_v = base + past_path_v;
+        g->path_h = base + path_h;
+        g->path_v = base + path_v;
+        g->current_path_vertices = (Point*)(base + path_vertices);
+        g->snakes = (Snake*)(base + snake_records);
+        g->snake_cells = base + snake_cells;
+        g->region_labels = base + region_labels;
+        g->fill_queue = (uint32_t*)(base + fill_queue);
+        g->danger_bits = (uint64_t*)(base + danger_bits);
+        g->danger_cells = (uint32_t*)(base + danger_cells);
+    }
+    return danger_cells + 5 * sizeof(uint32_t);
+}
+
+// Clamps and records the board size and everything sized by it
+static void set_size(Game* g, int w, int h, int max_snakes) {
+    memset(g, 0, sizeof(*g));
+    if (w < GAME_MIN_CELLS) w = GAME_MIN_CELLS;
+    if (w > GAME_MAX_CELLS) w = GAME_MAX_CELLS;
+    if (h < GAME_MIN_CELLS) h = GAME_MIN_CELLS;
+    if (h > GAME_MAX_CELLS) h = GAME_MAX_CELLS;
+    g->w = w;
+    g->h = h;
+    g->total_cells = w * h;
+    // A path ends as soon as it revisits a vertex, so it never holds more than every vertex once plus one
+    g->path_capacity = (w + 1) * (h + 1) + 1;
+    g->snake_capacity = max_snakes > 0 ? max_snakes : 0;
+    g->level = 1;
+    game_seed(g, 1);
+    g->block_size = align_up(layout_block(g, &g->state_size)); // Sizes only; block is still NULL
+}
+
+size_t game_block_size(int w, int h, int max_snakes) {
+    Game g;
+    set_size(&g, w, h, max_snakes);
+    return g.block_size;
+}
+
+bool game_init_in(Game* g, int w, int h, int max_snakes, void* block) {
+    set_size(g, w, h, max_snakes);
+    g->block = block;
+    if (!g->block) return false;
+    layout_block(g, &g->state_size);
+    memset(g->danger_bits, 0, (g->total_cells + 63) / 64 * sizeof(uint64_t));
+    g->danger_cells[0] = 0;
+    initialize_game_state(g);
+    return true;
+}
+
+bool game_init(Game* g, int w, int h, int max_snakes) {
+    if (!game_init_in(g, w, h, max_snakes, malloc(game_block_size(w, h, max_snakes)))) return false;
+    g->owns_block = true;
+    return true;
+}
+
+void game_free(Game* g) {
+    if (g->owns_block) free(g->block);
+    memset(g, 0, sizeof(*g));
+}
+
+void game_copy(Game* dst, const Game* src) {
+    void* block = dst->block;
+    bool owns_block = dst->owns_block;
+    *dst = *src;
+    dst->block = block;
+    dst->owns_block = owns_block;
+    layout_block(dst, &dst->state_size);
+    memcpy(dst->block, src->block, src->state_size);
+}
+
+size_t game_state_bytes(const Game* g) {
+    return sizeof(Game) + g->state_size;
+}
+
+size_t game_wall_planes_bytes(const Game* g) {
+    return (size_t)(g->path_h - g->claimed);
+}
+
+void game_save_state(const Game* g, void* out) {
+    memcpy(out, g, sizeof(Game));
+    memcpy((uint8_t*)out + sizeof(Game), g->block, g->state_size);
+}
+
+void game_load_state(Game* g, const void* in) {
+    void* block = g->block;
+    bool owns_block = g->owns_block;
+    memcpy(g, in, sizeof(Game));
+    g->block = block;
+    g->owns_block = owns_block;
+    layout_block(g, &g->state_size);
+    memcpy(g->block, (const uint8_t*)in + sizeof(Game), g->state_size);
+}
+// --- END: Allocation ---
+
+void game_seed(Game* g, uint64_t seed) {
+    // splitmix64 spreads neighbouring seeds apart; xorshift32 must not start at 0
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    g->rng = (uint32_t)z ? (uint32_t)z : 0x6d616d62u;
+}
+
+int game_random(Game* g) {
+    uint32_t x = g->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    g->rng = x;
+    return (int)(x >> 17);
+}
+
+bool game_is_won(const Game* g) {
+    return g->claimed_cell_count * 100 >= g->total_cells * GAME_WIN_PERCENT;
+}
+
+// --- START: Hashing ---
+static uint64_t hash_mix(uint64_t hash, uint64_t value) {
+    return game_hash_key(0x7f, (size_t)(hash ^ value)) ^ (hash >> 1);
+}
+
+uint64_t game_hash(const Game* g) {
+    uint64_t hash = g->hash;
+    hash = hash_mix(hash, (uint64_t)(uint32_t)g->spider_x | (uint64_t)(uint32_t)g->spider_y << 32);
+    hash = hash_mix(hash, (uint64_t)(uint32_t)g->spider_vx | (uint64_t)(uint32_t)g->spider_vy << 32);
+    hash = hash_mix(hash, (uint64_t)(uint32_t)g->input_vx_intent | (uint64_t)(uint32_t)g->input_vy_intent << 32);
+    hash = hash_mix(hash, (uint64_t)(uint32_t)g->last_vertex_x | (uint64_t)(uint32_t)g->last_vertex_y << 32);
+    hash = hash_mix(hash, (uint64_t)(uint32_t)g->path_start_vertex_x | (uint64_t)(uint32_t)g->path_start_vertex_y << 32);
+    hash = hash_mix(hash, (uint64_t)g->spider_state | (uint64_t)(uint32_t)g->level << 8 | (uint64_t)g->rng << 32);
+    hash = hash_mix(hash, (uint64_t)g->tick | (uint64_t)(uint32_t)g->current_path_len << 32);
+    for (int i = 0; i < g->snake_count; i++) {
+        const Snake* s = &g->snakes[i];
+        const SnakeSegment* head = &s->segments[s->head];
+        hash = hash_mix(hash, (uint64_t)s->grown | (uint64_t)s->head << 8 | (uint64_t)s->tail << 16 |
+                              (uint64_t)s->alive << 24 | (uint64_t)head->dir << 32);
+    }
+    return hash;
+}
+
+uint64_t game_hash_recompute(const Game* g) {
+    size_t cells = (size_t)g->w * (size_t)g->h;
+    size_t edges_h = (size_t)g->w * (size_t)(g->h + 1);
+    size_t edges_v = (size_t)(g->w + 1) * (size_t)g->h;
+    uint64_t hash = 0;
+    for (size_t i = 0; i < cells; i++) {
+        if (g->claimed[i]) hash ^= game_hash_key(GAME_HASH_CLAIMED, i);
+        if (g->snake_cells[i]) hash ^= game_hash_key(GAME_HASH_SNAKE_CELL, i << 8 | g->snake_cells[i]);
+    }
+    for (size_t i = 0; i < edges_h; i++) {
+        if (g->past_path_h[i]) hash ^= game_hash_key(GAME_HASH_PAST_PATH_H, i);
+        if (g->path_h[i]) hash ^= game_hash_key(GAME_HASH_PATH_H, i);
+    }
+    for (size_t i = 0; i < edges_v; i++) {
+        if (g->past_path_v[i]) hash ^= game_hash_key(GAME_HASH_PAST_PATH_V, i);
+        if (g->path_v[i]) hash ^= game_hash_key(GAME_HASH_PATH_V, i);
+    }
+    return hash;
+}
+// --- END: Hashing ---
+
+bool is_spider_on_cross_section(const Game* g) {
+    bool on_cross_section_x = (g->spider_x % CELL_PITCH) == 0;
+    bool on_cross_section_y = (g->spider_y % CELL_PITCH) == 0;
+    return on_cross_section_x && on_cross_section_y;
+}
+
+// --- START: Movement and Path Logic Helper Functions ---
+static bool is_edge_part_of_claimed_area(const Game* g, int gx, int gy, bool is_horizontal_edge) {
+    // gx, gy are grid coordinates of the top-left part of the edge or cell.
+    // For horizontal edge at (gx, gy), it's path_h(gx, gy).
+    // For vertical edge at (gx, gy), it's path_v(gx, gy).
+    if (is_horizontal_edge) {
+        if (gx < 0 || gx >= g->w || gy < 0 || gy > g->h) return false;
+        if (GAME_PAST_PATH_H(g, gx, gy)) return true;
+        if (gy > 0 && gy < g->h) { // Edge is between cells
+            return GAME_CLAIMED(g, gx, gy - 1) && GAME_CLAIMED(g, gx, gy);
+        } else if (gy == 0 && gy < g->h) { // Top border edge
+             return GAME_CLAIMED(g, gx, gy);
+        } else if (gy == g->h && gy > 0) { // Bottom border edge
+            return GAME_CLAIMED(g, gx, gy - 1);
+        }
+    } else { // Vertical edge
+        if (gx < 0 || gx > g->w || gy < 0 || gy >= g->h) return false;
+        if (GAME_PAST_PATH_V(g, gx, gy)) return true;
+        if (gx > 0 && gx < g->w) { // Edge is between cells
+            return GAME_CLAIMED(g, gx - 1, gy) && GAME_CLAIMED(g, gx, gy);
+        } else if (gx == 0 && gx < g->w) { // Left border edge
+            return GAME_CLAIMED(g, gx, gy);
+        } else if (gx == g->w && gx > 0) { // Right border edge
+            return GAME_CLAIMED(g, gx - 1, gy);
+        }
+    }
+    return false;
+}
+
+static bool can_move_on_claimed_territory(const Game* g, int cvx, int cvy, int move_dir_x, int move_dir_y) {
+    // cvx, cvy: current spider vertex (grid coords)
+    // move_dir_x, move_dir_y: intended direction of movement (-1, 0, or 1 for grid steps)
+    if (move_dir_x == 1)  return is_edge_part_of_claimed_area(g, cvx, cvy, true);       // Right: H-edge at (cvx, cvy)
+    if (move_dir_x == -1) return is_edge_part_of_claimed_area(g, cvx - 1, cvy, true);   // Left:  H-edge at (cvx-1, cvy)
+    if (move_dir_y == 1)  return is_edge_part_of_claimed_area(g, cvx, cvy, false);      // Down:  V-edge at (cvx, cvy)
+    if (move_dir_y == -1) return is_edge_part_of_claimed_area(g, cvx, cvy - 1, false);  // Up:    V-edge at (cvx, cvy-1)
+    return false;
+}
+
+static bool can_start_drawing_path(const Game* g, int cvx, int cvy, int move_dir_x, int move_dir_y) {
+    // Check if the cells adjacent to the new path segment are unclaimed.
+    int w = g->w, h = g->h;
+    if (move_dir_x == 1) { // Drawing H-Path right from (cvx,cvy) -> path_h(cvx, cvy)
+        bool above_ok = (cvy == 0) || (cvy > 0 && cvx < w && !GAME_CLAIMED(g, cvx, cvy - 1));
+        bool below_ok = (cvy == h) || (cvy < h && cvx < w && !GAME_CLAIMED(g, cvx, cvy));
+        return above_ok && below_ok;
+    } else if (move_dir_x == -1) { // Drawing H-Path left from (cvx,cvy) -> path_h(cvx-1, cvy)
+        bool above_ok = (cvy == 0) || (cvy > 0 && cvx > 0 && !GAME_CLAIMED(g, cvx - 1, cvy - 1));
+        bool below_ok = (cvy == h) || (cvy < h && cvx > 0 && !GAME_CLAIMED(g, cvx - 1, cvy));
+        return above_ok && below_ok;
+    } else if (move_dir_y == 1) { // Drawing V-Path down from (cvx,cvy) -> path_v(cvx, cvy)
+        bool left_ok = (cvx == 0) || (cvx > 0 && cvy < h && !GAME_CLAIMED(g, cvx - 1, cvy));
+        bool right_ok = (cvx == w) || (cvx < w && cvy < h && !GAME_CLAIMED(g, cvx, cvy));
+        return left_ok && right_ok;
+    } else if (move_dir_y == -1) { // Drawing V-Path up from (cvx,cvy) -> path_v(cvx, cvy-1)
+        bool left_ok = (cvx == 0) || (cvx > 0 && cvy > 0 && !GAME_CLAIMED(g, cvx - 1, cvy - 1));
+        bool right_ok = (cvx == w) || (cvx < w && cvy > 0 && !GAME_CLAIMED(g, cvx, cvy - 1));
+        return left_ok && right_ok;
+    }
+    return false;
+}
+
+static bool is_vertex_on_claimed_border(const Game* g, int vx, int vy) {
+    int w = g->w, h = g->h;
+    // Check past_path edges incident to vertex (vx,vy)
+    if (vx < w && GAME_PAST_PATH_H(g, vx, vy)) return true;         // Edge to the right
+    if (vx > 0 && GAME_PAST_PATH_H(g, vx - 1, vy)) return true;     // Edge to the left
+    if (vy < h && GAME_PAST_PATH_V(g, vx, vy)) return true;         // Edge below
+    if (vy > 0 && GAME_PAST_PATH_V(g, vx, vy - 1)) return true;     // Edge above
+
+    // Check if vertex is a corner of any claimed cell
+    if (vx < w && vy < h && GAME_CLAIMED(g, vx, vy)) return true;             // Vertex is BR corner of cell (vx,vy)
+    if (vx > 0 && vy < h && GAME_CLAIMED(g, vx - 1, vy)) return true;         // Vertex is BL corner of cell (vx-1,vy)
+    if (vx < w && vy > 0 && GAME_CLAIMED(g, vx, vy - 1)) return true;         // Vertex is TR corner of cell (vx,vy-1)
+    if (vx > 0 && vy > 0 && GAME_CLAIMED(g, vx - 1, vy - 1)) return true;     // Vertex is TL corner of cell (vx-1,vy-1)
+
+    return false;
+}
+
+// Flag index of the edge between two neighbouring vertices, in path_h or path_v
+static size_t edge_index(const Game* g, Point a, Point b, bool* horizontal) {
+    *horizontal = a.y == b.y;
+    if (*horizontal) return (size_t)a.y * (size_t)g->w + (size_t)(a.x < b.x ? a.x : b.x);
+    return (size_t)(a.y < b.y ? a.y : b.y) * (size_t)(g->w + 1) + (size_t)a.x;
+}
+
+void clear_current_path_data(Game* g) {
+    // The path's edges are the ones between its vertices; unhash those, then wipe
+    for (int i = 1; i < g->current_path_len; i++) {
+        bool horizontal;
+        size_t e = edge_index(g, g->current_path_vertices[i - 1], g->current_path_vertices[i], &horizontal);
+        uint8_t* flags = horizontal ? g->path_h : g->path_v;
+        if (flags[e]) {
+            flags[e] = 0;
+            g->hash ^= game_hash_key(horizontal ? GAME_HASH_PATH_H : GAME_HASH_PATH_V, e);
+        }
+    }
+    memset(g->path_h, 0, (size_t)g->w * (size_t)(g->h + 1));
+    memset(g->path_v, 0, (size_t)(g->w + 1) * (size_t)g->h);
+    g->current_path_len = 0;
+}
+
+// Drops the current path and puts the spider back where it started
+static void return_to_path_start(Game* g) {
+    clear_current_path_data(g);
+    g->spider_x = g->path_start_vertex_x * CELL_PITCH;
+    g->spider_y = g->path_start_vertex_y * CELL_PITCH;
+    g->last_vertex_x = g->path_start_vertex_x;
+    g->last_vertex_y = g->path_start_vertex_y;
+    g->spider_vx = 0; g->spider_vy = 0;
+    g->spider_state = SPIDER_IDLE_ON_CLAIMED;
+}
+// --- END: Movement and Path Logic Helper Functions ---
+
+void update_spider(Game* g) {
+    TRACE_ZONE_BEGIN(zone, "update_spider");
+    int current_grid_x = g->spider_x / CELL_PITCH;
+    int current_grid_y = g->spider_y / CELL_PITCH;
+
+    // Handle input intent if on a cross-section or 180-degree turn
+    if (g->input_vx_intent != 0 || g->input_vy_intent != 0) {
+        bool is_180_turn = (g->spider_vx == -g->input_vx_intent && g->input_vx_intent != 0) ||
+                           (g->spider_vy == -g->input_vy_intent && g->input_vy_intent != 0);
+
+        if (is_spider_on_cross_section(g) || is_180_turn) {
+            int intent_dir_x = (g->input_vx_intent > 0) ? 1 : ((g->input_vx_intent < 0) ? -1 : 0);
+            int intent_dir_y = (g->input_vy_intent > 0) ? 1 : ((g->input_vy_intent < 0) ? -1 : 0);
+
+            if (g->spider_state == SPIDER_IDLE_ON_CLAIMED || g->spider_state == SPIDER_MOVING_ON_CLAIMED) {
+                if (can_move_on_claimed_territory(g, current_grid_x, current_grid_y, intent_dir_x, intent_dir_y)) {
+                    g->spider_vx = g->input_vx_intent;
+                    g->spider_vy = g->input_vy_intent;
+                    g->spider_state = SPIDER_MOVING_ON_CLAIMED;
+                } else if (can_start_drawing_path(g, current_grid_x, current_grid_y, intent_dir_x, intent_dir_y)) {
+                    g->spider_vx = g->input_vx_intent;
+                    g->spider_vy = g->input_vy_intent;
+                    g->spider_state = SPIDER_DRAWING_PATH;
+                    g->path_start_vertex_x = current_grid_x;
+                    g->path_start_vertex_y = current_grid_y;
+                    clear_current_path_data(g);
+                    g->current_path_vertices[g->current_path_len++] = (Point){current_grid_x, current_grid_y};
+                } else { // Invalid move
+                    g->spider_vx = 0; g->spider_vy = 0; // Stop if previous move was valid but new one isn't
+                    if (g->spider_state == SPIDER_MOVING_ON_CLAIMED) g->spider_state = SPIDER_IDLE_ON_CLAIMED;
+                }
+            } else if (g->spider_state == SPIDER_DRAWING_PATH) {
+                // Allow direction change while drawing, unless it's into a wall not part of claim process
+                // For now, assume player manages not to hit walls directly unless completing path
+                g->spider_vx = g->input_vx_intent;
+                g->spider_vy = g->input_vy_intent;
+            }
+            g->input_vx_intent = 0; g->input_vy_intent = 0; // Consume intent
+        }
+    }
+
+    // Stop spider if no velocity (e.g. after failed move or at start)
+    if (g->spider_vx == 0 && g->spider_vy == 0 && g->spider_state == SPIDER_MOVING_ON_CLAIMED) {
+        g->spider_state = SPIDER_IDLE_ON_CLAIMED;
+    }
+
+
+    // Update spider position based on velocity
+    int new_x = g->spider_x + g->spider_vx;
+    int new_y = g->spider_y + g->spider_vy;
+
+    // Boundary checks
+    int spider_max_x = g->w * CELL_PITCH;
+    int spider_max_y = g->h * CELL_PITCH;
+    if (new_x > spider_max_x) new_x = spider_max_x;
+    if (new_x < 0) new_x = 0;
+    if (new_y > spider_max_y) new_y = spider_max_y;
+    if (new_y < 0) new_y = 0;
+
+    // If movement occurred
+    if (g->spider_x != new_x || g->spider_y != new_y) {
+         if (g->spider_state == SPIDER_IDLE_ON_CLAIMED && (g->spider_vx != 0 || g->spider_vy != 0) ) {
+            // This case should ideally be caught by input handling, if starting from idle.
+            // But if somehow missed, transition to moving.
+            g->spider_state = SPIDER_MOVING_ON_CLAIMED;
+        }
+    }
+    g->spider_x = new_x;
+    g->spider_y = new_y;
+
+
+    if (is_spider_on_cross_section(g)) {
+        int next_grid_x = g->spider_x / CELL_PITCH;
+        int next_grid_y = g->spider_y / CELL_PITCH;
+
+        if (g->last_vertex_x != next_grid_x || g->last_vertex_y != next_grid_y) { // Moved to a new vertex
+            if (g->spider_state == SPIDER_DRAWING_PATH) {
+                bool self_intersect = false;
+                // Add current vertex to path list and check for self-intersection
+                for(int i=0; i < g->current_path_len -1; ++i) { // -1 to not check against immediate predecessor
+                    if(g->current_path_vertices[i].x == next_grid_x && g->current_path_vertices[i].y == next_grid_y) {
+                        self_intersect = true;
+                        break;
+                    }
+                }
+                if (g->current_path_len < g->path_capacity) {
+                     g->current_path_vertices[g->current_path_len++] = (Point){next_grid_x, next_grid_y};
+                }
+
+
+                // Mark the edge in current path_h/path_v
+                // Edge from (last_vertex_x, last_vertex_y) to (next_grid_x, next_grid_y)
+                bool horizontal;
+                size_t e = edge_index(g, (Point){g->last_vertex_x, g->last_vertex_y},
+                                      (Point){next_grid_x, next_grid_y}, &horizontal);
+                if (horizontal) game_set_flag(g, g->path_h, GAME_HASH_PATH_H, e);
+                else game_set_flag(g, g->path_v, GAME_HASH_PATH_V, e);
+
+                bool returned_to_claimed = is_vertex_on_claimed_border(g, next_grid_x, next_grid_y);
+
+                if (self_intersect || returned_to_claimed) {
+                    attempt_claim_territory(g);
+                }
+            }
+            g->last_vertex_x = next_grid_x;
+            g->last_vertex_y = next_grid_y;
+        }
+    }
+    TRACE_ZONE_END(zone);
+}
+
+void game_tick(Game* g) {
+    update_spider(g);
+    if (g->tick % 2 == 0) snakes_step(g); // Snakes move at half the spider's rate
+    g->tick++;
+}
+
+void game_stop_spider(Game* g) {
+    g->spider_vx = 0; g->spider_vy = 0;
+    g->input_vx_intent = 0; g->input_vy_intent = 0;
+    if (g->spider_state == SPIDER_MOVING_ON_CLAIMED) g->spider_state = SPIDER_IDLE_ON_CLAIMED;
+    // Qix rules might mean death here; for now the path is just dropped
+    if (g->spider_state == SPIDER_DRAWING_PATH) return_to_path_start(g);
+}
+
+void game_spider_hit(Game* g) {
+    g->deaths++;
+    play_sound(SOUND_SPIDER_DIED);
+    if (g->spider_state == SPIDER_DRAWING_PATH) return_to_path_start(g);
+}
+
+// --- START: Instant Paths ---
+static const int dir_dx[4] = { 0, 1, 0, -1 };
+static const int dir_dy[4] = { -1, 0, 1, 0 };
+
+bool game_can_start_path(const Game* g, int vx, int vy, int dir) {
+    // As in update_spider, an edge the spider can walk along is never drawn
+    return is_vertex_on_claimed_border(g, vx, vy) &&
+           !can_move_on_claimed_territory(g, vx, vy, dir_dx[dir], dir_dy[dir]) &&
+           can_start_drawing_path(g, vx, vy, dir_dx[dir], dir_dy[dir]);
+}
+
+int game_play_path(Game* g, int vx, int vy, const uint8_t* dirs, int count) {
+    if (count < 1 || g->spider_state == SPIDER_DRAWING_PATH || !game_can_start_path(g, vx, vy, dirs[0])) return 0;
+    clear_current_path_data(g);
+    g->path_start_vertex_x = vx;
+    g->path_start_vertex_y = vy;
+    g->current_path_vertices[g->current_path_len++] = (Point){vx, vy};
+    g->spider_state = SPIDER_DRAWING_PATH;
+    g->spider_vx = 0; g->spider_vy = 0;
+
+    // From here on the same per-vertex rules as update_spider
+    for (int i = 0; i < count; i++) {
+        int nx = vx + dir_dx[dirs[i]], ny = vy + dir_dy[dirs[i]];
+        if (nx < 0 || nx > g->w || ny < 0 || ny > g->h) break;
+        bool self_intersect = false;
+        for (int k = 0; k < g->current_path_len - 1; k++) {
+            if (g->current_path_vertices[k].x == nx && g->current_path_vertices[k].y == ny) {
+                self_intersect = true;
+                break;
+            }
+        }
+        if (g->current_path_len < g->path_capacity) g->current_path_vertices[g->current_path_len++] = (Point){nx, ny};
+        bool horizontal;
+        size_t e = edge_index(g, (Point){vx, vy}, (Point){nx, ny}, &horizontal);
+        if (horizontal) game_set_flag(g, g->path_h, GAME_HASH_PATH_H, e);
+        else game_set_flag(g, g->path_v, GAME_HASH_PATH_V, e);
+
+        vx = nx; vy = ny;
+        g->spider_x = vx * CELL_PITCH;
+        g->spider_y = vy * CELL_PITCH;
+        g->last_vertex_x = vx;
+        g->last_vertex_y = vy;
+        if (self_intersect || is_vertex_on_claimed_border(g, vx, vy)) {
+            attempt_claim_territory(g);
+            return i + 1;
+        }
+    }
+    return_to_path_start(g); // Never got back: nothing claimed, nothing lost
+    return 0;
+}
+// --- END: Instant Paths ---
+
+// --- START: Territory Claiming Logic ---
+// The kernels take the board size as parameters; called with the GAME_DEFAULT_*
+// constants they are inlined with every index computation and bound folded.
+//
+// Regions are labels 1..CLAIM_MAX_REGIONS in region_labels (0 = not part of a
+// found region) plus a small Region summary each, so nothing per cell is copied.
+
+// Whether a cell of a prospective region touches earlier claims (by edge or corner)
+// or the outer border, which is claimed ground too
+GAME_KERNEL bool cell_touches_claimed(const Game* g, const int w, const int h, int x, int y) {
+    for (int dy_adj = -1; dy_adj <= 1; dy_adj++) {
+        for (int dx_adj = -1; dx_adj <= 1; dx_adj++) {
+            if (dx_adj == 0 && dy_adj == 0) continue;
+
+            int nx_adj = x + dx_adj;
+            int ny_adj = y + dy_adj;
+
+            if (nx_adj >= 0 && nx_adj < w && ny_adj >= 0 && ny_adj < h) {
+                if (g->claimed[ny_adj * w + nx_adj]) { // This cell was claimed in a *previous* operation
+                    return true;
+                }
+            }
+        }
+    }
+
+    // Counting the border only until the first claim let a later cut far from the
+    // claims leave its big side as the smallest eligible region
+    if (x == 0 && g->past_path_v[y * (w + 1)]) return true; // Left border
+    if (x == w - 1 && g->past_path_v[y * (w + 1) + w]) return true; // Right border
+    if (y == 0 && g->past_path_h[x]) return true; // Top border
+    if (y == h - 1 && g->past_path_h[h * w + x]) return true; // Bottom border
+    return false;
+}
+
+// Breadth-first fill from (start_x, start_y), writing `label` into the label map and
+// summarizing the region as it goes
+GAME_KERNEL void flood_fill_region(Game* g, const int w, const int h, int start_x, int start_y,
+                                   uint8_t label, Region* region) {
+    uint8_t* labels = g->region_labels;
+    uint32_t* queue = g->fill_queue;
+    int head = 0, tail = 0;
+
+    region->count = 0;
+    region->min_x = region->max_x = start_x;
+    region->min_y = region->max_y = start_y;
+    region->is_adjacent_to_claimed_territory = false;
+
+    queue[tail++] = (uint32_t)(start_y * w + start_x);
+    labels[start_y * w + start_x] = label;
+
+    while (head < tail) {
+        int cell = (int)queue[head++];
+        int x = cell % w, y = cell / w;
+        region->count++;
+        if (x < region->min_x) region->min_x = x;
+        if (x > region->max_x) region->max_x = x;
+        if (y < region->min_y) region->min_y = y;
+        if (y > region->max_y) region->max_y = y;
+        if (!region->is_adjacent_to_claimed_territory) {
+            region->is_adjacent_to_claimed_territory =
+                cell_touches_claimed(g, w, h, x, y);
+        }
+
+        // Down, up, right, left; a neighbour is entered if free, unlabelled and not behind a path line
+        if (y + 1 < h && !g->claimed[cell + w] && !labels[cell + w] &&
+            !(g->path_h[cell + w] | g->past_path_h[cell + w])) {
+            labels[cell + w] = label;
+            queue[tail++] = (uint32_t)(cell + w);
+        }
+        if (y > 0 && !g->claimed[cell - w] && !labels[cell - w] &&
+            !(g->path_h[cell] | g->past_path_h[cell])) {
+            labels[cell - w] = label;
+            queue[tail++] = (uint32_t)(cell - w);
+        }
+        int v = y * (w + 1) + x; // Vertical edge left of the cell
+        if (x + 1 < w && !g->claimed[cell + 1] && !labels[cell + 1] &&
+            !(g->path_v[v + 1] | g->past_path_v[v + 1])) {
+            labels[cell + 1] = label;
+            queue[tail++] = (uint32_t)(cell + 1);
+        }
+        if (x > 0 && !g->claimed[cell - 1] && !labels[cell - 1] &&
+            !(g->path_v[v] | g->past_path_v[v])) {
+            labels[cell - 1] = label;
+            queue[tail++] = (uint32_t)(cell - 1);
+        }
+    }
+}
+
+// Labels the free regions and returns the label of the smallest one touching claimed
+// territory, 0 if there is none
+GAME_KERNEL int find_region_to_claim(Game* g, const int w, const int h, Region* found_regions) {
+    int found_region_count = 0;
+    memset(g->region_labels, 0, (size_t)w * (size_t)h);
+
+    for (int y = 0; y < h && found_region_count < CLAIM_MAX_REGIONS; y++) {
+        for (int x = 0; x < w && found_region_count < CLAIM_MAX_REGIONS; x++) {
+            if (!g->claimed[y * w + x] && !g->region_labels[y * w + x]) {
+                Region* r = &found_regions[found_region_count++];
+                flood_fill_region(g, w, h, x, y, (uint8_t)found_region_count, r);
+            }
+        }
+    }
+
+    int best_label = 0;
+    int min_size = g->total_cells + 1;
+
+    for (int i = 0; i < found_region_count; i++) {
+        if (found_regions[i].is_adjacent_to_claimed_territory) {
+            if (found_regions[i].count < min_size) {
+                min_size = found_regions[i].count;
+                best_label = i + 1;
+            }
+        }
+    }
+    return best_label;
+}
+
+// Claims every cell labelled `label`; one pass over the region's bounding box
+GAME_KERNEL void claim_region(Game* g, const int w, const Region* region, int label) {
+    uint64_t hash = g->hash;
+    for (int y = region->min_y; y <= region->max_y; y++) {
+        const uint8_t* labels = g->region_labels + y * w;
+        uint8_t* claimed = g->claimed + y * w;
+        for (int x = region->min_x; x <= region->max_x; x++) {
+            if (labels[x] == label) { // Labelled cells are never claimed yet
+                claimed[x] = 1;
+                hash ^= game_hash_key(GAME_HASH_CLAIMED, (size_t)(y * w + x));
+            }
+        }
+    }
+    g->hash = hash;
+    g->claimed_cell_count += region->count;
+    TRACE_COUNT(TRACE_COUNTER_CELLS_FILLED, region->count);
+}
+
+void attempt_claim_territory(Game* g) {
+    TRACE_ZONE_BEGIN(zone, "attempt_claim_territory");
+    uint64_t claim_start = game_claim_clock ? game_claim_clock() : 0;
+    Region found_regions[CLAIM_MAX_REGIONS];
+    int label;
+    if (g->w == GAME_DEFAULT_W && g->h == GAME_DEFAULT_H) {
+        label = find_region_to_claim(g, GAME_DEFAULT_W, GAME_DEFAULT_H, found_regions);
+        if (label) claim_region(g, GAME_DEFAULT_W, &found_regions[label - 1], label);
+    } else {
+        label = find_region_to_claim(g, g->w, g->h, found_regions);
+        if (label) claim_region(g, g->w, &found_regions[label - 1], label);
+    }
+
+    g->claims++;
+    if (label) {
+        snakes_kill_in_region(g, &found_regions[label - 1], label);
+        // Merge current path into past_path
+        size_t edges_h = (size_t)g->w * (size_t)(g->h + 1);
+        size_t edges_v = (size_t)(g->w + 1) * (size_t)g->h;
+        for (size_t i = 0; i < edges_h; i++) {
+            if (g->path_h[i]) game_set_flag(g, g->past_path_h, GAME_HASH_PAST_PATH_H, i);
+        }
+        for (size_t i = 0; i < edges_v; i++) {
+            if (g->path_v[i]) game_set_flag(g, g->past_path_v, GAME_HASH_PAST_PATH_V, i);
+        }
+        clear_current_path_data(g);
+        g->spider_state = SPIDER_IDLE_ON_CLAIMED; // Or MOVING if auto-move along new border
+        g->spider_vx = 0; g->spider_vy = 0; // Stop for now
+        play_sound(SOUND_CLAIM);
+    } else {
+        // No valid region claimed, reset path
+        g->failed_claims++;
+        play_sound(SOUND_SPIDER_HIT);
+        return_to_path_start(g);
+    }
+    if (game_claim_clock) game_claim_ns += game_claim_clock() - claim_start;
+    TRACE_ZONE_END(zone);
+}
+// --- END: Territory Claiming Logic ---
+
+
+void initialize_game_state(Game* g) {
+    memset(g->claimed, 0, (size_t)g->w * (size_t)g->h);
+    memset(g->past_path_h, 0, (size_t)g->w * (size_t)(g->h + 1));
+    memset(g->past_path_v, 0, (size_t)(g->w + 1) * (size_t)g->h);
+    clear_current_path_data(g); // Clears path_h, path_v, current_path_len
+    memset(g->snake_cells, 0, (size_t)g->w * (size_t)g->h);
+    g->hash = 0; // Every plane is empty
+
+    // Set up initial border as past_path
+    for (int x = 0; x < g->w; x++) {
+        game_set_flag(g, g->past_path_h, GAME_HASH_PAST_PATH_H, (size_t)x);                      // Top border
+        game_set_flag(g, g->past_path_h, GAME_HASH_PAST_PATH_H, (size_t)g->h * (size_t)g->w + x); // Bottom border
+    }
+    for (int y = 0; y < g->h; y++) {
+        game_set_flag(g, g->past_path_v, GAME_HASH_PAST_PATH_V, (size_t)y * (size_t)(g->w + 1));          // Left border
+        game_set_flag(g, g->past_path_v, GAME_HASH_PAST_PATH_V, (size_t)y * (size_t)(g->w + 1) + g->w);   // Right border
+    }
+
+    g->spider_x = 0; // Top-left vertex in pixels
+    g->spider_y = 0;
+    g->spider_vx = 0;
+    g->spider_vy = 0;
+    g->input_vx_intent = 0;
+    g->input_vy_intent = 0;
+
+    g->last_vertex_x = 0; // Grid coordinates
+    g->last_vertex_y = 0;
+
+    g->spider_state = SPIDER_IDLE_ON_CLAIMED;
+    g->claimed_cell_count = 0;
+    // path_start_vertex will be set when drawing starts
+
+    g->snake_count = 0; // snakes_spawn adds them
+    g->tick = 0;
+    g->deaths = 0;
+    g->claims = 0;
+    g->failed_claims = 0;
+    g->snakes_killed = 0;
+}
@@ -0,0 +1,231 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "audio_mixer.h"
+
+// Board state and rules of the remake, with no window or drawing code, so the
+// same logic runs in mamba.exe, the benchmarks and headless tools.
+//
+// The board size is chosen at game_init (up to GAME_MAX_CELLS a side) and all
+// per-cell state lives in one heap block sized for it. The standard 35x29 board
+// goes through kernels specialized on constant dimensions (see game.c).
+
+// Board geometry
+#define GAME_DEFAULT_W 35 // 0x25 in the original
+#define GAME_DEFAULT_H 29 // 0x1D
+#define GAME_MIN_CELLS 2
+#define GAME_MAX_CELLS 1024
+#define EDGE_SIZE 1
+#define CELL_SIZE 11
+#define CELL_PITCH (CELL_SIZE + EDGE_SIZE)
+#define SNAKE_LENGTH 13  // Segments per snake record (0xd in FUN_1038_0ffc)
+#define GAME_WIN_PERCENT 75 // Level won at this share of the board (0x4b in FUN_1038_02d2)
+
+// --- START: Core Data Structures ---
+typedef struct { int x, y; } Point;
+
+// Summary of one region found by attempt_claim_territory; its cells are the ones
+// carrying its label in Game.region_labels
+typedef struct {
+    int count;
+    int min_x, min_y, max_x, max_y; // Bounding box, inclusive
+    bool is_adjacent_to_claimed_territory;
+} Region;
+
+// Snake directions, numbered as in the original's segment records
+typedef enum {
+    SNAKE_UP,
+    SNAKE_RIGHT,
+    SNAKE_DOWN,
+    SNAKE_LEFT
+} SnakeDir;
+
+typedef struct {
+    int16_t x, y;  // Cell coordinates
+    uint8_t dir;   // SnakeDir the segment was entered in
+} SnakeSegment;
+
+// One snake record (0x2d bytes at 0x17e2 in the original): a ring of segments from
+// tail to head that grows by one per step until SNAKE_LENGTH long
+typedef struct {
+    uint8_t grown;      // Segments laid, up to SNAKE_LENGTH
+    uint8_t head, tail; // Ring indices into segments
+    bool alive;
+    SnakeSegment segments[SNAKE_LENGTH];
+} Snake;
+// --- END: Core Data Structures ---
+
+// Spider state
+typedef enum {
+    SPIDER_IDLE_ON_CLAIMED,
+    SPIDER_MOVING_ON_CLAIMED,
+    SPIDER_DRAWING_PATH
+} SpiderState;
+
+typedef struct {
+    int w, h; // Cells
+
+    // Row-major flags, one byte each
+    uint8_t* claimed;     // w * h,       index y * w + x
+    uint8_t* past_path_h; // w * (h + 1), index y * w + x
+    uint8_t* past_path_v; // (w + 1) * h, index y * (w + 1) + x
+    uint8_t* path_h;      // Current path, same layout as past_path_h
+    uint8_t* path_v;      // Current path, same layout as past_path_v
+
+    int spider_x, spider_y; // Pixel coordinates
+    int spider_vx, spider_vy; // Pixel velocity
+    int last_vertex_x, last_vertex_y; // Grid coordinates
+    int input_vx_intent, input_vy_intent; // Queued pixel velocity intent
+    SpiderState spider_state;
+
+    // Path drawing state
+    int path_start_vertex_x, path_start_vertex_y; // Grid coords where current path started
+    Point* current_path_vertices; // Up to path_capacity vertices
+    int current_path_len;
+    int path_capacity;
+
+    // Snakes, see snake.h
+    Snake* snakes;          // snake_capacity records
+    uint8_t* snake_cells;   // w * h, number of snake segments on each cell
+    int snake_count;        // Records in use, alive or not
+    int snake_capacity;
+
+    // Game progression
+    int total_cells;
+    int claimed_cell_count;
+    int level;              // 1..10, scales how hard snakes chase the spider
+    uint32_t tick;          // game_tick calls since initialize_game_state
+    uint32_t rng;           // State of game_random, so every game has its own sequence
+    int deaths;             // Spider hits by snakes
+    int claims;             // Successful and failed attempt_claim_territory calls
+    int failed_claims;
+    int snakes_killed;
+    uint64_t hash;          // Zobrist hash of the planes and snake_cells, see game_hash
+
+    // Scratch for attempt_claim_territory, not part of the game state
+    uint8_t* region_labels; // w * h, region label per cell
+    uint32_t* fill_queue;   // w * h cell indices, flood fill queue
+
+    // Scratch for snakes_step: the cells whose outline the drawing spider is on,
+    // one bit per cell, so a snake head's hit test is one bit test
+    uint64_t* danger_bits;  // (w * h + 63) / 64 words, bit y * w + x
+    uint32_t* danger_cells; // [0] = how many bits are set, [1..4] = their cells
+
+    void* block;          // All arrays above, state first, then scratch
+    size_t state_size;    // Bytes of the block that hold game state
+    size_t block_size;
+    bool owns_block;      // Allocated by game_init rather than passed to game_init_in
+} Game;
+
+#define GAME_CLAIMED(g, x, y) ((g)->claimed[(y) * (g)->w + (x)])
+#define GAME_SNAKE_CELL(g, x, y) ((g)->snake_cells[(y) * (g)->w + (x)])
+#define GAME_DANGER(g, cell) ((g)->danger_bits[(cell) >> 6] >> ((cell) & 63) & 1)
+#define GAME_PAST_PATH_H(g, x, y) ((g)->past_path_h[(y) * (g)->w + (x)])
+#define GAME_PAST_PATH_V(g, x, y) ((g)->past_path_v[(y) * ((g)->w + 1) + (x)])
+#define GAME_PATH_H(g, x, y) ((g)->path_h[(y) * (g)->w + (x)])
+#define GAME_PATH_V(g, x, y) ((g)->path_v[(y) * ((g)->w + 1) + (x)])
+
+// --- START: Zobrist Hashing ---
+// Game.hash is the XOR of one 64-bit key per set flag of the planes above and per
+// non-zero snake_cells count. Everything in game.c and snake.c that changes them
+// goes through these helpers, so it stays current for a few instructions per edge
+// drawn, cell claimed or snake step, and two boards compare by one word. Keys are
+// a fixed function of plane and index: equal on every run and every machine.
+typedef enum {
+    GAME_HASH_CLAIMED,
+    GAME_HASH_PAST_PATH_H,
+    GAME_HASH_PAST_PATH_V,
+    GAME_HASH_PATH_H,
+    GAME_HASH_PATH_V,
+    GAME_HASH_SNAKE_CELL  // Index is cell << 8 | count
+} GameHashPlane;
+
+static inline uint64_t game_hash_key(int plane, size_t index) {
+    // splitmix64 finalizer over plane and index
+    uint64_t z = ((uint64_t)plane << 56 ^ (uint64_t)index) + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Sets flags[index], a flag of plane `plane` of g
+static inline void game_set_flag(Game* g, uint8_t* flags, int plane, size_t index) {
+    if (!flags[index]) {
+        flags[index] = 1;
+        g->hash ^= game_hash_key(plane, index);
+    }
+}
+
+// Adds delta segments to snake_cells at (x, y)
+static inline void game_add_snake_cell(Game* g, int x, int y, int delta) {
+    size_t cell = (size_t)y * (size_t)g->w + (size_t)x;
+    int count = g->snake_cells[cell];
+    if (count) g->hash ^= game_hash_key(GAME_HASH_SNAKE_CELL, cell << 8 | (size_t)count);
+    count += delta;
+    g->snake_cells[cell] = (uint8_t)count;
+    if (count) g->hash ^= game_hash_key(GAME_HASH_SNAKE_CELL, cell << 8 | (size_t)count);
+}
+// --- END: Zobrist Hashing ---
+
+// Called for every sound effect the rules trigger; NULL keeps the game silent
+extern void (*game_sound_handler)(SoundId id);
+// Clock for timing claims (platform_time_ns), NULL to skip it; each claim adds its
+// time to game_claim_ns. Like game_sound_handler, for the window only.
+extern uint64_t (*game_claim_clock)(void);
+extern uint64_t game_claim_ns;
+
+// Allocates a w x h board (clamped to GAME_MIN_CELLS..GAME_MAX_CELLS) with room for
+// max_snakes snakes and resets it.
+bool game_init(Game* g, int w, int h, int max_snakes);
+// Same, in caller memory of game_block_size bytes, 16-byte aligned, which game_free
+// leaves alone; lets many games share one allocation at a fixed stride.
+size_t game_block_size(int w, int h, int max_snakes);
+bool game_init_in(Game* g, int w, int h, int max_snakes, void* block);
+void game_free(Game* g);
+// Copies the game state between two boards of the same size.
+void game_copy(Game* dst, const Game* src);
+// The whole state as one flat buffer of game_state_bytes: the Game fields, then
+// the state part of the block. Loading needs a board of the same size; its own
+// block stays in place.
+size_t game_state_bytes(const Game* g);
+void game_save_state(const Game* g, void* out);
+void game_load_state(Game* g, const void* in);
+// claimed, past_path_h and past_path_v lie back to back from g->claimed; the
+// bytes they span, for copying a board's walls in one go (level.h)
+size_t game_wall_planes_bytes(const Game* g);
+
+// Seeds game_random; games never share random state, so they can run on any thread.
+void game_seed(Game* g, uint64_t seed);
+// 0..0x7fff, like the C library rand() the original used
+int game_random(Game* g);
+
+void initialize_game_state(Game* g);
+// One timer tick: moves the spider and, every other tick, the snakes (FUN_1038_02d2)
+void game_tick(Game* g);
+// Whether a path may start at vertex (vx, vy) in SnakeDir dir: the vertex is on
+// claimed ground and the edge runs into free area
+bool game_can_start_path(const Game* g, int vx, int vy, int dir);
+// Draws a whole path at once from vertex (vx, vy), one SnakeDir per edge, with the
+// rules update_spider applies at vertices; stops where the path closes and claims.
+// Returns the edges used, 0 if it could not start or never closed (then undone).
+int game_play_path(Game* g, int vx, int vy, const uint8_t* dirs, int count);
+
+// Space bar: stop, and give up the path being drawn
+void game_stop_spider(Game* g);
+// Spider caught by a snake (FUN_1038_399a): the current path is lost
+void game_spider_hit(Game* g);
+bool game_is_won(const Game* g);
+// Game.hash mixed with the spider, snake records, random state and tick: equal for
+// two games exactly when (barring collisions) every later tick will be too
+uint64_t game_hash(const Game* g);
+// Game.hash from scratch, to check it, or to refresh it after writing planes directly
+uint64_t game_hash_recompute(const Game* g);
+void update_spider(Game* g);
+void attempt_claim_territory(Game* g);
+void clear_current_path_data(Game* g);
+bool is_spider_on_cross_section(const Game* g);
+
+#endif // GAME_H
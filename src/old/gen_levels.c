@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "level_gen.h"
+#include "platform.h"
+
+// Generates wall layouts and keeps those the bot finds as hard as asked.
+//
+//     gen_levels [--count n] [--first n] [--seed n] [--candidates n] [--games n] [--threads n]
+//                [--snakes n] [--level n] [--win min-max] [--wall-percent n] [--board WxH]
+//                [--out file]
+//
+// Tries the layouts of seeds --seed, --seed + 1, ... until --count of them fall in
+// the --win band (percent of bot games won) or --candidates have been tried, and
+// writes the kept ones as levels --first, --first + 1, ... in the level file format
+// (to stdout without --out). Every candidate's stats go to stderr. --snakes and
+// --level set the test games' snake count and speed.
+
+int main(int argc, char** argv) {
+    LevelGenConfig config;
+    level_gen_default_config(&config);
+    int count = 1;
+    int first = 4; // After the original's three
+    int candidates = 100;
+    uint64_t seed = 1;
+    const char* out_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) count = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--first") == 0 && i + 1 < argc) first = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--candidates") == 0 && i + 1 < argc) candidates = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) config.games = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) config.threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--snakes") == 0 && i + 1 < argc) config.play.snakes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) config.play.level = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--wall-percent") == 0 && i + 1 < argc) config.max_wall_percent = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) out_path = argv[++i];
+        else if (strcmp(argv[i], "--win") == 0 && i + 1 < argc &&
+                 sscanf(argv[++i], "%d-%d", &config.min_win_percent, &config.max_win_percent) == 2) {}
+        else if (strcmp(argv[i], "--board") == 0 && i + 1 < argc &&
+                 sscanf(argv[++i], "%dx%d", &config.board_w, &config.board_h) == 2) {}
+        else {
+            fprintf(stderr, "usage: %s [--count n] [--first n] [--seed n] [--candidates n] [--games n] [--threads n]\n"
+                            "       [--snakes n] [--level n] [--win min-max] [--wall-percent n] [--board WxH]\n"
+                            "       [--out file]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (count < 1) count = 1;
+    if (candidates < 1) candidates = 1;
+    if (config.games < 1) config.games = 1;
+    if (first < 1) first = 1;
+    if (first + count - 1 > LEVEL_MAX_NUMBER) count = LEVEL_MAX_NUMBER - first + 1;
+    if (config.play.level < 1) config.play.level = 1;
+    if (config.play.level > 10) config.play.level = 10;
+    if (config.play.snakes < 0) config.play.snakes = 0;
+    if (config.board_w < GAME_MIN_CELLS || config.board_w > GAME_MAX_CELLS ||
+        config.board_h < GAME_MIN_CELLS || config.board_h > GAME_MAX_CELLS) {
+        fprintf(stderr, "Board size out of range\n");
+        return 1;
+    }
+
+    FILE* out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Cannot write %s\n", out_path);
+        return 1;
+    }
+
+    int kept = 0;
+    double seconds = 0.0;
+    fprintf(stderr, "%-20s %6s %6s %6s %8s %7s %8s\n", "seed", "boxes", "walls", "won", "claimed", "deaths", "seconds");
+    for (int i = 0; i < candidates && kept < count; i++) {
+        LevelCandidate c;
+        if (!level_gen_candidate(&config, seed + (uint64_t)i, &c)) {
+            fprintf(stderr, "Out of memory for a %dx%d board\n", config.board_w, config.board_h);
+            if (out_path) fclose(out);
+            return 1;
+        }
+        seconds += c.seconds;
+        fprintf(stderr, "%-20llu %6d %5.1f%% %5.1f%% %7.1f%% %7.2f %8.3f%s\n", (unsigned long long)c.seed,
+                c.def.box_count, c.wall_percent, c.win_percent, c.claimed_percent, c.deaths, c.seconds,
+                c.accepted ? "  kept" : "");
+        if (!c.accepted) continue;
+
+        c.def.number = first + kept++;
+        fprintf(out, "%s# seed %llu: the bot won %.1f%% of %d games (%d snakes, level %d)\n", kept > 1 ? "\n" : "",
+                (unsigned long long)c.seed, c.win_percent, config.games, config.play.snakes, config.play.level);
+        level_write(out, &c.def);
+    }
+    fprintf(stderr, "kept %d of %d wanted, %.3f s of play\n", kept, count, seconds);
+
+    if (out_path && fclose(out) != 0) {
+        fprintf(stderr, "Cannot write %s\n", out_path);
+        return 1;
+    }
+    return kept == count ? 0 : 2;
+}
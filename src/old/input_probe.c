@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "game.h"
+#include "input_queue.h"
+#include "input_thread.h"
+#include "platform.h"
+
+// Plays a headless game from the real keyboard and reports input-to-motion
+// latency: the time from a key going down to the end of the tick in which the
+// spider first moved the new way. Keys come from an InputThread, ticks run on
+// the main thread at mamba.exe's timer rate, as they would in a front-end.
+//
+//     input_probe [--seconds n] [--tick-ms n] [--device /dev/input/eventN] [--board WxH]
+//
+// Steer with the arrows, stop with Space. Needs no window, so on Linux it runs
+// from a console (with read access to the evdev devices).
+
+static void print_latency(const InputLatency* l, int dropped) {
+    printf("turns %u  mean %.1f ms  p50 %.0f ms  p99 %.0f ms  max %.1f ms  dropped %d\n",
+           l->count, l->count ? (double)l->total_ns / l->count * 1e-6 : 0.0,
+           input_latency_percentile_ms(l, 0.5), input_latency_percentile_ms(l, 0.99),
+           (double)l->max_ns * 1e-6, dropped);
+}
+
+int main(int argc, char** argv) {
+    int seconds = 30;
+    int tick_ms = 32; // mamba.exe's SetTimer period
+    int board_w = GAME_DEFAULT_W, board_h = GAME_DEFAULT_H;
+    const char* device = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--tick-ms") == 0 && i + 1 < argc) tick_ms = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--device") == 0 && i + 1 < argc) device = argv[++i];
+        else if (strcmp(argv[i], "--board") == 0 && i + 1 < argc &&
+                 sscanf(argv[++i], "%dx%d", &board_w, &board_h) == 2) {}
+        else {
+            fprintf(stderr, "usage: input_probe [--seconds n] [--tick-ms n] [--device path] [--board WxH]\n");
+            return 1;
+        }
+    }
+    if (tick_ms < 1) tick_ms = 1;
+
+    Game game;
+    if (!game_init(&game, board_w, board_h, 0)) {
+        fprintf(stderr, "Out of memory for the board\n");
+        return 1;
+    }
+    initialize_game_state(&game);
+
+    static InputQueue queue;
+    input_queue_init(&queue);
+    InputThread input;
+    if (!input_thread_start(&input, &queue, NULL, device)) {
+        fprintf(stderr, "Cannot read the keyboard%s%s\n", device ? " at " : "", device ? device : "");
+        game_free(&game);
+        return 1;
+    }
+    printf("Steer with the arrows for %d s\n", seconds);
+
+    // Ticks on a fixed schedule, so a late tick is followed by a short wait, not a drift
+    uint64_t tick_ns = (uint64_t)tick_ms * 1000000ull;
+    uint64_t start = platform_time_ns();
+    uint64_t next_tick = start;
+    uint64_t next_report = start + 1000000000ull;
+    uint32_t reported = 0;
+    while (platform_time_ns() - start < (uint64_t)seconds * 1000000000ull) {
+        input_queue_feed(&queue, &game);
+        game_tick(&game);
+        input_queue_after_tick(&queue, &game);
+
+        uint64_t now = platform_time_ns();
+        if (now >= next_report) {
+            if (queue.latency.count != reported) print_latency(&queue.latency, queue.dropped);
+            reported = queue.latency.count;
+            next_report += 1000000000ull;
+        }
+        next_tick += tick_ns;
+        if (next_tick > now) platform_sleep_ms((int)((next_tick - now) / 1000000ull));
+    }
+
+    input_thread_stop(&input);
+    print_latency(&queue.latency, queue.dropped);
+    game_free(&game);
+    return 0;
+}
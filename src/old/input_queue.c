@@ -0,0 +1,88 @@
+#include "input_queue.h"
+
+#include <string.h>
+#include "platform.h"
+
+void input_queue_init(InputQueue* q) {
+    memset(q, 0, sizeof(InputQueue));
+}
+
+// --- START: Producer ---
+bool input_queue_push(InputQueue* q, InputEvent e) {
+    unsigned write = q->write; // Only this thread writes it
+    unsigned read = platform_atomic_load(&q->read);
+    if (write - read >= INPUT_QUEUE_SIZE) {
+        q->dropped++;
+        return false;
+    }
+    q->events[write & (INPUT_QUEUE_SIZE - 1)] = e;
+    platform_atomic_store(&q->write, write + 1);
+    return true;
+}
+
+bool input_queue_push_direction(InputQueue* q, int dx, int dy) {
+    InputEvent e = { platform_time_ns(), INPUT_DIRECTION, (int8_t)dx, (int8_t)dy };
+    return input_queue_push(q, e);
+}
+
+bool input_queue_push_stop(InputQueue* q) {
+    InputEvent e = { platform_time_ns(), INPUT_STOP, 0, 0 };
+    return input_queue_push(q, e);
+}
+// --- END: Producer ---
+
+// --- START: Consumer ---
+bool input_queue_pop(InputQueue* q, InputEvent* out) {
+    unsigned read = q->read; // Only this thread writes it
+    if (read == platform_atomic_load(&q->write)) return false;
+    *out = q->events[read & (INPUT_QUEUE_SIZE - 1)];
+    platform_atomic_store(&q->read, read + 1);
+    return true;
+}
+
+int input_queue_feed(InputQueue* q, Game* g) {
+    int taken = 0;
+    InputEvent e;
+    while (g->input_vx_intent == 0 && g->input_vy_intent == 0 && input_queue_pop(q, &e)) {
+        taken++;
+        if (e.type == INPUT_STOP) {
+            game_stop_spider(g);
+            q->pending.time_ns = 0;
+            continue;
+        }
+        // Pressing the way the spider already goes would hold up the turn behind it
+        if (e.dx == g->spider_vx && e.dy == g->spider_vy) continue;
+        g->input_vx_intent = e.dx;
+        g->input_vy_intent = e.dy;
+        q->pending = e;
+    }
+    return taken;
+}
+
+void input_queue_after_tick(InputQueue* q, const Game* g) {
+    if (q->pending.time_ns == 0 || g->input_vx_intent != 0 || g->input_vy_intent != 0) return;
+    // The intent was used up this tick; it took if the spider now goes that way
+    if (g->spider_vx == q->pending.dx && g->spider_vy == q->pending.dy) {
+        uint64_t ns = platform_time_ns() - q->pending.time_ns;
+        uint64_t ms = ns / 1000000;
+        InputLatency* l = &q->latency;
+        l->count++;
+        l->total_ns += ns;
+        if (ns > l->max_ns) l->max_ns = ns;
+        l->histogram[ms < INPUT_LATENCY_BUCKETS ? ms : INPUT_LATENCY_BUCKETS - 1]++;
+    }
+    q->pending.time_ns = 0;
+}
+
+double input_latency_percentile_ms(const InputLatency* l, double fraction) {
+    if (l->count == 0) return 0.0;
+    uint64_t target = (uint64_t)(fraction * l->count + 0.5);
+    if (target < 1) target = 1;
+    uint64_t seen = 0;
+    for (int ms = 0; ms < INPUT_LATENCY_BUCKETS - 1; ms++) {
+        seen += l->histogram[ms];
+        if (seen >= target) return ms + 1.0; // Upper edge of the bucket
+    }
+    return (double)l->max_ns * 1e-6;
+}
+// --- END: Consumer ---
@@ -0,0 +1,74 @@
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+
+// Buffered player input, replacing FUN_1038_2e86's key buffer.
+//
+// The original kept pressed directions in parallel arrays (0x18c8/0x17d4) and
+// shifted the rest down on every dequeue; the remake had only the one intent slot
+// in Game, so a second turn pressed before the spider reached a cross-section
+// overwrote the first. Now the window (or input) thread pushes every press into a
+// single-producer/single-consumer ring and the tick takes them out one at a time,
+// each only once the previous intent has been used up. Neither side locks or
+// copies more than one event.
+
+#define INPUT_QUEUE_SIZE 256 // Power of two
+#define INPUT_LATENCY_BUCKETS 1024 // 1 ms each; the last also counts everything slower
+
+typedef enum {
+    INPUT_DIRECTION, // dx/dy as in Game.input_vx_intent/input_vy_intent
+    INPUT_STOP       // game_stop_spider
+} InputEventType;
+
+typedef struct {
+    uint64_t time_ns; // platform_time_ns when the key went down
+    uint8_t type;
+    int8_t dx, dy;
+} InputEvent;
+
+// Input-to-motion latency of turns: from the key going down to the end of the
+// tick in which the spider first moved the new way. Includes the wait for a
+// cross-section, which is the game's rule and not input lag.
+typedef struct {
+    uint32_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint32_t histogram[INPUT_LATENCY_BUCKETS];
+} InputLatency;
+
+typedef struct {
+    InputEvent events[INPUT_QUEUE_SIZE];
+    unsigned read;  // Owned by the consumer; atomic
+    unsigned write; // Owned by the producer; atomic
+    int dropped;    // Queue-full drops, for diagnostics
+
+    // Consumer side only
+    InputEvent pending;      // Turn in Game's intent slot; time_ns 0 = none
+    InputLatency latency;
+} InputQueue;
+
+void input_queue_init(InputQueue* q);
+
+// Producer side. False (and counted in dropped) if the queue is full.
+bool input_queue_push(InputQueue* q, InputEvent e);
+// Stamps the event with the current time
+bool input_queue_push_direction(InputQueue* q, int dx, int dy);
+bool input_queue_push_stop(InputQueue* q);
+
+// Consumer side. False if empty.
+bool input_queue_pop(InputQueue* q, InputEvent* out);
+// Call before game_tick: while g has no pending intent, applies queued events in
+// order, skipping turns that would change nothing. A stop is applied at once and
+// the next event follows it in the same tick. Returns the events taken.
+int input_queue_feed(InputQueue* q, Game* g);
+// Call after game_tick: records the latency of the turn fed before it once the
+// spider takes it, or forgets it if the game refused it.
+void input_queue_after_tick(InputQueue* q, const Game* g);
+
+// Latency below which `fraction` (0..1) of the recorded turns fell, in ms
+double input_latency_percentile_ms(const InputLatency* l, double fraction);
+
+#endif // INPUT_QUEUE_H
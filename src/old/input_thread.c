@@ -0,0 +1,198 @@
+#include "input_thread.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// Direction of an arrow key, or a stop for Space
+static void push_key(InputThread* t, int dx, int dy, bool stop, uint64_t time_ns) {
+    InputEvent e = { time_ns, (uint8_t)(stop ? INPUT_STOP : INPUT_DIRECTION), (int8_t)dx, (int8_t)dy };
+    input_queue_push(t->queue, e);
+}
+
+#ifdef _WIN32
+
+// --- START: Raw input ---
+static LRESULT CALLBACK raw_input_proc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    if (msg == WM_INPUT) {
+        uint64_t now = platform_time_ns();
+        InputThread* t = (InputThread*)GetWindowLongPtr(hwnd, GWLP_USERDATA);
+        RAWINPUT raw;
+        UINT size = sizeof(raw);
+        if (t && GetRawInputData((HRAWINPUT)lParam, RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER)) != (UINT)-1 &&
+            raw.header.dwType == RIM_TYPEKEYBOARD && !(raw.data.keyboard.Flags & RI_KEY_BREAK) &&
+            (!t->focus_window || GetForegroundWindow() == (HWND)t->focus_window)) {
+            // Key repeats arrive as further make codes, as WM_KEYDOWN repeats did
+            switch (raw.data.keyboard.VKey) {
+                case VK_LEFT:  push_key(t, -1, 0, false, now); break;
+                case VK_RIGHT: push_key(t, 1, 0, false, now); break;
+                case VK_UP:    push_key(t, 0, -1, false, now); break;
+                case VK_DOWN:  push_key(t, 0, 1, false, now); break;
+                case VK_SPACE: push_key(t, 0, 0, true, now); break;
+            }
+        }
+    } else if (msg == WM_DESTROY) {
+        PostQuitMessage(0);
+        return 0;
+    }
+    return DefWindowProc(hwnd, msg, wParam, lParam);
+}
+
+static void input_thread_main(void* arg) {
+    InputThread* t = (InputThread*)arg;
+    WNDCLASS wc = {0};
+    wc.lpfnWndProc = raw_input_proc;
+    wc.hInstance = GetModuleHandle(NULL);
+    wc.lpszClassName = "MambaRawInput";
+    RegisterClass(&wc);
+    HWND hwnd = CreateWindow("MambaRawInput", NULL, 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, wc.hInstance, NULL);
+    if (!hwnd) {
+        platform_atomic_store(&t->ready, -1);
+        return;
+    }
+    SetWindowLongPtr(hwnd, GWLP_USERDATA, (LONG_PTR)t);
+
+    // A message-only window is never in front, so it has to sink input; focus_window filters it
+    RAWINPUTDEVICE device = { 0x01, 0x06, RIDEV_INPUTSINK, hwnd }; // Generic desktop, keyboard
+    if (!RegisterRawInputDevices(&device, 1, sizeof(device))) {
+        DestroyWindow(hwnd);
+        platform_atomic_store(&t->ready, -1);
+        return;
+    }
+    t->message_window = hwnd;
+    platform_atomic_store(&t->ready, 1);
+
+    MSG msg;
+    while (GetMessage(&msg, NULL, 0, 0) > 0) DispatchMessage(&msg);
+}
+
+bool input_thread_start(InputThread* t, InputQueue* q, void* focus_window, const char* device) {
+    (void)device;
+    memset(t, 0, sizeof(InputThread));
+    t->queue = q;
+    t->focus_window = focus_window;
+    if (!platform_thread_start(&t->thread, input_thread_main, t)) return false;
+    while (platform_atomic_load(&t->ready) == 0) platform_sleep_ms(1);
+    if (platform_atomic_load(&t->ready) < 0) {
+        platform_thread_join(&t->thread);
+        return false;
+    }
+    platform_atomic_store(&t->running, 1);
+    return true;
+}
+
+void input_thread_stop(InputThread* t) {
+    if (!platform_atomic_load(&t->running)) return;
+    platform_atomic_store(&t->running, 0);
+    PostMessage((HWND)t->message_window, WM_CLOSE, 0, 0);
+    platform_thread_join(&t->thread);
+}
+// --- END: Raw input ---
+
+#else
+
+// --- START: evdev ---
+static bool open_device(InputThread* t, const char* path) {
+    if (t->device_count == INPUT_THREAD_MAX_DEVICES) return false;
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return false;
+    int clock = CLOCK_MONOTONIC; // Event stamps on platform_time_ns's clock instead of wall time
+    if (ioctl(fd, EVIOCSCLOCKID, &clock) < 0) {
+        close(fd);
+        return false;
+    }
+    t->device_fds[t->device_count++] = fd;
+    return true;
+}
+
+// Every keyboard the system lists by physical path
+static void open_keyboards(InputThread* t) {
+    const char* dir_path = "/dev/input/by-path";
+    DIR* dir = opendir(dir_path);
+    if (!dir) return;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len < 10 || strcmp(entry->d_name + len - 10, "-event-kbd") != 0) continue;
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name);
+        open_device(t, path);
+    }
+    closedir(dir);
+}
+
+static void read_device(InputThread* t, int fd) {
+    struct input_event events[64];
+    ssize_t bytes;
+    while ((bytes = read(fd, events, sizeof(events))) > 0) {
+        int count = (int)(bytes / (ssize_t)sizeof(struct input_event));
+        for (int i = 0; i < count; i++) {
+            const struct input_event* ev = &events[i];
+            if (ev->type != EV_KEY || ev->value == 0) continue; // 1 = press, 2 = repeat
+            uint64_t time_ns = (uint64_t)ev->time.tv_sec * 1000000000ull + (uint64_t)ev->time.tv_usec * 1000ull;
+            switch (ev->code) {
+                case KEY_LEFT:  push_key(t, -1, 0, false, time_ns); break;
+                case KEY_RIGHT: push_key(t, 1, 0, false, time_ns); break;
+                case KEY_UP:    push_key(t, 0, -1, false, time_ns); break;
+                case KEY_DOWN:  push_key(t, 0, 1, false, time_ns); break;
+                case KEY_SPACE: push_key(t, 0, 0, true, time_ns); break;
+            }
+        }
+    }
+}
+
+static void input_thread_main(void* arg) {
+    InputThread* t = (InputThread*)arg;
+    struct pollfd fds[INPUT_THREAD_MAX_DEVICES];
+    for (int i = 0; i < t->device_count; i++) {
+        fds[i].fd = t->device_fds[i];
+        fds[i].events = POLLIN;
+    }
+    while (platform_atomic_load(&t->running)) {
+        // The timeout only bounds how long input_thread_stop waits
+        if (poll(fds, (nfds_t)t->device_count, 100) <= 0) continue;
+        for (int i = 0; i < t->device_count; i++) {
+            if (fds[i].revents & POLLIN) read_device(t, fds[i].fd);
+        }
+    }
+}
+
+bool input_thread_start(InputThread* t, InputQueue* q, void* focus_window, const char* device) {
+    (void)focus_window;
+    memset(t, 0, sizeof(InputThread));
+    t->queue = q;
+    if (device) open_device(t, device);
+    else open_keyboards(t);
+    if (t->device_count == 0) return false;
+
+    platform_atomic_store(&t->running, 1);
+    if (!platform_thread_start(&t->thread, input_thread_main, t)) {
+        platform_atomic_store(&t->running, 0);
+        for (int i = 0; i < t->device_count; i++) close(t->device_fds[i]);
+        return false;
+    }
+    platform_atomic_store(&t->ready, 1);
+    return true;
+}
+
+void input_thread_stop(InputThread* t) {
+    if (!platform_atomic_load(&t->running)) return;
+    platform_atomic_store(&t->running, 0);
+    platform_thread_join(&t->thread);
+    for (int i = 0; i < t->device_count; i++) close(t->device_fds[i]);
+    t->device_count = 0;
+}
+// --- END: evdev ---
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef INPUT_THREAD_H
+#define INPUT_THREAD_H
+
+#include <stdbool.h>
+#include "input_queue.h"
+#include "platform.h"
+
+// Reads the keyboard on its own thread and pushes arrows and Space into an
+// InputQueue, so a slow paint or tick on the window thread never holds a key
+// press back, and its time stamp is when the key went down, not when the window
+// procedure got round to it.
+//
+// Windows: raw input (WM_INPUT) to a message-only window owned by the thread,
+// stamped on arrival. Linux: evdev, with the kernel's own CLOCK_MONOTONIC stamp
+// of each event (the clock platform_time_ns reads); needs read access to
+// /dev/input/event*, usually through the input group.
+
+#define INPUT_THREAD_MAX_DEVICES 8
+
+typedef struct {
+    InputQueue* queue;
+    PlatformThread thread;
+    int running;         // atomic
+    int ready;           // atomic; 1 once listening, -1 if that failed
+    void* focus_window;  // Windows: HWND whose keys count; NULL = any
+    void* message_window; // Windows: the thread's raw input target
+    int device_fds[INPUT_THREAD_MAX_DEVICES]; // Linux
+    int device_count;
+} InputThread;
+
+// Starts listening. focus_window (Windows) limits input to when that window is
+// in front; device (Linux) is an evdev path, NULL for every keyboard under
+// /dev/input/by-path. False if no keyboard could be opened.
+bool input_thread_start(InputThread* t, InputQueue* q, void* focus_window, const char* device);
+void input_thread_stop(InputThread* t);
+
+#endif // INPUT_THREAD_H
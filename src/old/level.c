@@ -0,0 +1,186 @@
+#include "level.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- START: Parsing ---
+static bool set_error(char* error, size_t error_size, int line, const char* what) {
+    if (error_size) snprintf(error, error_size, "line %d: %s", line, what);
+    return false;
+}
+
+static LevelDef* add_level(LevelSet* set, int number) {
+    LevelDef* levels = realloc(set->levels, (size_t)(set->count + 1) * sizeof(LevelDef));
+    if (!levels) return NULL;
+    set->levels = levels;
+    LevelDef* def = &levels[set->count++];
+    memset(def, 0, sizeof(LevelDef));
+    def->number = number;
+    def->board_w = GAME_DEFAULT_W;
+    def->board_h = GAME_DEFAULT_H;
+    return def;
+}
+
+// Checks the boxes against the board once the section is complete
+static bool check_level(const LevelDef* def, char* error, size_t error_size, int line) {
+    for (int i = 0; i < def->box_count; i++) {
+        const LevelBox* b = &def->boxes[i];
+        if (b->x1 < 0 || b->y1 < 0 || b->x2 > def->board_w || b->y2 > def->board_h || b->x2 <= b->x1 || b->y2 <= b->y1) {
+            char what[96];
+            snprintf(what, sizeof(what), "level %d box %d is not inside its %dx%d board", def->number, i + 1,
+                     def->board_w, def->board_h);
+            return set_error(error, error_size, line, what);
+        }
+    }
+    return true;
+}
+
+bool level_set_load(LevelSet* set, const char* path, char* error, size_t error_size) {
+    memset(set, 0, sizeof(LevelSet));
+    FILE* f = fopen(path, "r");
+    if (!f) return set_error(error, error_size, 0, "cannot open the file");
+
+    char text[256];
+    int line = 0;
+    LevelDef* def = NULL;
+    bool ok = true;
+    while (ok && fgets(text, sizeof(text), f)) {
+        line++;
+        char* comment = strchr(text, '#');
+        if (comment) *comment = '\0';
+        char word[16];
+        if (sscanf(text, "%15s", word) != 1) continue; // Blank
+
+        int number, w, h, x1, y1, x2, y2;
+        if (sscanf(text, " [level %d ]", &number) == 1) {
+            if (def) ok = check_level(def, error, error_size, line - 1);
+            if (!ok) break;
+            if (number < 1 || number > LEVEL_MAX_NUMBER) {
+                ok = set_error(error, error_size, line, "level number out of range");
+            } else if (level_set_find(set, number)) {
+                ok = set_error(error, error_size, line, "level defined twice");
+            } else if (!(def = add_level(set, number))) {
+                ok = set_error(error, error_size, line, "out of memory");
+            }
+        } else if (!def) {
+            ok = set_error(error, error_size, line, "expected [level n] first");
+        } else if (strcmp(word, "board") == 0 && sscanf(text, " board %dx%d", &w, &h) == 2) {
+            if (w < GAME_MIN_CELLS || w > GAME_MAX_CELLS || h < GAME_MIN_CELLS || h > GAME_MAX_CELLS) {
+                ok = set_error(error, error_size, line, "board size out of range");
+            }
+            def->board_w = w;
+            def->board_h = h;
+        } else if (strcmp(word, "box") == 0 && sscanf(text, " box %d %d %d %d", &x1, &y1, &x2, &y2) == 4) {
+            if (def->box_count == LEVEL_MAX_BOXES) {
+                ok = set_error(error, error_size, line, "too many boxes");
+            } else {
+                LevelBox* b = &def->boxes[def->box_count++];
+                b->x1 = (int16_t)x1; b->y1 = (int16_t)y1;
+                b->x2 = (int16_t)x2; b->y2 = (int16_t)y2;
+            }
+        } else {
+            ok = set_error(error, error_size, line, "expected board WxH or box x1 y1 x2 y2");
+        }
+    }
+    if (ok && def) ok = check_level(def, error, error_size, line);
+    fclose(f);
+    if (!ok) level_set_free(set);
+    return ok;
+}
+
+void level_set_free(LevelSet* set) {
+    free(set->levels);
+    memset(set, 0, sizeof(LevelSet));
+}
+
+const LevelDef* level_set_find(const LevelSet* set, int number) {
+    for (int i = 0; i < set->count; i++) {
+        if (set->levels[i].number == number) return &set->levels[i];
+    }
+    return NULL;
+}
+
+void level_write(FILE* f, const LevelDef* def) {
+    fprintf(f, "[level %d]\nboard %dx%d\n", def->number, def->board_w, def->board_h);
+    for (int i = 0; i < def->box_count; i++) {
+        const LevelBox* b = &def->boxes[i];
+        fprintf(f, "box %d %d %d %d\n", b->x1, b->y1, b->x2, b->y2);
+    }
+}
+// --- END: Parsing ---
+
+// Vertex v of a board of `base` cells on one of `size` cells
+static int scale_vertex(int v, int size, int base) {
+    return size == base ? v : (v * size + base / 2) / base;
+}
+
+void level_apply(Game* g, const LevelDef* def) {
+    if (!def) return;
+    for (int i = 0; i < def->box_count; i++) {
+        const LevelBox* b = &def->boxes[i];
+        int x1 = scale_vertex(b->x1, g->w, def->board_w);
+        int x2 = scale_vertex(b->x2, g->w, def->board_w);
+        int y1 = scale_vertex(b->y1, g->h, def->board_h);
+        int y2 = scale_vertex(b->y2, g->h, def->board_h);
+        if (x2 <= x1) x2 = x1 + 1;
+        if (y2 <= y1) y2 = y1 + 1;
+        if (x2 > g->w || y2 > g->h) continue;
+
+        // The outline is wall, the inside counts as claimed like in the original
+        size_t w = (size_t)g->w;
+        for (int x = x1; x < x2; x++) {
+            game_set_flag(g, g->past_path_h, GAME_HASH_PAST_PATH_H, (size_t)y1 * w + x);
+            game_set_flag(g, g->past_path_h, GAME_HASH_PAST_PATH_H, (size_t)y2 * w + x);
+        }
+        for (int y = y1; y < y2; y++) {
+            game_set_flag(g, g->past_path_v, GAME_HASH_PAST_PATH_V, (size_t)y * (w + 1) + x1);
+            game_set_flag(g, g->past_path_v, GAME_HASH_PAST_PATH_V, (size_t)y * (w + 1) + x2);
+            for (int x = x1; x < x2; x++) {
+                if (!GAME_CLAIMED(g, x, y)) {
+                    game_set_flag(g, g->claimed, GAME_HASH_CLAIMED, (size_t)y * w + x);
+                    g->claimed_cell_count++;
+                }
+            }
+        }
+    }
+}
+
+// --- START: Baked levels ---
+void level_asset_name(int number, char* out, size_t out_size) {
+    snprintf(out, out_size, "level_%03d", number);
+}
+
+size_t level_baked_size(const Game* g) {
+    return sizeof(LevelBakedHeader) + game_wall_planes_bytes(g);
+}
+
+void level_bake(const Game* g, void* out) {
+    LevelBakedHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = LEVEL_BAKED_MAGIC;
+    header.board_w = (uint16_t)g->w;
+    header.board_h = (uint16_t)g->h;
+    header.claimed_cells = (uint32_t)g->claimed_cell_count;
+    header.planes_bytes = (uint32_t)game_wall_planes_bytes(g);
+    header.hash = g->hash;
+    memcpy(out, &header, sizeof(header));
+    memcpy((uint8_t*)out + sizeof(header), g->claimed, header.planes_bytes);
+}
+
+bool level_load_baked(Game* g, const void* data, size_t size) {
+    LevelBakedHeader header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != LEVEL_BAKED_MAGIC || header.board_w != g->w || header.board_h != g->h ||
+        header.planes_bytes != game_wall_planes_bytes(g) || size < sizeof(header) + header.planes_bytes) {
+        return false;
+    }
+    initialize_game_state(g);
+    // The path planes and snake_cells are empty after the reset, so the baked hash is the whole board's
+    memcpy(g->claimed, (const uint8_t*)data + sizeof(header), header.planes_bytes);
+    g->claimed_cell_count = (int)header.claimed_cells;
+    g->hash = header.hash;
+    return true;
+}
+// --- END: Baked levels ---
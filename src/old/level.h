@@ -0,0 +1,69 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "game.h"
+
+// Level layouts, replacing FUN_1038_065c/FUN_1038_0dc2's hard-coded walls.
+//
+// Levels are written in a small text format (see src/levels.txt): per level, the
+// board size it was drawn for and its wall boxes. pack_assets compiles each one
+// into mamba.pak as "level_nnn", the wall planes of a fresh board with the level
+// applied, so loading a level is initialize_game_state and one memcpy instead of
+// drawing boxes. Tools that need other board sizes read the text and apply it.
+
+#define LEVEL_MAX_NUMBER 999
+#define LEVEL_MAX_BOXES 64
+#define LEVEL_BAKED_MAGIC 0x4C564C4Du // "MLVL"
+
+typedef struct {
+    int16_t x1, y1, x2, y2; // Corner vertices
+} LevelBox;
+
+typedef struct {
+    int number;
+    int board_w, board_h;
+    int box_count;
+    LevelBox boxes[LEVEL_MAX_BOXES];
+} LevelDef;
+
+typedef struct {
+    LevelDef* levels;
+    int count;
+} LevelSet;
+
+// Parses a level file. On failure fills `error` with the line and problem.
+bool level_set_load(LevelSet* set, const char* path, char* error, size_t error_size);
+void level_set_free(LevelSet* set);
+// NULL if the set has no such level
+const LevelDef* level_set_find(const LevelSet* set, int number);
+// Writes one level section in the file format, readable by level_set_load
+void level_write(FILE* f, const LevelDef* def);
+
+// Draws the level's boxes onto g (normally just reset), scaled to g's board
+void level_apply(Game* g, const LevelDef* def);
+
+// --- START: Baked levels ---
+// A "level_nnn" asset: this header, then game_wall_planes_bytes of planes
+typedef struct {
+    uint32_t magic;
+    uint16_t board_w, board_h;
+    uint32_t claimed_cells;
+    uint32_t planes_bytes;
+    uint64_t hash; // Game.hash right after loading
+} LevelBakedHeader;
+
+// Asset name of a level, "level_001"
+void level_asset_name(int number, char* out, size_t out_size);
+// Bytes level_bake writes for g's board
+size_t level_baked_size(const Game* g);
+// Writes g's wall planes (a reset board with a level applied) to out
+void level_bake(const Game* g, void* out);
+// Resets g and loads the planes. False if the data is not a level for g's board.
+bool level_load_baked(Game* g, const void* data, size_t size);
+// --- END: Baked levels ---
+
+#endif // LEVEL_H
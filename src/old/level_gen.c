@@ -0,0 +1,159 @@
+#include "level_gen.h"
+
+#include <string.h>
+
+void level_gen_default_config(LevelGenConfig* config) {
+    memset(config, 0, sizeof(LevelGenConfig));
+    config->board_w = GAME_DEFAULT_W;
+    config->board_h = GAME_DEFAULT_H;
+    config->min_boxes = 2;
+    config->max_boxes = 6;
+    config->max_wall_percent = 12; // Level 1 has 6.5%
+    config->mirror = true;
+
+    batch_default_config(&config->play);
+    config->play.snakes = 2;       // With one, walls mostly help the bot: it rarely drops under 50%
+    config->play.max_ticks = 20000;
+    config->games = 1000;
+    config->threads = 0;
+    config->min_win_percent = 30;
+    config->max_win_percent = 50;
+}
+
+// --- START: Layout ---
+typedef struct {
+    uint64_t state;
+} GenRandom;
+
+// splitmix64, so neighbouring seeds give unrelated layouts
+static uint64_t gen_next(GenRandom* r) {
+    uint64_t z = (r->state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in lo..hi; lo when the range is empty
+static int gen_range(GenRandom* r, int lo, int hi) {
+    if (hi <= lo) return lo;
+    return lo + (int)(gen_next(r) % (uint64_t)(hi - lo + 1));
+}
+
+// True if b comes closer than LEVEL_GEN_MIN_GAP cells to any of the placed boxes
+static bool crowds(const LevelDef* def, const LevelBox* b) {
+    for (int i = 0; i < def->box_count; i++) {
+        const LevelBox* o = &def->boxes[i];
+        if (b->x1 < o->x2 + LEVEL_GEN_MIN_GAP && o->x1 < b->x2 + LEVEL_GEN_MIN_GAP &&
+            b->y1 < o->y2 + LEVEL_GEN_MIN_GAP && o->y1 < b->y2 + LEVEL_GEN_MIN_GAP) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A box in the rows 0..max_y (vertices), either a spur out from a border or a free block
+static void random_box(GenRandom* r, int w, int max_y, bool mirror, LevelBox* b) {
+    const int gap = LEVEL_GEN_MIN_GAP;
+    int h = max_y; // Rows the box may use
+    if (gen_range(r, 0, 2) < 2) {
+        int thick = gen_range(r, 1, 2);
+        // Mirrored boards are drawn as their top half, so their spurs start at the top or a side
+        int side = gen_range(r, 0, mirror ? 2 : 3); // Top, left, right, bottom
+        bool vertical = side == 0 || side == 3;
+        int span = vertical ? h : w;
+        int across = vertical ? w : h;
+        int length = gen_range(r, span * 20 / 100, span * 45 / 100);
+        if (length < 1) length = 1;
+        int at = gen_range(r, gap, across - gap - thick);
+        if (vertical) {
+            b->x1 = (int16_t)at;
+            b->x2 = (int16_t)(at + thick);
+            b->y1 = (int16_t)(side == 0 ? 0 : h - length);
+            b->y2 = (int16_t)(side == 0 ? length : h);
+        } else {
+            b->y1 = (int16_t)at;
+            b->y2 = (int16_t)(at + thick);
+            b->x1 = (int16_t)(side == 1 ? 0 : w - length);
+            b->x2 = (int16_t)(side == 1 ? length : w);
+        }
+    } else {
+        int bw = gen_range(r, 2, w / 5), bh = gen_range(r, 2, h / 3);
+        int x = gen_range(r, gap, w - gap - bw);
+        int y = gen_range(r, gap, h - (mirror ? 0 : gap) - bh);
+        b->x1 = (int16_t)x;
+        b->x2 = (int16_t)(x + bw);
+        b->y1 = (int16_t)y;
+        b->y2 = (int16_t)(y + bh);
+    }
+}
+
+void level_gen_layout(const LevelGenConfig* config, uint64_t seed, LevelDef* out) {
+    memset(out, 0, sizeof(LevelDef));
+    out->board_w = config->board_w;
+    out->board_h = config->board_h;
+    int w = config->board_w, h = config->board_h;
+
+    GenRandom r = { seed };
+    int most = config->max_boxes;
+    if (config->mirror && most > LEVEL_MAX_BOXES / 2) most = LEVEL_MAX_BOXES / 2;
+    if (most > LEVEL_MAX_BOXES) most = LEVEL_MAX_BOXES;
+    int target = gen_range(&r, config->min_boxes < most ? config->min_boxes : most, most);
+
+    // Mirrored boxes stay in the top half, at least a gap clear of their images
+    int max_y = config->mirror ? (h - LEVEL_GEN_MIN_GAP) / 2 : h;
+    int copies = config->mirror ? 2 : 1;
+    int wall_budget = w * h * config->max_wall_percent / 100;
+    int wall_cells = 0;
+
+    LevelDef half;
+    memset(&half, 0, sizeof(half));
+    for (int attempt = 0; attempt < target * 32 && half.box_count < target; attempt++) {
+        LevelBox b;
+        random_box(&r, w, max_y, config->mirror, &b);
+        if (b.x1 < 0 || b.y1 < 0 || b.x2 > w || b.y2 > max_y || b.x2 <= b.x1 || b.y2 <= b.y1) continue;
+        int cells = (b.x2 - b.x1) * (b.y2 - b.y1) * copies;
+        if (wall_cells + cells > wall_budget || crowds(&half, &b)) continue;
+        half.boxes[half.box_count++] = b;
+        wall_cells += cells;
+    }
+
+    for (int i = 0; i < half.box_count; i++) {
+        const LevelBox* b = &half.boxes[i];
+        out->boxes[out->box_count++] = *b;
+        if (config->mirror) {
+            LevelBox* m = &out->boxes[out->box_count++];
+            m->x1 = b->x1;
+            m->x2 = b->x2;
+            m->y1 = (int16_t)(h - b->y2);
+            m->y2 = (int16_t)(h - b->y1);
+        }
+    }
+}
+// --- END: Layout ---
+
+bool level_gen_candidate(const LevelGenConfig* config, uint64_t seed, LevelCandidate* out) {
+    memset(out, 0, sizeof(LevelCandidate));
+    out->seed = seed;
+    level_gen_layout(config, seed, &out->def);
+
+    int wall_cells = 0;
+    for (int i = 0; i < out->def.box_count; i++) {
+        const LevelBox* b = &out->def.boxes[i];
+        wall_cells += (b->x2 - b->x1) * (b->y2 - b->y1);
+    }
+    out->wall_percent = 100.0 * wall_cells / (config->board_w * config->board_h);
+
+    BatchConfig play = config->play;
+    play.board_w = config->board_w;
+    play.board_h = config->board_h;
+    play.layout = &out->def;
+    BatchStats stats;
+    if (!batch_run(&play, config->games, config->threads, NULL, &stats)) return false;
+
+    out->win_percent = 100.0 * stats.won / stats.games;
+    out->claimed_percent = stats.claimed_percent_mean;
+    out->deaths = (double)stats.deaths / stats.games;
+    out->seconds = stats.seconds;
+    out->accepted = out->win_percent >= config->min_win_percent && out->win_percent <= config->max_win_percent;
+    return true;
+}
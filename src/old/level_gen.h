@@ -0,0 +1,52 @@
+#ifndef LEVEL_GEN_H
+#define LEVEL_GEN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "batch.h"
+#include "level.h"
+
+// Wall layouts from seeds, kept when the bot finds them as hard as asked.
+//
+// The original has wall boxes on levels 1-3 only. A generated layout mixes spurs
+// (thin walls out from a border, like the original's) and free blocks, spaced so
+// no corridor is narrower than LEVEL_GEN_MIN_GAP cells. Each candidate is then
+// played by batch_run's bot on every core, on the same game seeds for every
+// candidate so they are compared on equal terms; its difficulty is the share of
+// games the bot wins.
+
+#define LEVEL_GEN_MIN_GAP 2
+
+typedef struct {
+    int board_w, board_h;
+    int min_boxes, max_boxes;  // Before mirroring, at most LEVEL_MAX_BOXES / 2
+    int max_wall_percent;      // Of the board, claimed by the walls from the start
+    bool mirror;               // Mirror each box top to bottom, as the original's levels are
+
+    // Difficulty
+    BatchConfig play;          // Snakes, level, lives and ticks of the test games; seed shared by all candidates
+    int games;                 // Bot games per candidate
+    int threads;               // 0 = one per processor
+    int min_win_percent, max_win_percent; // Band the bot's win rate must fall in
+} LevelGenConfig;
+
+typedef struct {
+    LevelDef def;
+    uint64_t seed;
+    double wall_percent;
+    double win_percent;
+    double claimed_percent;    // Mean over the games
+    double deaths;             // Per game
+    double seconds;            // Evaluation wall clock
+    bool accepted;
+} LevelCandidate;
+
+void level_gen_default_config(LevelGenConfig* config);
+
+// Draws the layout of `seed` into out (number 0); the same seed always gives the same layout
+void level_gen_layout(const LevelGenConfig* config, uint64_t seed, LevelDef* out);
+
+// Generates and plays candidate `seed`. False if out of memory.
+bool level_gen_candidate(const LevelGenConfig* config, uint64_t seed, LevelCandidate* out);
+
+#endif // LEVEL_GEN_H
@@ -3,98 +3,61 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h> // For memset/memcpy
+#include "game.h"
+#include "render.h"
 #include "spider_bmp.h"
-
-// Game constants from your code
-#define EDGE_SIZE 1 
-#define MAP_W_PIXELS 455 
-#define MAP_H_PIXELS 359 
-#define MAP_W_PIXELS_INCL_EDGE (MAP_W_PIXELS + EDGE_SIZE + EDGE_SIZE) 
-#define MAP_H_PIXELS_INCL_EDGE (MAP_H_PIXELS + EDGE_SIZE + EDGE_SIZE) 
-#define MAP_W_CELLS 35
-#define MAP_H_CELLS 29
-#define CELL_SIZE 11 
-#define SPIDER_MAX_X (MAP_W_CELLS * (CELL_SIZE + EDGE_SIZE))
-#define SPIDER_MAX_Y (MAP_H_CELLS * (CELL_SIZE + EDGE_SIZE))
-#define WIN_BORDER 16 
-#define WIN_W (MAP_W_PIXELS_INCL_EDGE + 2 * WIN_BORDER)
-#define WIN_H (MAP_H_PIXELS_INCL_EDGE + 2 * WIN_BORDER)
-
-// Colors
-int color_black = 0x000000;
-int color_white = 0xFFFFFF;
-int color_cyan = 0xFFFF00; // Corrected: BGR, so Cyan is FFFF00
-int color_light_gray = 0xC0C0C0;
-
-// Game state variables
-bool claimed[MAP_W_CELLS][MAP_H_CELLS];
-bool past_path_h[MAP_W_CELLS][MAP_H_CELLS + 1];
-bool past_path_v[MAP_W_CELLS + 1][MAP_H_CELLS];
-bool path_h[MAP_W_CELLS][MAP_H_CELLS + 1]; // Current path
-bool path_v[MAP_W_CELLS + 1][MAP_H_CELLS]; // Current path
-
-int spider_x = 0, spider_y = 0; // Pixel coordinates
-int spider_vx = 0, spider_vy = 0; // Pixel velocity
-int last_vertex_x = 0, last_vertex_y = 0; // Grid coordinates
-int input_vx_intent = 0, input_vy_intent = 0; // Queued pixel velocity intent
-
-uint32_t pixels[WIN_W * WIN_H];
-
-
-// --- START: Core Data Structures ---
-typedef struct { int x, y; } Point;
-
-typedef struct {
-    Point cells[MAP_W_CELLS * MAP_H_CELLS];
-    int count;
-    bool is_adjacent_to_claimed_territory;
-} Region;
-// --- END: Core Data Structures ---
-
-// Spider state
-typedef enum {
-    SPIDER_IDLE_ON_CLAIMED,
-    SPIDER_MOVING_ON_CLAIMED,
-    SPIDER_DRAWING_PATH
-} SpiderState;
-SpiderState spider_state = SPIDER_IDLE_ON_CLAIMED;
-
-// Path drawing state
-int path_start_vertex_x, path_start_vertex_y; // Grid coords where current path started
-Point current_path_vertices[MAP_W_CELLS * MAP_H_CELLS * 2]; // Max possible vertices in a path
-int current_path_len = 0;
-
-// Game progression
-int total_cells = MAP_W_CELLS * MAP_H_CELLS;
-int claimed_cell_count = 0;
-
-// --- START: Point and Queue for BFS ---
-
-#define MAX_QUEUE_SIZE (MAP_W_CELLS * MAP_H_CELLS)
-Point queue[MAX_QUEUE_SIZE];
-int queue_front, queue_rear;
-bool visited_bfs[MAP_W_CELLS][MAP_H_CELLS]; // Visited array for BFS
-
-void init_queue() { queue_front = queue_rear = 0; }
-void enqueue(Point p) {
-    if ((queue_rear + 1) % MAX_QUEUE_SIZE == queue_front) { /*fprintf(stderr, "Queue full!\n");*/ return; }
-    queue[queue_rear] = p;
-    queue_rear = (queue_rear + 1) % MAX_QUEUE_SIZE;
-}
-Point dequeue() {
-    if (queue_front == queue_rear) { /*fprintf(stderr, "Queue empty!\n");*/ return (Point){-1,-1}; }
-    Point p = queue[queue_front];
-    queue_front = (queue_front + 1) % MAX_QUEUE_SIZE;
-    return p;
-}
-bool is_queue_empty() { return queue_front == queue_rear; }
-// --- END: Point and Queue for BFS ---
-
-
-// Forward declarations
-void attempt_claim_territory();
-void clear_current_path_data();
-void initialize_game_state();
+#include "asset_pack.h"
+#include "bmp_stream.h"
+#include "audio_mixer.h"
+#include "input_queue.h"
+#include "level.h"
+#include "input_thread.h"
+#include "prefs.h"
+#include "rewind.h"
+#include "scaler.h"
+#include "triple_buffer.h"
+#include "frame_stats.h"
+#include "platform.h"
+#include "trace.h"
+
+// The board; its size comes from mamba.ini (BoardWidth/BoardHeight), 35x29 by default.
+// No snakes yet: the window has no lives or level flow to go with them.
+Game game;
+
+// Assets, referenced in place from the mapped mamba.pak when it is present
+AssetPack asset_pack;
+
+// Key presses waiting for the spider to reach a vertex where they can apply
+InputQueue input_queue;
+// Fills input_queue off the window thread; while it runs WM_KEYDOWN leaves the arrows alone
+InputThread input_thread;
+
+// Sound effects, mixed on their own thread so playing one never stalls a tick
+AudioMixer audio_mixer;
+
+// Settings from mamba.ini, same keys as the original's profile_preferences_load
+#define PREFS_SECTION "Mamba"
+Prefs prefs;
+bool sound_enabled = true;
+int start_level = 1;
+char player_name[32] = "";
+int board_w = GAME_DEFAULT_W, board_h = GAME_DEFAULT_H;
+int rewind_mb = 16;
+int window_scale = 0; // 0 = as large as fits the screen
+bool smooth_scaling = true;
+
+// The frame as the window shows it, window_scale times the size of `pixels`
+Scaler scaler;
+
+// Phase timings per frame; 'F' shows them over the board, FrameStatsCsv in mamba.ini logs them
+#define TICK_MS 32 // ~30 FPS like the original's timer
+FrameStats frame_stats;
+int show_frame_stats = 0; // atomic
+char frame_stats_csv[260] = "";
+bool frame_stats_logging = false; // The CSV is open; set before the game threads start
+
+// Every tick of the game so far, as far as rewind_mb reaches; hold Backspace to scrub back
+RewindBuffer* rewind_buffer = NULL;
 
 
 void debug_printf_fmt(const char* fmt, ...) {
@@ -110,603 +73,321 @@ void debug_printf(const char* msg) {
     OutputDebugStringA(msg);
 }
 
-void clear_screen(uint32_t color) {
-    for (int i = 0; i < WIN_W * WIN_H; i++) {
-        pixels[i] = color;
-    }
-}
-
-void draw_rect(int x, int y, int w, int h, uint32_t color) {
-    for (int dy = 0; dy < h; dy++) {
-        for (int dx = 0; dx < w; dx++) {
-            int px = x + dx;
-            int py = y + dy;
-            if (px >= 0 && px < WIN_W && py >= 0 && py < WIN_H) {
-                pixels[py * WIN_W + px] = color;
-            }
-        }
-    }
+void play_sound(SoundId id) {
+    if (sound_enabled) mixer_play(&audio_mixer, id);
 }
 
-void draw_cells() {
-    for (int y = 0; y < MAP_H_CELLS; y++) {
-        for (int x = 0; x < MAP_W_CELLS; x++) {
-            if (claimed[x][y]) {
-                draw_rect(WIN_BORDER + EDGE_SIZE + x * (CELL_SIZE + EDGE_SIZE) , 
-                          WIN_BORDER + EDGE_SIZE + y * (CELL_SIZE + EDGE_SIZE) , 
-                          CELL_SIZE, CELL_SIZE, color_light_gray);
-            }
-        }
-    }
+void load_preferences() {
+    prefs_load(&prefs, "mamba.ini");
+    sound_enabled = prefs_get_int(&prefs, PREFS_SECTION, "Sound", 1) != 0;
+    start_level = prefs_get_int(&prefs, PREFS_SECTION, "Level", 1);
+    if (start_level < 1) start_level = 1;
+    if (start_level > 10) start_level = 10;
+    snprintf(player_name, sizeof(player_name), "%s", prefs_get_string(&prefs, PREFS_SECTION, "Name", ""));
+    // Not in the original; only read, so mamba.ini only has them if set by hand (game_init clamps them)
+    board_w = prefs_get_int(&prefs, PREFS_SECTION, "BoardWidth", GAME_DEFAULT_W);
+    board_h = prefs_get_int(&prefs, PREFS_SECTION, "BoardHeight", GAME_DEFAULT_H);
+    rewind_mb = prefs_get_int(&prefs, PREFS_SECTION, "RewindMB", 16);
+    if (rewind_mb < 0) rewind_mb = 0;
+    window_scale = prefs_get_int(&prefs, PREFS_SECTION, "Scale", 0);
+    smooth_scaling = prefs_get_int(&prefs, PREFS_SECTION, "Smooth", 1) != 0;
+    snprintf(frame_stats_csv, sizeof(frame_stats_csv), "%s", prefs_get_string(&prefs, PREFS_SECTION, "FrameStatsCsv", ""));
 }
 
-void draw_bitmap(const uint32_t *bitmap, int x, int y, int bitmap_w, int bitmap_h) {
-    for (int dy = 0; dy < bitmap_h; dy++) {
-        for (int dx = 0; dx < bitmap_w; dx++) {
-            int px = x + dx;
-            int py = y + dy;
-            if (px >= 0 && px < WIN_W && py >= 0 && py < WIN_H) {
-                uint32_t color = bitmap[dy * bitmap_w + dx];
-                if (color == 0xFF000000) continue; // Skip fully transparent black pixels (alpha example)
-                                                  // Or if your bitmap uses a specific transparent color key:
-                if (color == 0x000000 && (bitmap == spider_pixels)) continue; // Example: black is transparent for spider
-                pixels[py * WIN_W + px] = color;
-            }
-        }
-    }
+void save_preferences() {
+    // Setters only mark keys that actually changed; the file is written once, if at all
+    prefs_set_int(&prefs, PREFS_SECTION, "Sound", sound_enabled ? 1 : 0);
+    prefs_set_int(&prefs, PREFS_SECTION, "Level", start_level);
+    prefs_set_string(&prefs, PREFS_SECTION, "Name", player_name);
+    if (!prefs_flush(&prefs)) debug_printf("Cannot write mamba.ini\n");
+    prefs_free(&prefs);
 }
 
-void draw_paths(bool is_current_path_drawing) {
-    uint32_t path_color = is_current_path_drawing ? color_white : color_black;
-    bool (*h_paths_to_draw)[MAP_H_CELLS + 1] = is_current_path_drawing ? path_h : past_path_h;
-    bool (*v_paths_to_draw)[MAP_H_CELLS]     = is_current_path_drawing ? path_v : past_path_v;
-
-    int baseOffset = WIN_BORDER;
+// Claimed cells and percentage, in the status bar under the board
+Counter cells_counter, percent_counter;
 
-    // Draw horizontal edges
-    for (int y = 0; y < MAP_H_CELLS + 1; y++) {
-        for (int x = 0; x < MAP_W_CELLS; x++) {
-            if (h_paths_to_draw[x][y]) {
-                int draw_x = baseOffset + x * (CELL_SIZE + EDGE_SIZE) + EDGE_SIZE; // Start after vertical border
-                int draw_y = baseOffset + y * (CELL_SIZE + EDGE_SIZE);
-                draw_rect(draw_x, draw_y, CELL_SIZE, EDGE_SIZE, path_color);
-            }
-        }
-    }
-    // Draw vertical edges
-    for (int y = 0; y < MAP_H_CELLS; y++) {
-        for (int x = 0; x < MAP_W_CELLS + 1; x++) {
-            if (v_paths_to_draw[x][y]) {
-                int draw_x = baseOffset + x * (CELL_SIZE + EDGE_SIZE);
-                int draw_y = baseOffset + y * (CELL_SIZE + EDGE_SIZE) + EDGE_SIZE; // Start after horizontal border
-                draw_rect(draw_x, draw_y, EDGE_SIZE, CELL_SIZE, path_color);
-            }
-        }
-    }
+void update_counters(const Game* g) {
+    uint32_t percent = g->total_cells > 0 ? (uint32_t)(g->claimed_cell_count * 100 / g->total_cells) : 0;
+    counter_draw(&cells_counter, (uint32_t)g->claimed_cell_count);
+    counter_draw(&percent_counter, percent);
 }
 
-
-void rotate_pixels(const uint32_t* src, uint32_t* dst, int width, int height, int angle) {
-    int out_w = width, out_h = height;
-    if (angle == 90 || angle == 270) {
-        out_w = height;
-        out_h = width;
-    }
-
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int src_idx = y * width + x;
-            int dst_idx;
-
-            switch (angle) {
-                case 90: dst_idx = x * out_h + (out_h - 1 - y); break; // Rotated height
-                case 180: dst_idx = (height - 1 - y) * width + (width - 1 - x); break;
-                case 270: dst_idx = (out_w - 1 - x) * out_h + y; break; // Rotated width
-                default: dst_idx = src_idx; break;
-            }
-            if (dst_idx < out_w * out_h) dst[dst_idx] = src[src_idx];
-        }
+// Fresh board for start_level, with its walls from mamba.pak when the pack has
+// that level baked for this board size; an empty board otherwise
+void new_game() {
+    char name[ASSET_NAME_MAX];
+    level_asset_name(start_level, name, sizeof(name));
+    const AssetPackEntry* e = asset_pack_find(&asset_pack, name);
+    if (!e || e->kind != ASSET_BLOB || !level_load_baked(&game, asset_pack_data(&asset_pack, e), e->size)) {
+        initialize_game_state(&game);
     }
+    game.level = start_level;
 }
 
-void draw_spider() {
-    int baseOffset = WIN_BORDER;
-    uint32_t spider_pixels_rotated[SPIDER_WIDTH * SPIDER_HEIGHT]; // Ensure this buffer is large enough for rotated dimensions
-    
-    int sprite_w_orig = SPIDER_WIDTH;
-    int sprite_h_orig = SPIDER_HEIGHT;
-    int sprite_w_eff = sprite_w_orig;
-    int sprite_h_eff = sprite_h_orig;
-
-    if (spider_vx > 0) { // Right
-        rotate_pixels(spider_pixels, spider_pixels_rotated, sprite_w_orig, sprite_h_orig, 90);
-        sprite_w_eff = sprite_h_orig; sprite_h_eff = sprite_w_orig;
-    } else if (spider_vx < 0) { // Left
-        rotate_pixels(spider_pixels, spider_pixels_rotated, sprite_w_orig, sprite_h_orig, 270);
-        sprite_w_eff = sprite_h_orig; sprite_h_eff = sprite_w_orig;
-    } else if (spider_vy > 0) { // Down
-        rotate_pixels(spider_pixels, spider_pixels_rotated, sprite_w_orig, sprite_h_orig, 180);
-    } else { // Up or stationary (default orientation)
-        rotate_pixels(spider_pixels, spider_pixels_rotated, sprite_w_orig, sprite_h_orig, 0);
-    }
-
-    int draw_x = spider_x - sprite_w_eff / 2 + EDGE_SIZE;
-    int draw_y = spider_y - sprite_h_eff / 2 + EDGE_SIZE;
-    draw_bitmap(spider_pixels_rotated, baseOffset + draw_x, baseOffset + draw_y, sprite_w_eff, sprite_h_eff);
+static void mark_scaler_tile(void* ctx, int x, int y, int w, int h) {
+    scaler_mark_dirty(ctx, x, y, w, h);
 }
 
-bool is_spider_on_cross_section() {
-    bool on_cross_section_x = (spider_x % (CELL_SIZE + EDGE_SIZE)) == 0;
-    bool on_cross_section_y = (spider_y % (CELL_SIZE + EDGE_SIZE)) == 0;
-    return on_cross_section_x && on_cross_section_y;
+// Draws the frame for g and scales what changed; false if nothing did
+bool compose_frame(const Game* g, ScalerRect* changed) {
+    TRACE_ZONE_BEGIN(zone, "compose");
+    update_counters(g);
+    render_frame(g);
+    if (frame_stats.enabled && platform_atomic_load(&show_frame_stats)) {
+        frame_stats_draw(&frame_stats, WIN_BORDER + EDGE_SIZE + 4, WIN_BORDER + EDGE_SIZE + 4);
+    }
+    // Same tiles as the scaler's, so it need not compare again
+    frame_stats_add_tiles(&frame_stats, render_present(mark_scaler_tile, &scaler));
+    bool any = scaler_run(&scaler, pixels, changed) > 0;
+    TRACE_ZONE_END(zone);
+    return any;
 }
 
-// --- START: Movement and Path Logic Helper Functions ---
-bool is_edge_part_of_claimed_area(int gx, int gy, bool is_horizontal_edge) {
-    // gx, gy are grid coordinates of the top-left part of the edge or cell.
-    // For horizontal edge at (gx, gy), it's path_h[gx][gy].
-    // For vertical edge at (gx, gy), it's path_v[gx][gy].
-    if (is_horizontal_edge) {
-        if (gx < 0 || gx >= MAP_W_CELLS || gy < 0 || gy > MAP_H_CELLS) return false;
-        if (past_path_h[gx][gy]) return true;
-        if (gy > 0 && gy < MAP_H_CELLS) { // Edge is between cells
-            return claimed[gx][gy - 1] && claimed[gx][gy];
-        } else if (gy == 0 && gy < MAP_H_CELLS) { // Top border edge
-             return claimed[gx][gy];
-        } else if (gy == MAP_H_CELLS && gy > 0) { // Bottom border edge
-            return claimed[gx][gy-1];
-        }
-    } else { // Vertical edge
-        if (gx < 0 || gx > MAP_W_CELLS || gy < 0 || gy >= MAP_H_CELLS) return false;
-        if (past_path_v[gx][gy]) return true;
-        if (gx > 0 && gx < MAP_W_CELLS) { // Edge is between cells
-            return claimed[gx - 1][gy] && claimed[gx][gy];
-        } else if (gx == 0 && gx < MAP_W_CELLS) { // Left border edge
-            return claimed[gx][gy];
-        } else if (gx == MAP_W_CELLS && gx > 0) { // Right border edge
-            return claimed[gx-1][gy];
-        }
-    }
-    return false;
+// Copies r of the composed and scaled frame to the window, one row band, no stretching
+void present_rect(HWND hwnd, RECT r) {
+    if (r.left < 0) r.left = 0;
+    if (r.top < 0) r.top = 0;
+    if (r.right > scaler.out_w) r.right = scaler.out_w;
+    if (r.bottom > scaler.out_h) r.bottom = scaler.out_h;
+    if (r.right <= r.left || r.bottom <= r.top) return;
+    TRACE_ZONE_BEGIN(zone, "present");
+    BITMAPINFO bmi = {0};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = scaler.out_w;
+    bmi.bmiHeader.biHeight = -(r.bottom - r.top); // Top-down, starting at row r.top
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    HDC hdc = GetDC(hwnd);
+    StretchDIBits(hdc, r.left, r.top, r.right - r.left, r.bottom - r.top,
+                  r.left, 0, r.right - r.left, r.bottom - r.top,
+                  scaler.out + (size_t)r.top * scaler.out_w, &bmi, DIB_RGB_COLORS, SRCCOPY);
+    ReleaseDC(hwnd, hdc);
+    TRACE_COUNT(TRACE_COUNTER_BLITS, 1);
+    TRACE_ZONE_END(zone);
 }
 
-bool can_move_on_claimed_territory(int cvx, int cvy, int move_dir_x, int move_dir_y) {
-    // cvx, cvy: current spider vertex (grid coords)
-    // move_dir_x, move_dir_y: intended direction of movement (-1, 0, or 1 for grid steps)
-    if (move_dir_x == 1)  return is_edge_part_of_claimed_area(cvx, cvy, true);       // Right: H-edge at (cvx, cvy)
-    if (move_dir_x == -1) return is_edge_part_of_claimed_area(cvx - 1, cvy, true);   // Left:  H-edge at (cvx-1, cvy)
-    if (move_dir_y == 1)  return is_edge_part_of_claimed_area(cvx, cvy, false);      // Down:  V-edge at (cvx, cvy)
-    if (move_dir_y == -1) return is_edge_part_of_claimed_area(cvx, cvy - 1, false);  // Up:    V-edge at (cvx, cvy-1)
-    return false;
+// Largest scale whose window fits the work area, frame and title bar included
+int fit_window_scale() {
+    RECT work, frame = {0, 0, 0, 0};
+    if (!SystemParametersInfo(SPI_GETWORKAREA, 0, &work, 0)) return 1;
+    AdjustWindowRect(&frame, WS_OVERLAPPEDWINDOW, FALSE);
+    return scaler_fit_scale(win_w, win_h, (work.right - work.left) - (frame.right - frame.left),
+                            (work.bottom - work.top) - (frame.bottom - frame.top));
 }
 
-bool can_start_drawing_path(int cvx, int cvy, int move_dir_x, int move_dir_y) {
-    // Check if the cells adjacent to the new path segment are unclaimed.
-    if (move_dir_x == 1) { // Drawing H-Path right from (cvx,cvy) -> path_h[cvx][cvy]
-        bool above_ok = (cvy == 0) || (cvy > 0 && cvx < MAP_W_CELLS && !claimed[cvx][cvy - 1]);
-        bool below_ok = (cvy == MAP_H_CELLS) || (cvy < MAP_H_CELLS && cvx < MAP_W_CELLS && !claimed[cvx][cvy]);
-        return above_ok && below_ok;
-    } else if (move_dir_x == -1) { // Drawing H-Path left from (cvx,cvy) -> path_h[cvx-1][cvy]
-        bool above_ok = (cvy == 0) || (cvy > 0 && cvx > 0 && !claimed[cvx - 1][cvy - 1]);
-        bool below_ok = (cvy == MAP_H_CELLS) || (cvy < MAP_H_CELLS && cvx > 0 && !claimed[cvx - 1][cvy]);
-        return above_ok && below_ok;
-    } else if (move_dir_y == 1) { // Drawing V-Path down from (cvx,cvy) -> path_v[cvx][cvy]
-        bool left_ok = (cvx == 0) || (cvx > 0 && cvy < MAP_H_CELLS && !claimed[cvx - 1][cvy]);
-        bool right_ok = (cvx == MAP_W_CELLS) || (cvx < MAP_W_CELLS && cvy < MAP_H_CELLS && !claimed[cvx][cvy]);
-        return left_ok && right_ok;
-    } else if (move_dir_y == -1) { // Drawing V-Path up from (cvx,cvy) -> path_v[cvx][cvy-1]
-        bool left_ok = (cvx == 0) || (cvx > 0 && cvy > 0 && !claimed[cvx - 1][cvy - 1]);
-        bool right_ok = (cvx == MAP_W_CELLS) || (cvx < MAP_W_CELLS && cvy > 0 && !claimed[cvx][cvy - 1]);
-        return left_ok && right_ok;
+void update_game_title(HWND hwnd, int claimed_cells, int total_cells) {
+    char title[100];
+    float percentage_claimed = 0.0f;
+    if (total_cells > 0) {
+        percentage_claimed = (float)claimed_cells / total_cells * 100.0f;
     }
-    return false;
+    sprintf(title, "Mamba 1.0 - Claimed: %.2f%%", percentage_claimed);
+    SetWindowText(hwnd, title);
 }
 
-bool is_vertex_on_claimed_border(int vx, int vy) {
-    // Check past_path edges incident to vertex (vx,vy)
-    if (vx < MAP_W_CELLS && past_path_h[vx][vy]) return true;         // Edge to the right
-    if (vx > 0 && past_path_h[vx-1][vy]) return true;                 // Edge to the left
-    if (vy < MAP_H_CELLS && past_path_v[vx][vy]) return true;         // Edge below
-    if (vy > 0 && past_path_v[vx][vy-1]) return true;                 // Edge above
-
-    // Check if vertex is a corner of any claimed cell
-    if (vx < MAP_W_CELLS && vy < MAP_H_CELLS && claimed[vx][vy]) return true;         // Vertex is BR corner of cell (vx,vy)
-    if (vx > 0 && vy < MAP_H_CELLS && claimed[vx-1][vy]) return true;                 // Vertex is BL corner of cell (vx-1,vy)
-    if (vx < MAP_W_CELLS && vy > 0 && claimed[vx][vy-1]) return true;                 // Vertex is TR corner of cell (vx,vy-1)
-    if (vx > 0 && vy > 0 && claimed[vx-1][vy-1]) return true;                         // Vertex is TL corner of cell (vx-1,vy-1)
-    
-    return false;
+// --- START: Pipeline ---
+// Unlike FRAMEWNDPROC, which ticked, drew and painted in one timer message, the
+// game runs on three threads. The sim thread ticks `game` every TICK_MS and
+// publishes a copy of the board after each tick through a triple buffer; the
+// render thread composes the newest copy and copies what changed to the window;
+// the window thread only turns messages into requests for the other two. Neither
+// worker ever waits for the other: a slow compose skips ticks instead of
+// delaying them, and a long claim only delays the next snapshot while the render
+// thread keeps presenting the last one. Everything `game`, the input queue, the
+// mixer's command ring and the rewind buffer is the sim thread's; the frame,
+// scaler, counters and frame_stats are the render thread's.
+
+#define WM_APP_TITLE (WM_APP + 1) // From the render thread: claimed cells in wParam, of lParam
+
+// A board as of one tick; the writer's slot is the only one it ever changes
+typedef struct {
+    Game game;         // Copy of the state, for drawing only
+    uint64_t sim_ns;   // Time of the tick, without the claim in it
+    uint64_t claim_ns;
+} FrameSnapshot;
+
+FrameSnapshot snapshots[3];
+TripleBuffer snapshot_buffer;
+PlatformThread sim_thread, render_thread;
+PlatformEvent render_wake;  // A snapshot was published, a repaint is due, or the pipeline stops
+int pipeline_running;       // atomic
+int reset_requested;        // atomic; 'R'
+int sound_toggles;          // atomic; 'S' presses the sim thread has not seen yet
+int repaint_requested;      // atomic; WM_PAINT: the window lost what was on it
+
+// Copies `game` into the writer's slot and hands it to the render thread
+void publish_snapshot(uint64_t sim_ns, uint64_t claim_ns) {
+    FrameSnapshot* snapshot = &snapshots[snapshot_buffer.write];
+    game_copy(&snapshot->game, &game);
+    snapshot->sim_ns = sim_ns;
+    snapshot->claim_ns = claim_ns;
+    triple_buffer_publish(&snapshot_buffer);
+    platform_event_signal(&render_wake);
 }
 
-void clear_current_path_data() {
-    memset(path_h, 0, sizeof(path_h));
-    memset(path_v, 0, sizeof(path_v));
-    current_path_len = 0;
-}
-// --- END: Movement and Path Logic Helper Functions ---
-
-void update_spider() {
-    int current_grid_x = spider_x / (CELL_SIZE + EDGE_SIZE);
-    int current_grid_y = spider_y / (CELL_SIZE + EDGE_SIZE);
-
-    // Handle input intent if on a cross-section or 180-degree turn
-    if (input_vx_intent != 0 || input_vy_intent != 0) {
-        bool is_180_turn = (spider_vx == -input_vx_intent && input_vx_intent != 0) || 
-                           (spider_vy == -input_vy_intent && input_vy_intent != 0);
-
-        if (is_spider_on_cross_section() || is_180_turn) {
-            int intent_dir_x = (input_vx_intent > 0) ? 1 : ((input_vx_intent < 0) ? -1 : 0);
-            int intent_dir_y = (input_vy_intent > 0) ? 1 : ((input_vy_intent < 0) ? -1 : 0);
-
-            if (spider_state == SPIDER_IDLE_ON_CLAIMED || spider_state == SPIDER_MOVING_ON_CLAIMED) {
-                if (can_move_on_claimed_territory(current_grid_x, current_grid_y, intent_dir_x, intent_dir_y)) {
-                    spider_vx = input_vx_intent;
-                    spider_vy = input_vy_intent;
-                    spider_state = SPIDER_MOVING_ON_CLAIMED;
-                } else if (can_start_drawing_path(current_grid_x, current_grid_y, intent_dir_x, intent_dir_y)) {
-                    spider_vx = input_vx_intent;
-                    spider_vy = input_vy_intent;
-                    spider_state = SPIDER_DRAWING_PATH;
-                    path_start_vertex_x = current_grid_x;
-                    path_start_vertex_y = current_grid_y;
-                    clear_current_path_data();
-                    current_path_vertices[current_path_len++] = (Point){current_grid_x, current_grid_y};
-                } else { // Invalid move
-                    spider_vx = 0; spider_vy = 0; // Stop if previous move was valid but new one isn't
-                    if (spider_state == SPIDER_MOVING_ON_CLAIMED) spider_state = SPIDER_IDLE_ON_CLAIMED;
-                }
-            } else if (spider_state == SPIDER_DRAWING_PATH) {
-                // Allow direction change while drawing, unless it's into a wall not part of claim process
-                // For now, assume player manages not to hit walls directly unless completing path
-                spider_vx = input_vx_intent;
-                spider_vy = input_vy_intent;
-            }
-            input_vx_intent = 0; input_vy_intent = 0; // Consume intent
+void sim_thread_main(void* arg) {
+    HWND hwnd = arg;
+    uint64_t next_tick = platform_time_ns();
+    while (platform_atomic_load(&pipeline_running)) {
+        TRACE_ZONE_BEGIN(zone, "tick");
+        // Timed only while the stats are on; then each claim costs two more clock reads
+        bool timed = platform_atomic_load(&show_frame_stats) || frame_stats_logging;
+        game_claim_clock = timed ? platform_time_ns : NULL;
+        uint64_t start = timed ? platform_time_ns() : 0, claim_before = game_claim_ns;
+        if (platform_atomic_exchange(&reset_requested, 0)) {
+            new_game();
+            if (rewind_buffer) rewind_clear(rewind_buffer);
         }
-    }
-    
-    // Stop spider if no velocity (e.g. after failed move or at start)
-    if (spider_vx == 0 && spider_vy == 0 && spider_state == SPIDER_MOVING_ON_CLAIMED) {
-        spider_state = SPIDER_IDLE_ON_CLAIMED;
-    }
-
-
-    // Update spider position based on velocity
-    int new_x = spider_x + spider_vx;
-    int new_y = spider_y + spider_vy;
-
-    // Boundary checks
-    if (new_x > SPIDER_MAX_X) new_x = SPIDER_MAX_X;
-    if (new_x < 0) new_x = 0;
-    if (new_y > SPIDER_MAX_Y) new_y = SPIDER_MAX_Y;
-    if (new_y < 0) new_y = 0;
-
-    // If movement occurred
-    if (spider_x != new_x || spider_y != new_y) {
-         if (spider_state == SPIDER_IDLE_ON_CLAIMED && (spider_vx != 0 || spider_vy != 0) ) {
-            // This case should ideally be caught by input handling, if starting from idle.
-            // But if somehow missed, transition to moving.
-            spider_state = SPIDER_MOVING_ON_CLAIMED;
+        if (platform_atomic_exchange(&sound_toggles, 0) & 1) {
+            sound_enabled = !sound_enabled;
+            if (!sound_enabled) mixer_stop_all(&audio_mixer);
         }
-    }
-    spider_x = new_x;
-    spider_y = new_y;
-
-
-    if (is_spider_on_cross_section()) {
-        int next_grid_x = spider_x / (CELL_SIZE + EDGE_SIZE);
-        int next_grid_y = spider_y / (CELL_SIZE + EDGE_SIZE);
-
-        if (last_vertex_x != next_grid_x || last_vertex_y != next_grid_y) { // Moved to a new vertex
-            if (spider_state == SPIDER_DRAWING_PATH) {
-                bool self_intersect = false;
-                // Add current vertex to path list and check for self-intersection
-                for(int i=0; i < current_path_len -1; ++i) { // -1 to not check against immediate predecessor
-                    if(current_path_vertices[i].x == next_grid_x && current_path_vertices[i].y == next_grid_y) {
-                        self_intersect = true;
-                        break;
-                    }
-                }
-                if (current_path_len < sizeof(current_path_vertices)/sizeof(Point)) {
-                     current_path_vertices[current_path_len++] = (Point){next_grid_x, next_grid_y};
-                }
-
-
-                // Mark the edge in current path_h/path_v
-                // Edge from (last_vertex_x, last_vertex_y) to (next_grid_x, next_grid_y)
-                if (next_grid_x > last_vertex_x) path_h[last_vertex_x][next_grid_y] = true; // Moved right
-                else if (next_grid_x < last_vertex_x) path_h[next_grid_x][next_grid_y] = true; // Moved left
-                else if (next_grid_y > last_vertex_y) path_v[next_grid_x][last_vertex_y] = true; // Moved down
-                else if (next_grid_y < last_vertex_y) path_v[next_grid_x][next_grid_y] = true; // Moved up
-                
-                bool returned_to_claimed = is_vertex_on_claimed_border(next_grid_x, next_grid_y);
-
-                if (self_intersect || returned_to_claimed) {
-                    attempt_claim_territory();
-                }
-            }
-            last_vertex_x = next_grid_x;
-            last_vertex_y = next_grid_y;
+        // GetKeyState only knows the window thread's keys
+        bool back_held = GetForegroundWindow() == hwnd && GetAsyncKeyState(VK_BACK) < 0;
+        if (rewind_buffer && back_held && rewind_count(rewind_buffer) > 1) {
+            // Twice as fast as the game ran; let go to play on from here
+            rewind_step_back(rewind_buffer, rewind_count(rewind_buffer) > 2 ? 2 : 1, &game);
+        } else {
+            input_queue_feed(&input_queue, &game);
+            game_tick(&game);
+            input_queue_after_tick(&input_queue, &game);
+            if (rewind_buffer) rewind_push(rewind_buffer, &game);
         }
+        uint64_t claim_ns = game_claim_ns - claim_before;
+        publish_snapshot(timed ? platform_time_ns() - start - claim_ns : 0, claim_ns);
+        TRACE_ZONE_END(zone);
+        TRACE_TICK();
+
+        // On the tick grid; after a stall of more than a tick, start a new grid rather than catch up in a burst
+        next_tick += TICK_MS * 1000000ull;
+        uint64_t now = platform_time_ns();
+        if (now > next_tick + TICK_MS * 1000000ull) next_tick = now;
+        if (next_tick > now) platform_sleep_ms((int)((next_tick - now + 999999) / 1000000));
     }
 }
 
-// --- START: Territory Claiming Logic ---
-bool can_flood_fill_pass(int cx, int cy, int ncx, int ncy) {
-    // Check if moving from (cx,cy) to (ncx,ncy) crosses a path line
-    if (ncx == cx + 1) { // Moving right
-        return !(path_v[cx + 1][cy] || past_path_v[cx + 1][cy]);
-    } else if (ncx == cx - 1) { // Moving left
-        return !(path_v[cx][cy] || past_path_v[cx][cy]);
-    } else if (ncy == cy + 1) { // Moving down
-        return !(path_h[cx][cy + 1] || past_path_h[cx][cy + 1]);
-    } else if (ncy == cy - 1) { // Moving up
-        return !(path_h[cx][cy] || past_path_h[cx][cy]);
-    }
-    return true; // Should not happen for cardinal moves
-}
-
-void flood_fill_region(int start_x, int start_y, Region* region, bool visited_map[MAP_W_CELLS][MAP_H_CELLS]) {
-    init_queue();
-    region->count = 0;
-    region->is_adjacent_to_claimed_territory = false;
-
-    if (start_x < 0 || start_x >= MAP_W_CELLS || start_y < 0 || start_y >= MAP_H_CELLS) return;
-    if (claimed[start_x][start_y] || visited_map[start_x][start_y]) return;
-
-    enqueue((Point){start_x, start_y});
-    visited_map[start_x][start_y] = true;
-
-    while (!is_queue_empty()) {
-        Point p = dequeue();
-        if (region->count < MAP_W_CELLS * MAP_H_CELLS) {
-            region->cells[region->count++] = p;
+void render_thread_main(void* arg) {
+    HWND hwnd = arg;
+    int titled_cells = -1;
+    while (platform_atomic_load(&pipeline_running)) {
+        platform_event_wait(&render_wake, 250);
+        bool repaint = platform_atomic_exchange(&repaint_requested, 0) != 0;
+        if (!triple_buffer_acquire(&snapshot_buffer)) {
+            // Nothing new to draw; the window may still need what it has
+            if (repaint) present_rect(hwnd, (RECT){0, 0, scaler.out_w, scaler.out_h});
+            continue;
         }
-
-        int dx[] = {0, 0, 1, -1};
-        int dy[] = {1, -1, 0, 0};
-
-        for (int i = 0; i < 4; i++) {
-            int nx = p.x + dx[i];
-            int ny = p.y + dy[i];
-
-            if (nx >= 0 && nx < MAP_W_CELLS && ny >= 0 && ny < MAP_H_CELLS &&
-                !claimed[nx][ny] && !visited_map[nx][ny]) {
-                if (can_flood_fill_pass(p.x, p.y, nx, ny)) {
-                    visited_map[nx][ny] = true;
-                    enqueue((Point){nx, ny});
-                }
-            }
+        const Game* g = &snapshots[snapshot_buffer.read].game;
+        bool stats_wanted = platform_atomic_load(&show_frame_stats) || frame_stats.csv;
+        if (stats_wanted != frame_stats.enabled) frame_stats_enable(&frame_stats, stats_wanted);
+
+        frame_stats_begin_frame(&frame_stats);
+        frame_stats_add(&frame_stats, FRAME_PHASE_SIM, snapshots[snapshot_buffer.read].sim_ns);
+        frame_stats_add(&frame_stats, FRAME_PHASE_CLAIM, snapshots[snapshot_buffer.read].claim_ns);
+        frame_stats_begin(&frame_stats, FRAME_PHASE_COMPOSE);
+        ScalerRect changed;
+        bool any = compose_frame(g, &changed);
+        frame_stats_end(&frame_stats, FRAME_PHASE_COMPOSE);
+        frame_stats_begin(&frame_stats, FRAME_PHASE_PRESENT);
+        if (repaint) {
+            present_rect(hwnd, (RECT){0, 0, scaler.out_w, scaler.out_h});
+        } else if (any) {
+            present_rect(hwnd, (RECT){changed.x, changed.y, changed.x + changed.w, changed.y + changed.h});
         }
-    }
-}
-
-bool check_region_adjacency(Region* region, int num_pre_existing_claimed_cells) {
-    for (int i = 0; i < region->count; i++) {
-        Point p = region->cells[i]; // A cell in the potential new region
-
-        // Check adjacency to previously claimed cells (sharing edge or corner)
-        for (int dy_adj = -1; dy_adj <= 1; dy_adj++) {
-            for (int dx_adj = -1; dx_adj <= 1; dx_adj++) {
-                if (dx_adj == 0 && dy_adj == 0) continue;
-
-                int nx_adj = p.x + dx_adj;
-                int ny_adj = p.y + dy_adj;
+        frame_stats_end(&frame_stats, FRAME_PHASE_PRESENT);
 
-                if (nx_adj >= 0 && nx_adj < MAP_W_CELLS && ny_adj >= 0 && ny_adj < MAP_H_CELLS) {
-                    if (claimed[nx_adj][ny_adj]) { // This cell was claimed in a *previous* operation
-                        return true;
-                    }
-                }
-            }
-        }
-        
-        // If no cells were claimed before this operation, check adjacency to initial border
-        if (num_pre_existing_claimed_cells == 0) {
-            if (p.x == 0 && past_path_v[0][p.y]) return true; // Left border
-            if (p.x == MAP_W_CELLS - 1 && past_path_v[MAP_W_CELLS][p.y]) return true; // Right border
-            if (p.y == 0 && past_path_h[p.x][0]) return true; // Top border
-            if (p.y == MAP_H_CELLS - 1 && past_path_h[p.x][MAP_H_CELLS]) return true; // Bottom border
+        // SetWindowText waits for the window thread, so it gets the title by message
+        if (g->claimed_cell_count != titled_cells) {
+            titled_cells = g->claimed_cell_count;
+            PostMessage(hwnd, WM_APP_TITLE, (WPARAM)g->claimed_cell_count, (LPARAM)g->total_cells);
         }
     }
-    return false;
 }
 
-
-void attempt_claim_territory() {
-    Region found_regions[10]; // Assume max 10 distinct regions formed, adjust if needed
-    int found_region_count = 0;
-    bool overall_visited_cells[MAP_W_CELLS][MAP_H_CELLS];
-    memset(overall_visited_cells, 0, sizeof(overall_visited_cells));
-
-    int pre_existing_claims = 0;
-    for(int r=0; r<MAP_H_CELLS; ++r) for(int c=0; c<MAP_W_CELLS; ++c) if(claimed[c][r]) pre_existing_claims++;
-
-    for (int y = 0; y < MAP_H_CELLS; y++) {
-        for (int x = 0; x < MAP_W_CELLS; x++) {
-            if (!claimed[x][y] && !overall_visited_cells[x][y] && found_region_count < 10) {
-                flood_fill_region(x, y, &found_regions[found_region_count], overall_visited_cells);
-                if (found_regions[found_region_count].count > 0) {
-                    found_regions[found_region_count].is_adjacent_to_claimed_territory = 
-                        check_region_adjacency(&found_regions[found_region_count], pre_existing_claims);
-                    found_region_count++;
-                }
-            }
-        }
-    }
-
-    Region* best_region_to_claim = NULL;
-    int min_size = total_cells + 1;
-
-    for (int i = 0; i < found_region_count; i++) {
-        if (found_regions[i].is_adjacent_to_claimed_territory) {
-            if (found_regions[i].count < min_size) {
-                min_size = found_regions[i].count;
-                best_region_to_claim = &found_regions[i];
-            }
-        }
+// Starts a game and both threads for it. False if out of memory.
+bool pipeline_start(HWND hwnd) {
+    for (int i = 0; i < 3; i++) {
+        if (!game_init(&snapshots[i].game, game.w, game.h, game.snake_capacity)) return false;
     }
-
-    if (best_region_to_claim != NULL) {
-        for (int i = 0; i < best_region_to_claim->count; i++) {
-            Point p = best_region_to_claim->cells[i];
-            if (!claimed[p.x][p.y]) { // Double check not already claimed
-                 claimed[p.x][p.y] = true;
-                 claimed_cell_count++;
-            }
-        }
-        // Merge current path into past_path
-        for (int y_path = 0; y_path <= MAP_H_CELLS; y_path++) {
-            for (int x_path = 0; x_path < MAP_W_CELLS; x_path++) {
-                if (path_h[x_path][y_path]) past_path_h[x_path][y_path] = true;
-            }
-        }
-        for (int y_path = 0; y_path < MAP_H_CELLS; y_path++) {
-            for (int x_path = 0; x_path <= MAP_W_CELLS; x_path++) {
-                if (path_v[x_path][y_path]) past_path_v[x_path][y_path] = true;
-            }
-        }
-        clear_current_path_data();
-        spider_state = SPIDER_IDLE_ON_CLAIMED; // Or MOVING if auto-move along new border
-        spider_vx = 0; spider_vy = 0; // Stop for now
-    } else {
-        // No valid region claimed, reset path
-        clear_current_path_data();
-        spider_x = path_start_vertex_x * (CELL_SIZE + EDGE_SIZE);
-        spider_y = path_start_vertex_y * (CELL_SIZE + EDGE_SIZE);
-        last_vertex_x = path_start_vertex_x;
-        last_vertex_y = path_start_vertex_y;
-        spider_vx = 0; spider_vy = 0;
-        spider_state = SPIDER_IDLE_ON_CLAIMED;
+    if (!platform_event_init(&render_wake)) return false;
+    triple_buffer_init(&snapshot_buffer);
+    new_game();
+    publish_snapshot(0, 0); // Something to draw before the first tick
+    timeBeginPeriod(1); // Sleep to the millisecond, so ticks stay on TICK_MS
+
+    pipeline_running = 1;
+    bool started = platform_thread_start(&sim_thread, sim_thread_main, hwnd);
+    if (started && !platform_thread_start(&render_thread, render_thread_main, hwnd)) {
+        platform_atomic_store(&pipeline_running, 0);
+        platform_thread_join(&sim_thread);
+        started = false;
     }
+    if (!started) timeEndPeriod(1);
+    return started;
 }
-// --- END: Territory Claiming Logic ---
 
-void update_game_title(HWND hwnd) {
-    char title[100];
-    float percentage_claimed = 0.0f;
-    if (total_cells > 0) {
-        percentage_claimed = (float)claimed_cell_count / total_cells * 100.0f;
-    }
-    sprintf(title, "Mamba 1.0 - Claimed: %.2f%%", percentage_claimed);
-    SetWindowText(hwnd, title);
+void pipeline_stop() {
+    if (!platform_atomic_exchange(&pipeline_running, 0)) return;
+    platform_event_signal(&render_wake);
+    platform_thread_join(&sim_thread);
+    platform_thread_join(&render_thread);
+    timeEndPeriod(1);
 }
 
-
-void initialize_game_state() {
-    memset(claimed, 0, sizeof(claimed));
-    memset(past_path_h, 0, sizeof(past_path_h));
-    memset(past_path_v, 0, sizeof(past_path_v));
-    clear_current_path_data(); // Clears path_h, path_v, current_path_len
-
-    // Set up initial border as past_path
-    for (int x = 0; x < MAP_W_CELLS; x++) {
-        past_path_h[x][0] = true;             // Top border
-        past_path_h[x][MAP_H_CELLS] = true;   // Bottom border
-    }
-    for (int y = 0; y < MAP_H_CELLS; y++) {
-        past_path_v[0][y] = true;             // Left border
-        past_path_v[MAP_W_CELLS][y] = true;   // Right border
-    }
-
-    spider_x = 0; // Top-left vertex in pixels
-    spider_y = 0;
-    spider_vx = 0; 
-    spider_vy = 0;
-    input_vx_intent = 0;
-    input_vy_intent = 0;
-
-    last_vertex_x = 0; // Grid coordinates
-    last_vertex_y = 0;
-    
-    spider_state = SPIDER_IDLE_ON_CLAIMED;
-    claimed_cell_count = 0;
-    // path_start_vertex will be set when drawing starts
+void pipeline_free() {
+    for (int i = 0; i < 3; i++) game_free(&snapshots[i].game);
+    platform_event_free(&render_wake);
 }
+// --- END: Pipeline ---
 
 
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
-        case WM_CREATE:
-            initialize_game_state();
-            SetTimer(hwnd, 1, 32, NULL); // ~30 FPS for easier debugging, adjust to 16 for ~60FPS
-            return 0;
-
         case WM_KEYDOWN:
+            if (input_thread.running && (wParam == VK_LEFT || wParam == VK_RIGHT || wParam == VK_UP ||
+                                         wParam == VK_DOWN || wParam == VK_SPACE)) {
+                return 0;
+            }
             switch (wParam) {
                 // Using pixel velocity directly for intent
-                case VK_LEFT:  input_vx_intent = -1; input_vy_intent = 0; break;
-                case VK_RIGHT: input_vx_intent = 1;  input_vy_intent = 0; break;
-                case VK_UP:    input_vx_intent = 0;  input_vy_intent = -1; break;
-                case VK_DOWN:  input_vx_intent = 0;  input_vy_intent = 1; break;
+                case VK_LEFT:  input_queue_push_direction(&input_queue, -1, 0); break;
+                case VK_RIGHT: input_queue_push_direction(&input_queue, 1, 0); break;
+                case VK_UP:    input_queue_push_direction(&input_queue, 0, -1); break;
+                case VK_DOWN:  input_queue_push_direction(&input_queue, 0, 1); break;
                 case VK_SPACE: 
-                    spider_vx = 0; spider_vy = 0; 
-                    input_vx_intent = 0; input_vy_intent = 0; 
-                    if(spider_state == SPIDER_MOVING_ON_CLAIMED) spider_state = SPIDER_IDLE_ON_CLAIMED;
-                    // If drawing path and space is hit, Qix rules might mean death or path cancel.
-                    // For now, it just stops.
-                    if(spider_state == SPIDER_DRAWING_PATH) {
-                        // Cancel path drawing
-                        clear_current_path_data();
-                        spider_x = path_start_vertex_x * (CELL_SIZE + EDGE_SIZE);
-                        spider_y = path_start_vertex_y * (CELL_SIZE + EDGE_SIZE);
-                        last_vertex_x = path_start_vertex_x;
-                        last_vertex_y = path_start_vertex_y;
-                        spider_state = SPIDER_IDLE_ON_CLAIMED;
-                    }
+                    input_queue_push_stop(&input_queue);
                     break;
                 case 'R': // Reset key
-                    initialize_game_state();
+                    platform_atomic_store(&reset_requested, 1);
+                    break;
+                case 'S': // Sound on/off, remembered in mamba.ini
+                    platform_atomic_add(&sound_toggles, 1);
+                    break;
+                case 'F': // Frame timing overlay
+                    platform_atomic_store(&show_frame_stats, !show_frame_stats);
                     break;
             }
             return 0;
 
-        case WM_TIMER:
-            update_spider();
-            update_game_title(hwnd); // Update title with percentage
-            InvalidateRect(hwnd, NULL, FALSE);
+        case WM_APP_TITLE:
+            update_game_title(hwnd, (int)wParam, (int)lParam);
             return 0;
 
         case WM_PAINT: {
+            // The render thread draws; it copies the whole frame again the next time it wakes
             PAINTSTRUCT ps;
-            HDC hdc = BeginPaint(hwnd, &ps);
-
-            clear_screen(color_light_gray); 
-
-            // Map background in cyan (unclaimed areas default)
-            draw_rect(WIN_BORDER + EDGE_SIZE, WIN_BORDER + EDGE_SIZE, MAP_W_PIXELS, MAP_H_PIXELS, color_cyan);
-            
-            draw_cells();         // Draw claimed cell interiors (light gray)
-            draw_paths(false);    // Draw past paths (black)
-            draw_paths(true);     // Draw current path (white)
-            draw_spider();
-
-            // Outer border of the map area
-            // Top
-            draw_rect(WIN_BORDER, WIN_BORDER, MAP_W_PIXELS_INCL_EDGE, EDGE_SIZE, color_black);
-            // Bottom
-            draw_rect(WIN_BORDER, WIN_BORDER + MAP_H_PIXELS_INCL_EDGE - EDGE_SIZE, MAP_W_PIXELS_INCL_EDGE, EDGE_SIZE, color_black);
-            // Left
-            draw_rect(WIN_BORDER, WIN_BORDER + EDGE_SIZE, EDGE_SIZE, MAP_H_PIXELS, color_black);
-            // Right
-            draw_rect(WIN_BORDER + MAP_W_PIXELS_INCL_EDGE - EDGE_SIZE, WIN_BORDER + EDGE_SIZE, EDGE_SIZE, MAP_H_PIXELS, color_black);
-
-
-            BITMAPINFO bmi = {0};
-            bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-            bmi.bmiHeader.biWidth = WIN_W;
-            bmi.bmiHeader.biHeight = -WIN_H; 
-            bmi.bmiHeader.biPlanes = 1;
-            bmi.bmiHeader.biBitCount = 32;
-            bmi.bmiHeader.biCompression = BI_RGB;
-
-            StretchDIBits(hdc, 0, 0, WIN_W, WIN_H, 0, 0, WIN_W, WIN_H, pixels, &bmi, DIB_RGB_COLORS, SRCCOPY);
+            BeginPaint(hwnd, &ps);
             EndPaint(hwnd, &ps);
+            platform_atomic_store(&repaint_requested, 1);
+            platform_event_signal(&render_wake);
             return 0;
         }
 
         case WM_DESTROY:
-            KillTimer(hwnd, 1);
+            pipeline_stop();
+            save_preferences();
             PostQuitMessage(0);
             return 0;
     }
@@ -716,6 +397,72 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
                    LPSTR lpCmdLine, int nCmdShow) {
     FILE* fDummy;
+
+    TRACE_INIT();
+
+    // One map for all assets; fall back to the embedded sprite if the pack is missing
+    if (asset_pack_open(&asset_pack, "mamba.pak")) {
+        const uint32_t* packed_spider = asset_pack_image(&asset_pack, "spider", SPIDER_WIDTH, SPIDER_HEIGHT);
+        if (packed_spider) spider_sprite = packed_spider;
+    } else {
+        debug_printf("mamba.pak not found, using embedded assets\n");
+    }
+
+    load_preferences();
+    input_queue_init(&input_queue);
+    game_sound_handler = play_sound;
+    frame_stats_init(&frame_stats, TICK_MS * 1000000ull);
+    if (frame_stats_csv[0]) {
+        frame_stats_logging = frame_stats_open_csv(&frame_stats, frame_stats_csv);
+        if (!frame_stats_logging) debug_printf_fmt("Cannot create %s\n", frame_stats_csv);
+    }
+    status_bar_h = STATUS_BAR_H;
+    if (!game_init(&game, board_w, board_h, 0) || !render_init(&game)) {
+        debug_printf("Out of memory for the board\n");
+        return 1;
+    }
+    int scale = window_scale > 0 ? window_scale : fit_window_scale();
+    if (!scaler_init(&scaler, win_w, win_h, scale, smooth_scaling ? SCALER_SMOOTH : SCALER_NEAREST, 0)) {
+        debug_printf("Out of memory for the scaled frame\n");
+        return 1;
+    }
+    scaler.marked_only = true;
+    counter_set_glyphs(asset_pack_image(&asset_pack, "digits", COUNTER_GLYPH_COUNT * COUNTER_DIGIT_W, COUNTER_DIGIT_H));
+    int counter_y = win_h - status_bar_h + (status_bar_h - COUNTER_DIGIT_H) / 2;
+    int cell_digits = 1;
+    for (int n = game.total_cells; n >= 10; n /= 10) cell_digits++;
+    counter_init(&cells_counter, WIN_BORDER, counter_y, cell_digits);
+    counter_init(&percent_counter, win_w - WIN_BORDER - 3 * COUNTER_DIGIT_W, counter_y, 3);
+    // A tick costs about 60 bytes, so each MB holds some ten minutes; without it the game just cannot rewind
+    if (rewind_mb > 0) rewind_buffer = rewind_create(&game, (size_t)rewind_mb << 20, 0);
+
+    // Decode every effect up front; the original beeped for a few when the sound DLL was missing
+    mixer_init(&audio_mixer);
+    for (int id = SOUND_ID_FIRST; id < SOUND_ID_FIRST + SOUND_ID_COUNT; id++) {
+        char name[ASSET_NAME_MAX];
+        snprintf(name, sizeof(name), "sound_%02x", id);
+        const AssetPackEntry* e = asset_pack_find(&asset_pack, name);
+        bool loaded = e && e->kind == ASSET_WAVE &&
+                      mixer_load_wave(&audio_mixer, (SoundId)id, asset_pack_data(&asset_pack, e), e->size);
+        if (!loaded && (id == SOUND_SPIDER_DIED || id == SOUND_GAME_OVER || id == SOUND_DIALOG)) {
+            mixer_load_beep(&audio_mixer, (SoundId)id);
+        }
+    }
+    if (!mixer_start(&audio_mixer, MIXER_OUTPUT_DEVICE, NULL)) {
+        debug_printf("No audio device, sound disabled\n");
+    }
+
+    // Start decoding the background picture right away; the window comes up without waiting for it
+    if (lpCmdLine && lpCmdLine[0]) {
+        char picture_path[MAX_PATH];
+        const char* src = lpCmdLine[0] == '"' ? lpCmdLine + 1 : lpCmdLine;
+        snprintf(picture_path, sizeof(picture_path), "%s", src);
+        char* quote = strchr(picture_path, '"');
+        if (quote) *quote = '\0';
+        if (!bmp_stream_open(&background_picture, picture_path)) {
+            debug_printf_fmt("Cannot load background picture %s\n", picture_path);
+        }
+    }
     
     WNDCLASS wc = {0};
     wc.lpfnWndProc = WndProc;
@@ -726,7 +473,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
     RegisterClass(&wc);
 
     // Adjust window size slightly for borders and title bar
-    RECT wr = {0, 0, WIN_W, WIN_H};
+    RECT wr = {0, 0, scaler.out_w, scaler.out_h};
     AdjustWindowRect(&wr, WS_OVERLAPPEDWINDOW, FALSE);
 
     HWND hwnd = CreateWindow("MambaClass", "Mamba 1.0", WS_OVERLAPPEDWINDOW,
@@ -734,6 +481,14 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
                              wr.right - wr.left, wr.bottom - wr.top, // Use adjusted size
                              NULL, NULL, hInstance, NULL);
 
+    if (!input_thread_start(&input_thread, &input_queue, hwnd, NULL)) {
+        debug_printf("No raw input, reading keys from the window\n");
+    }
+
+    if (!pipeline_start(hwnd)) {
+        debug_printf("Cannot start the game threads\n");
+        return 1;
+    }
     ShowWindow(hwnd, nCmdShow);
     UpdateWindow(hwnd);
 
@@ -742,6 +497,23 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
         TranslateMessage(&msg);
         DispatchMessage(&msg);
     }
-    
+
+    input_thread_stop(&input_thread);
+    debug_printf_fmt("Input-to-motion: %u turns, p50 %.0f ms, p99 %.0f ms, max %.1f ms\n",
+                     input_queue.latency.count, input_latency_percentile_ms(&input_queue.latency, 0.5),
+                     input_latency_percentile_ms(&input_queue.latency, 0.99), input_queue.latency.max_ns * 1e-6);
+
+    // Open in chrome://tracing; nothing is written unless built with -DMAMBA_TRACE
+    TRACE_WRITE("mamba_trace.json");
+    frame_stats_close(&frame_stats);
+
+    pipeline_free();
+    mixer_free(&audio_mixer);
+    rewind_destroy(rewind_buffer);
+    scaler_free(&scaler);
+    render_free();
+    game_free(&game);
+    bmp_stream_close(&background_picture);
+    asset_pack_close(&asset_pack);
     return 0;
 }
\ No newline at end of file
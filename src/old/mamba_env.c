@@ -0,0 +1,215 @@
+#include "mamba_env.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "game.h"
+#include "render.h"
+#include "snake.h"
+
+struct MambaEnv {
+    MambaEnvConfig config;
+    int count;
+    Game* games;
+    void* memory;        // Game blocks, `stride` apart from `blocks`
+    uint8_t* blocks;
+    size_t stride;
+    int32_t* scalars;    // count * MAMBA_ENV_SCALARS
+    int32_t* episodes;
+    uint32_t* frames;    // count * frame_w * frame_h, or NULL
+    int frame_w, frame_h;
+    bool renders;        // Holds one of render_users
+};
+
+// Envs holding render.c's global frame, and the board size it was made for;
+// the last one out frees it
+static int render_users;
+static int render_board_w, render_board_h;
+
+static bool render_acquire(const Game* g) {
+    if (render_users > 0) {
+        if (g->w != render_board_w || g->h != render_board_h) return false;
+    } else {
+        if (!render_init(g)) return false;
+        render_board_w = g->w;
+        render_board_h = g->h;
+    }
+    render_users++;
+    return true;
+}
+
+static void render_release(void) {
+    if (--render_users == 0) render_free();
+}
+
+void mamba_env_default_config(MambaEnvConfig* config) {
+    memset(config, 0, sizeof(*config));
+    config->board_w = GAME_DEFAULT_W;
+    config->board_h = GAME_DEFAULT_H;
+    config->snakes = 1;
+    config->level = 1;
+    config->lives = 3;
+    config->max_ticks = 100000;
+    config->ticks_per_step = CELL_PITCH;
+    config->render = 0;
+    config->death_penalty = 0.1f;
+    config->seed = 1;
+}
+
+static void write_scalars(MambaEnv* env, int i) {
+    const Game* g = &env->games[i];
+    int32_t* s = env->scalars + (size_t)i * MAMBA_ENV_SCALARS;
+    s[MAMBA_SCALAR_SPIDER_X] = g->spider_x;
+    s[MAMBA_SCALAR_SPIDER_Y] = g->spider_y;
+    s[MAMBA_SCALAR_SPIDER_STATE] = g->spider_state;
+    s[MAMBA_SCALAR_CLAIMED_CELLS] = g->claimed_cell_count;
+    s[MAMBA_SCALAR_DEATHS] = g->deaths;
+    s[MAMBA_SCALAR_TICK] = (int32_t)g->tick;
+    s[MAMBA_SCALAR_SNAKES_ALIVE] = snakes_alive(g);
+    s[MAMBA_SCALAR_EPISODE] = env->episodes[i];
+}
+
+static void reset_game(MambaEnv* env, int i) {
+    Game* g = &env->games[i];
+    initialize_game_state(g);
+    // Every (game, episode) pair gets its own stream
+    game_seed(g, env->config.seed * 0x100000001B3ull ^ ((uint64_t)i << 32) ^ (uint64_t)env->episodes[i]);
+    g->level = env->config.level;
+    snakes_spawn(g, env->config.snakes);
+    write_scalars(env, i);
+}
+
+MambaEnv* mamba_env_create(const MambaEnvConfig* config, int count) {
+    if (count < 1) return NULL;
+    MambaEnv* env = calloc(1, sizeof(MambaEnv));
+    if (!env) return NULL;
+    env->config = *config;
+    if (env->config.ticks_per_step < 1) env->config.ticks_per_step = 1;
+    if (env->config.lives < 1) env->config.lives = 1;
+    env->count = count;
+
+    env->stride = game_block_size(config->board_w, config->board_h, config->snakes);
+    env->memory = malloc(64 + env->stride * (size_t)count);
+    env->games = calloc((size_t)count, sizeof(Game));
+    env->scalars = calloc((size_t)count * MAMBA_ENV_SCALARS, sizeof(int32_t));
+    env->episodes = calloc((size_t)count, sizeof(int32_t));
+    if (!env->memory || !env->games || !env->scalars || !env->episodes) {
+        mamba_env_destroy(env);
+        return NULL;
+    }
+    env->blocks = (uint8_t*)(((uintptr_t)env->memory + 63) & ~(uintptr_t)63);
+    for (int i = 0; i < count; i++) {
+        game_init_in(&env->games[i], config->board_w, config->board_h, config->snakes,
+                     env->blocks + (size_t)i * env->stride);
+    }
+
+    if (config->render) {
+        // The renderer's frame globals only depend on the board size, shared by all games and envs
+        if (!render_acquire(&env->games[0])) {
+            mamba_env_destroy(env);
+            return NULL;
+        }
+        env->renders = true;
+        env->frame_w = win_w;
+        env->frame_h = win_h;
+        env->frames = calloc((size_t)count * (size_t)win_w * (size_t)win_h, sizeof(uint32_t));
+        if (!env->frames) {
+            mamba_env_destroy(env);
+            return NULL;
+        }
+    }
+    mamba_env_reset(env, -1);
+    return env;
+}
+
+void mamba_env_destroy(MambaEnv* env) {
+    if (!env) return;
+    if (env->renders) render_release();
+    free(env->frames);
+    free(env->episodes);
+    free(env->scalars);
+    free(env->games);
+    free(env->memory);
+    free(env);
+}
+
+void mamba_env_reset(MambaEnv* env, int index) {
+    if (index >= 0 && index < env->count) {
+        reset_game(env, index);
+        return;
+    }
+    for (int i = 0; i < env->count; i++) reset_game(env, i);
+}
+
+static const int action_dx[4] = { 0, 1, 0, -1 };
+static const int action_dy[4] = { -1, 0, 1, 0 };
+
+void mamba_env_step(MambaEnv* env, const int8_t* actions, float* rewards, uint8_t* dones) {
+    const MambaEnvConfig* c = &env->config;
+    for (int i = 0; i < env->count; i++) {
+        Game* g = &env->games[i];
+        int action = actions ? actions[i] : MAMBA_ACTION_NONE;
+        if (action >= 0 && action < 4) {
+            g->input_vx_intent = action_dx[action];
+            g->input_vy_intent = action_dy[action];
+        } else if (action == MAMBA_ACTION_STOP) {
+            game_stop_spider(g);
+        }
+
+        int claimed = g->claimed_cell_count, deaths = g->deaths;
+        bool done = false;
+        for (int t = 0; t < c->ticks_per_step && !done; t++) {
+            game_tick(g);
+            done = game_is_won(g) || g->deaths >= c->lives || g->tick >= (uint32_t)c->max_ticks;
+        }
+        rewards[i] = (float)(g->claimed_cell_count - claimed) / (float)g->total_cells -
+                     c->death_penalty * (float)(g->deaths - deaths);
+        dones[i] = done;
+        if (done) {
+            env->episodes[i]++;
+            reset_game(env, i);
+        } else {
+            write_scalars(env, i);
+        }
+    }
+}
+
+void mamba_env_render(MambaEnv* env) {
+    if (!env->frames) return;
+    size_t frame_pixels = (size_t)env->frame_w * (size_t)env->frame_h;
+    for (int i = 0; i < env->count; i++) {
+        render_frame(&env->games[i]);
+        render_expand(env->frames + (size_t)i * frame_pixels);
+    }
+}
+
+const uint8_t* mamba_env_plane(const MambaEnv* env, int plane) {
+    const Game* g = &env->games[0];
+    switch (plane) {
+        case MAMBA_PLANE_CLAIMED:     return g->claimed;
+        case MAMBA_PLANE_PAST_PATH_H: return g->past_path_h;
+        case MAMBA_PLANE_PAST_PATH_V: return g->past_path_v;
+        case MAMBA_PLANE_PATH_H:      return g->path_h;
+        case MAMBA_PLANE_PATH_V:      return g->path_v;
+        case MAMBA_PLANE_SNAKES:      return g->snake_cells;
+        default:                      return NULL;
+    }
+}
+
+size_t mamba_env_stride(const MambaEnv* env) {
+    return env->stride;
+}
+
+const int32_t* mamba_env_scalars(const MambaEnv* env) {
+    return env->scalars;
+}
+
+const uint32_t* mamba_env_frames(const MambaEnv* env, int* frame_w, int* frame_h) {
+    if (frame_w) *frame_w = env->frame_w;
+    if (frame_h) *frame_h = env->frame_h;
+    return env->frames;
+}
+
+void mamba_env_board_size(const MambaEnv* env, int* w, int* h) {
+    *w = env->games[0].w;
+    *h = env->games[0].h;
+}
@@ -0,0 +1,91 @@
+#ifndef MAMBA_ENV_H
+#define MAMBA_ENV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// C ABI around the headless game for agents (see mamba_env.py), built as a shared
+// library: mamba_env.dll / libmamba_env.so.
+//
+// One MambaEnv holds `count` games of the same configuration. Their Game blocks
+// sit in a single allocation at a fixed stride, and their frames and scalars in
+// flat arrays, so the caller can map each plane for all games as one strided
+// array without copying. Those arrays change in place on every step/reset/render.
+//
+// mamba_env_step applies one action per game, runs ticks_per_step ticks, and
+// resets every game that finished (so the views then show its next episode).
+// Rendering envs in one process share the renderer's global frame (render.h),
+// kept until the last of them is destroyed, so they must share a board size:
+// creating one for another size fails.
+
+#ifdef _WIN32
+#define MAMBA_ENV_API __declspec(dllexport)
+#else
+#define MAMBA_ENV_API __attribute__((visibility("default")))
+#endif
+
+typedef struct MambaEnv MambaEnv;
+
+typedef struct {
+    int32_t board_w, board_h;
+    int32_t snakes;
+    int32_t level;
+    int32_t lives;          // Episode ends after this many hits
+    int32_t max_ticks;      // ... or after this many ticks
+    int32_t ticks_per_step; // 12 moves the spider one cell
+    int32_t render;         // Keep a frame per game for mamba_env_render
+    float death_penalty;    // Subtracted from the reward per hit
+    uint64_t seed;
+} MambaEnvConfig;
+
+// Actions
+#define MAMBA_ACTION_NONE -1
+// 0..3 turn up/right/down/left (SnakeDir order)
+#define MAMBA_ACTION_STOP 4
+
+// Planes of Game, each w/h sized as in game.h
+typedef enum {
+    MAMBA_PLANE_CLAIMED,     // h x w
+    MAMBA_PLANE_PAST_PATH_H, // (h + 1) x w
+    MAMBA_PLANE_PAST_PATH_V, // h x (w + 1)
+    MAMBA_PLANE_PATH_H,      // (h + 1) x w
+    MAMBA_PLANE_PATH_V,      // h x (w + 1)
+    MAMBA_PLANE_SNAKES,      // h x w, snake segments per cell
+    MAMBA_PLANE_COUNT
+} MambaPlane;
+
+// Per-game int32 scalars, MAMBA_ENV_SCALARS per game
+enum {
+    MAMBA_SCALAR_SPIDER_X,
+    MAMBA_SCALAR_SPIDER_Y,
+    MAMBA_SCALAR_SPIDER_STATE,
+    MAMBA_SCALAR_CLAIMED_CELLS,
+    MAMBA_SCALAR_DEATHS,
+    MAMBA_SCALAR_TICK,
+    MAMBA_SCALAR_SNAKES_ALIVE,
+    MAMBA_SCALAR_EPISODE,
+    MAMBA_ENV_SCALARS
+};
+
+MAMBA_ENV_API void mamba_env_default_config(MambaEnvConfig* config);
+// NULL if out of memory
+MAMBA_ENV_API MambaEnv* mamba_env_create(const MambaEnvConfig* config, int count);
+MAMBA_ENV_API void mamba_env_destroy(MambaEnv* env);
+
+// Starts a new episode in game `index`, or in all games for -1
+MAMBA_ENV_API void mamba_env_reset(MambaEnv* env, int index);
+// actions: count int8; rewards/dones: count each, written
+MAMBA_ENV_API void mamba_env_step(MambaEnv* env, const int8_t* actions, float* rewards, uint8_t* dones);
+// Draws every game into its frame (needs config.render)
+MAMBA_ENV_API void mamba_env_render(MambaEnv* env);
+
+// Views: game i's plane is at mamba_env_plane(env, p) + i * mamba_env_stride(env)
+MAMBA_ENV_API const uint8_t* mamba_env_plane(const MambaEnv* env, int plane);
+MAMBA_ENV_API size_t mamba_env_stride(const MambaEnv* env);
+MAMBA_ENV_API const int32_t* mamba_env_scalars(const MambaEnv* env);
+// count frames of frame_w x frame_h 0x00RRGGBB pixels, NULL without config.render
+MAMBA_ENV_API const uint32_t* mamba_env_frames(const MambaEnv* env, int* frame_w, int* frame_h);
+// The clamped board size actually used
+MAMBA_ENV_API void mamba_env_board_size(const MambaEnv* env, int* w, int* h);
+
+#endif // MAMBA_ENV_H
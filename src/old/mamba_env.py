@@ -0,0 +1,214 @@
+"""Vectorized Mamba environments for agents, over the C ABI in mamba_env.h.
+
+    env = MambaVecEnv(num_envs=64, snakes=2, level=3)
+    obs = env.reset()
+    obs, rewards, dones, info = env.step(actions)   # actions: int8[num_envs]
+
+Observations are NumPy views straight into the games' memory, one array per
+plane with the game index first (claimed is num_envs x h x w, and so on); they
+are read-only and change in place on every step, so copy what must be kept.
+Actions are -1 (nothing), 0..3 (up, right, down, left) or 4 (stop, dropping the
+path). A step runs ticks_per_step game ticks (12 = one cell) for every game in
+one call; finished games start their next episode right away.
+
+The library is looked up in $MAMBA_ENV_LIB, then next to this file and in the
+current directory (mamba_env.dll, libmamba_env.so):
+
+    gcc -O2 -shared -fPIC -o libmamba_env.so mamba_env.c game.c snake.c render.c \\
+        bmp_stream.c bmp.c platform.c spider_bmp.c trace.c -lpthread
+"""
+
+import ctypes
+import os
+import sys
+
+import numpy as np
+
+ACTION_NONE = -1
+ACTION_UP, ACTION_RIGHT, ACTION_DOWN, ACTION_LEFT = 0, 1, 2, 3
+ACTION_STOP = 4
+
+# MambaPlane and the scalar indices in mamba_env.h
+_PLANES = ("claimed", "past_path_h", "past_path_v", "path_h", "path_v", "snakes")
+SCALARS = ("spider_x", "spider_y", "spider_state", "claimed_cells", "deaths", "tick",
+           "snakes_alive", "episode")
+
+
+class MambaEnvConfig(ctypes.Structure):
+    _fields_ = [
+        ("board_w", ctypes.c_int32),
+        ("board_h", ctypes.c_int32),
+        ("snakes", ctypes.c_int32),
+        ("level", ctypes.c_int32),
+        ("lives", ctypes.c_int32),
+        ("max_ticks", ctypes.c_int32),
+        ("ticks_per_step", ctypes.c_int32),
+        ("render", ctypes.c_int32),
+        ("death_penalty", ctypes.c_float),
+        ("seed", ctypes.c_uint64),
+    ]
+
+
+def _load_library():
+    names = ["mamba_env.dll"] if sys.platform == "win32" else ["libmamba_env.so", "mamba_env.so"]
+    candidates = []
+    if os.environ.get("MAMBA_ENV_LIB"):
+        candidates.append(os.environ["MAMBA_ENV_LIB"])
+    for directory in (os.path.dirname(os.path.abspath(__file__)), os.getcwd()):
+        candidates += [os.path.join(directory, name) for name in names]
+    for path in candidates:
+        if os.path.exists(path):
+            break
+    else:
+        raise OSError("mamba_env library not found, tried: " + ", ".join(candidates))
+
+    lib = ctypes.CDLL(path)
+    env_p = ctypes.c_void_p
+    lib.mamba_env_default_config.argtypes = [ctypes.POINTER(MambaEnvConfig)]
+    lib.mamba_env_default_config.restype = None
+    lib.mamba_env_create.argtypes = [ctypes.POINTER(MambaEnvConfig), ctypes.c_int]
+    lib.mamba_env_create.restype = env_p
+    lib.mamba_env_destroy.argtypes = [env_p]
+    lib.mamba_env_destroy.restype = None
+    lib.mamba_env_reset.argtypes = [env_p, ctypes.c_int]
+    lib.mamba_env_reset.restype = None
+    lib.mamba_env_step.argtypes = [env_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+    lib.mamba_env_step.restype = None
+    lib.mamba_env_render.argtypes = [env_p]
+    lib.mamba_env_render.restype = None
+    lib.mamba_env_plane.argtypes = [env_p, ctypes.c_int]
+    lib.mamba_env_plane.restype = ctypes.c_void_p
+    lib.mamba_env_stride.argtypes = [env_p]
+    lib.mamba_env_stride.restype = ctypes.c_size_t
+    lib.mamba_env_scalars.argtypes = [env_p]
+    lib.mamba_env_scalars.restype = ctypes.c_void_p
+    lib.mamba_env_frames.argtypes = [env_p, ctypes.POINTER(ctypes.c_int), ctypes.POINTER(ctypes.c_int)]
+    lib.mamba_env_frames.restype = ctypes.c_void_p
+    lib.mamba_env_board_size.argtypes = [env_p, ctypes.POINTER(ctypes.c_int), ctypes.POINTER(ctypes.c_int)]
+    lib.mamba_env_board_size.restype = None
+    return lib
+
+
+_lib = None
+
+
+def _view(address, dtype, size, shape, strides):
+    """Read-only array over `size` elements of C memory, without copying."""
+    buffer = (ctypes.c_uint8 * (size * np.dtype(dtype).itemsize)).from_address(address)
+    flat = np.frombuffer(buffer, dtype=dtype)
+    view = np.lib.stride_tricks.as_strided(flat, shape=shape, strides=strides)
+    view.flags.writeable = False
+    return view
+
+
+class MambaVecEnv:
+    def __init__(self, num_envs=1, board=(35, 29), snakes=1, level=1, lives=3, max_ticks=100000,
+                 ticks_per_step=12, render=False, death_penalty=0.1, seed=1):
+        global _lib
+        if _lib is None:
+            _lib = _load_library()
+        config = MambaEnvConfig()
+        _lib.mamba_env_default_config(ctypes.byref(config))
+        config.board_w, config.board_h = board
+        config.snakes = snakes
+        config.level = level
+        config.lives = lives
+        config.max_ticks = max_ticks
+        config.ticks_per_step = ticks_per_step
+        config.render = 1 if render else 0
+        config.death_penalty = death_penalty
+        config.seed = seed
+        self._env = _lib.mamba_env_create(ctypes.byref(config), num_envs)
+        if not self._env:
+            raise MemoryError("cannot create %d Mamba environments" % num_envs)
+
+        self.num_envs = num_envs
+        w, h = ctypes.c_int(), ctypes.c_int()
+        _lib.mamba_env_board_size(self._env, ctypes.byref(w), ctypes.byref(h))
+        self.board = (w.value, h.value)
+        self._actions = np.full(num_envs, ACTION_NONE, dtype=np.int8)
+        self._rewards = np.zeros(num_envs, dtype=np.float32)
+        self._dones = np.zeros(num_envs, dtype=np.uint8)
+        self.observation = self._map_observation(w.value, h.value, render)
+
+    def _map_observation(self, w, h, render):
+        n = self.num_envs
+        stride = _lib.mamba_env_stride(self._env)
+        shapes = {
+            "claimed": (h, w), "past_path_h": (h + 1, w), "past_path_v": (h, w + 1),
+            "path_h": (h + 1, w), "path_v": (h, w + 1), "snakes": (h, w),
+        }
+        obs = {}
+        for plane, name in enumerate(_PLANES):
+            rows, cols = shapes[name]
+            address = _lib.mamba_env_plane(self._env, plane)
+            obs[name] = _view(address, np.uint8, (n - 1) * stride + rows * cols,
+                              (n, rows, cols), (stride, cols, 1))
+        obs["scalars"] = _view(_lib.mamba_env_scalars(self._env), np.int32, n * len(SCALARS),
+                               (n, len(SCALARS)), (4 * len(SCALARS), 4))
+        if render:
+            fw, fh = ctypes.c_int(), ctypes.c_int()
+            address = _lib.mamba_env_frames(self._env, ctypes.byref(fw), ctypes.byref(fh))
+            obs["pixels"] = _view(address, np.uint32, n * fw.value * fh.value,
+                                  (n, fh.value, fw.value), (4 * fw.value * fh.value, 4 * fw.value, 4))
+        return obs
+
+    def reset(self, index=-1):
+        _lib.mamba_env_reset(self._env, index)
+        return self.observation
+
+    def step(self, actions=None):
+        if actions is None:
+            actions_p = None
+        else:
+            actions = np.ascontiguousarray(actions, dtype=np.int8)
+            if actions.shape != (self.num_envs,):
+                raise ValueError("expected %d actions" % self.num_envs)
+            actions_p = actions.ctypes.data
+        _lib.mamba_env_step(self._env, actions_p, self._rewards.ctypes.data, self._dones.ctypes.data)
+        return self.observation, self._rewards, self._dones.view(np.bool_), {}
+
+    def render(self):
+        """Draws every game into observation["pixels"] (needs render=True)."""
+        _lib.mamba_env_render(self._env)
+        return self.observation.get("pixels")
+
+    def close(self):
+        if self._env:
+            _lib.mamba_env_destroy(self._env)
+            self._env = None
+            self.observation = {}
+
+    def __del__(self):
+        self.close()
+
+
+if __name__ == "__main__":
+    # Random-agent throughput: how many game ticks per second get through the bindings
+    import argparse
+    import time
+
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--envs", type=int, default=64)
+    parser.add_argument("--steps", type=int, default=2000)
+    parser.add_argument("--ticks-per-step", type=int, default=1)
+    parser.add_argument("--render", action="store_true")
+    args = parser.parse_args()
+
+    env = MambaVecEnv(num_envs=args.envs, ticks_per_step=args.ticks_per_step, render=args.render)
+    env.reset()
+    rng = np.random.default_rng(1)
+    actions = rng.integers(-1, 4, size=(args.steps, args.envs), dtype=np.int8)
+    episodes = 0
+    start = time.perf_counter()
+    for step in range(args.steps):
+        obs, rewards, dones, _ = env.step(actions[step])
+        episodes += int(dones.sum())
+        if args.render:
+            env.render()
+    seconds = time.perf_counter() - start
+    ticks = args.steps * args.envs * args.ticks_per_step
+    print("%d envs x %d steps: %.3f s, %.0f steps/s, %.2f M ticks/s, %.2f us per env-step, %d episodes done"
+          % (args.envs, args.steps, seconds, args.steps / seconds, ticks / seconds * 1e-6,
+             seconds / (args.steps * args.envs) * 1e6, episodes))
+    env.close()
@@ -0,0 +1,132 @@
+// Offline tool: builds mamba.pak from BMP/DIB and WAV files.
+//
+//   pack_assets <out.pak> [name=path ...]
+//
+// Images (.bmp, or bare DIBs such as src/resource_chunk.bin) are decoded and
+// converted to 32-bit here, so the game never decodes at startup. .wav files are
+// stored as-is. The spider sprite from spider_bmp.c is always packed as "spider"
+// unless a file with that name is given. levels=file compiles a level file
+// (level.h) into one "level_nnn" asset per level, baked for the board it names.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "asset_pack.h"
+#include "bmp.h"
+#include "game.h"
+#include "level.h"
+#include "platform.h"
+#include "spider_bmp.h"
+
+static bool ends_with(const char* s, const char* suffix) {
+    size_t ls = strlen(s), lx = strlen(suffix);
+    if (ls < lx) return false;
+    for (size_t i = 0; i < lx; i++) {
+        char c = s[ls - lx + i];
+        if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+        if (c != suffix[i]) return false;
+    }
+    return true;
+}
+
+static bool add_file(AssetPackWriter* w, const char* name, const char* path) {
+    MappedFile mf;
+    if (!platform_map_file(path, &mf)) {
+        fprintf(stderr, "pack_assets: cannot open %s\n", path);
+        return false;
+    }
+
+    bool ok;
+    if (ends_with(path, ".wav")) {
+        ok = asset_pack_writer_add(w, name, ASSET_WAVE, 0, 0, mf.data, (uint32_t)mf.size);
+    } else {
+        BmpInfo info;
+        uint32_t* pixels = NULL;
+        ok = bmp_parse_header(mf.data, mf.size, &info);
+        if (ok) {
+            pixels = malloc((size_t)info.width * info.height * sizeof(uint32_t));
+            ok = pixels && bmp_decode(mf.data, mf.size, &info, pixels);
+        }
+        if (ok) {
+            ok = asset_pack_writer_add(w, name, ASSET_IMAGE, (uint32_t)info.width, (uint32_t)info.height,
+                                       pixels, (uint32_t)((size_t)info.width * info.height * sizeof(uint32_t)));
+        } else {
+            fprintf(stderr, "pack_assets: %s is not a supported BMP/DIB\n", path);
+        }
+        free(pixels);
+    }
+
+    platform_unmap_file(&mf);
+    return ok;
+}
+
+static bool add_levels(AssetPackWriter* w, const char* path) {
+    LevelSet set;
+    char error[128];
+    if (!level_set_load(&set, path, error, sizeof(error))) {
+        fprintf(stderr, "pack_assets: %s: %s\n", path, error);
+        return false;
+    }
+    bool ok = true;
+    for (int i = 0; i < set.count && ok; i++) {
+        const LevelDef* def = &set.levels[i];
+        Game g;
+        if (!game_init(&g, def->board_w, def->board_h, 0)) {
+            ok = false;
+            break;
+        }
+        level_apply(&g, def);
+        size_t size = level_baked_size(&g);
+        void* baked = malloc(size);
+        char name[ASSET_NAME_MAX];
+        level_asset_name(def->number, name, sizeof(name));
+        ok = baked != NULL;
+        if (ok) {
+            level_bake(&g, baked);
+            ok = asset_pack_writer_add(w, name, ASSET_BLOB, 0, 0, baked, (uint32_t)size);
+        }
+        free(baked);
+        game_free(&g);
+    }
+    if (!ok) fprintf(stderr, "pack_assets: out of memory compiling %s\n", path);
+    else printf("pack_assets: compiled %d levels from %s\n", set.count, path);
+    level_set_free(&set);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    // No options; --help or a mistyped one would otherwise become the output file
+    if (argc < 2 || argv[1][0] == '-') {
+        fprintf(stderr, "usage: pack_assets <out.pak> [name=path ...]\n");
+        return 1;
+    }
+
+    AssetPackWriter w;
+    asset_pack_writer_init(&w);
+    asset_pack_writer_add(&w, "spider", ASSET_IMAGE, SPIDER_WIDTH, SPIDER_HEIGHT,
+                          spider_pixels, sizeof(spider_pixels));
+
+    int status = 0;
+    for (int i = 2; i < argc && status == 0; i++) {
+        char name[ASSET_NAME_MAX];
+        const char* eq = strchr(argv[i], '=');
+        if (!eq || eq == argv[i] || (size_t)(eq - argv[i]) >= sizeof(name)) {
+            fprintf(stderr, "pack_assets: expected name=path, got %s\n", argv[i]);
+            status = 1;
+            break;
+        }
+        memcpy(name, argv[i], (size_t)(eq - argv[i]));
+        name[eq - argv[i]] = '\0';
+        bool added = strcmp(name, "levels") == 0 ? add_levels(&w, eq + 1) : add_file(&w, name, eq + 1);
+        if (!added) status = 1;
+    }
+
+    if (status == 0 && !asset_pack_writer_save(&w, argv[1])) {
+        fprintf(stderr, "pack_assets: cannot write %s\n", argv[1]);
+        status = 1;
+    }
+    if (status == 0) printf("pack_assets: wrote %d assets to %s\n", w.count, argv[1]);
+
+    asset_pack_writer_free(&w);
+    return status;
+}
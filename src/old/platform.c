@@ -0,0 +1,312 @@
+#include "platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// --- START: Memory-mapped files ---
+#ifdef _WIN32
+
+bool platform_map_file(const char* path, MappedFile* out) {
+    memset(out, 0, sizeof(*out));
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (map == NULL) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL) {
+        CloseHandle(map);
+        CloseHandle(file);
+        return false;
+    }
+
+    out->data = (const uint8_t*)view;
+    out->size = (size_t)size.QuadPart;
+    out->file_handle = file;
+    out->map_handle = map;
+    return true;
+}
+
+void platform_prefetch(const MappedFile* mf, size_t offset, size_t length) {
+    // PrefetchVirtualMemory is Windows 8+ and not in tcc's headers; touching one byte
+    // per page from the worker is enough to get the read-ahead going.
+    volatile uint8_t sink = 0;
+    if (offset >= mf->size) return;
+    if (offset + length > mf->size) length = mf->size - offset;
+    for (size_t i = 0; i < length; i += 4096) sink ^= mf->data[offset + i];
+    (void)sink;
+}
+
+void platform_unmap_file(MappedFile* mf) {
+    if (mf->data) UnmapViewOfFile(mf->data);
+    if (mf->map_handle) CloseHandle((HANDLE)mf->map_handle);
+    if (mf->file_handle) CloseHandle((HANDLE)mf->file_handle);
+    memset(mf, 0, sizeof(*mf));
+}
+
+#else
+
+bool platform_map_file(const char* path, MappedFile* out) {
+    memset(out, 0, sizeof(*out));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    out->data = (const uint8_t*)view;
+    out->size = (size_t)st.st_size;
+    out->file_handle = (void*)(intptr_t)fd;
+    return true;
+}
+
+void platform_prefetch(const MappedFile* mf, size_t offset, size_t length) {
+    if (offset >= mf->size) return;
+    if (offset + length > mf->size) length = mf->size - offset;
+    size_t page = 4096;
+    size_t start = offset & ~(page - 1);
+    madvise((void*)(mf->data + start), length + (offset - start), MADV_WILLNEED);
+}
+
+void platform_unmap_file(MappedFile* mf) {
+    if (mf->data) munmap((void*)mf->data, mf->size);
+    if (mf->data) close((int)(intptr_t)mf->file_handle);
+    memset(mf, 0, sizeof(*mf));
+}
+
+#endif
+// --- END: Memory-mapped files ---
+
+bool platform_replace_file(const char* src, const char* dst) {
+#ifdef _WIN32
+    return MoveFileExA(src, dst, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(src, dst) == 0;
+#endif
+}
+
+// --- START: Time ---
+#ifdef _WIN32
+
+uint64_t platform_time_ns(void) {
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    // Split to avoid overflowing now * 1e9
+    uint64_t seconds = (uint64_t)now.QuadPart / (uint64_t)frequency.QuadPart;
+    uint64_t rest = (uint64_t)now.QuadPart % (uint64_t)frequency.QuadPart;
+    return seconds * 1000000000ull + rest * 1000000000ull / (uint64_t)frequency.QuadPart;
+}
+
+void platform_sleep_ms(int ms) {
+    Sleep((DWORD)ms);
+}
+
+#else
+
+uint64_t platform_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void platform_sleep_ms(int ms) {
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+#endif
+// --- END: Time ---
+
+// --- START: Threads ---
+typedef struct {
+    PlatformThreadFn fn;
+    void* arg;
+} ThreadStart;
+
+#ifdef _WIN32
+
+static DWORD WINAPI thread_trampoline(LPVOID param) {
+    ThreadStart start = *(ThreadStart*)param;
+    free(param);
+    start.fn(start.arg);
+    return 0;
+}
+
+bool platform_thread_start(PlatformThread* t, PlatformThreadFn fn, void* arg) {
+    ThreadStart* start = malloc(sizeof(ThreadStart));
+    if (!start) return false;
+    start->fn = fn;
+    start->arg = arg;
+    t->handle = CreateThread(NULL, 0, thread_trampoline, start, 0, NULL);
+    if (!t->handle) { free(start); return false; }
+    return true;
+}
+
+void platform_thread_join(PlatformThread* t) {
+    if (!t->handle) return;
+    WaitForSingleObject((HANDLE)t->handle, INFINITE);
+    CloseHandle((HANDLE)t->handle);
+    t->handle = NULL;
+}
+
+int platform_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+uint32_t platform_thread_id(void) {
+    return (uint32_t)GetCurrentThreadId();
+}
+
+bool platform_event_init(PlatformEvent* e) {
+    e->handle = CreateEventA(NULL, FALSE, FALSE, NULL);
+    return e->handle != NULL;
+}
+
+void platform_event_free(PlatformEvent* e) {
+    if (e->handle) CloseHandle((HANDLE)e->handle);
+    e->handle = NULL;
+}
+
+void platform_event_signal(PlatformEvent* e) {
+    SetEvent((HANDLE)e->handle);
+}
+
+bool platform_event_wait(PlatformEvent* e, int timeout_ms) {
+    return WaitForSingleObject((HANDLE)e->handle, (DWORD)timeout_ms) == WAIT_OBJECT_0;
+}
+
+#else
+
+static void* thread_trampoline(void* param) {
+    ThreadStart start = *(ThreadStart*)param;
+    free(param);
+    start.fn(start.arg);
+    return NULL;
+}
+
+bool platform_thread_start(PlatformThread* t, PlatformThreadFn fn, void* arg) {
+    ThreadStart* start = malloc(sizeof(ThreadStart));
+    pthread_t* thread = malloc(sizeof(pthread_t));
+    if (!start || !thread) { free(start); free(thread); return false; }
+    start->fn = fn;
+    start->arg = arg;
+    if (pthread_create(thread, NULL, thread_trampoline, start) != 0) {
+        free(start);
+        free(thread);
+        return false;
+    }
+    t->handle = thread;
+    return true;
+}
+
+void platform_thread_join(PlatformThread* t) {
+    if (!t->handle) return;
+    pthread_join(*(pthread_t*)t->handle, NULL);
+    free(t->handle);
+    t->handle = NULL;
+}
+
+int platform_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+uint32_t platform_thread_id(void) {
+    return (uint32_t)syscall(SYS_gettid);
+}
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond; // On CLOCK_MONOTONIC, so waits don't stretch when the wall clock is set
+    bool set;
+} EventState;
+
+bool platform_event_init(PlatformEvent* e) {
+    EventState* state = malloc(sizeof(EventState));
+    e->handle = state;
+    if (!state) return false;
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&state->mutex, NULL);
+    pthread_cond_init(&state->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    state->set = false;
+    return true;
+}
+
+void platform_event_free(PlatformEvent* e) {
+    EventState* state = e->handle;
+    if (!state) return;
+    pthread_cond_destroy(&state->cond);
+    pthread_mutex_destroy(&state->mutex);
+    free(state);
+    e->handle = NULL;
+}
+
+void platform_event_signal(PlatformEvent* e) {
+    EventState* state = e->handle;
+    pthread_mutex_lock(&state->mutex);
+    state->set = true;
+    pthread_cond_signal(&state->cond);
+    pthread_mutex_unlock(&state->mutex);
+}
+
+bool platform_event_wait(PlatformEvent* e, int timeout_ms) {
+    EventState* state = e->handle;
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_mutex_lock(&state->mutex);
+    while (!state->set && pthread_cond_timedwait(&state->cond, &state->mutex, &deadline) == 0) {}
+    bool signalled = state->set;
+    state->set = false;
+    pthread_mutex_unlock(&state->mutex);
+    return signalled;
+}
+
+#endif
+// --- END: Threads ---
@@ -0,0 +1,122 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Thin OS layer so the game modules don't have to #ifdef _WIN32 everywhere.
+
+// --- START: Memory-mapped files ---
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    void* file_handle; // HANDLE on Windows, (intptr_t)fd elsewhere
+    void* map_handle;  // HANDLE from CreateFileMapping, unused elsewhere
+} MappedFile;
+
+// Maps the whole file read-only. Returns false (and leaves *out zeroed) on failure.
+bool platform_map_file(const char* path, MappedFile* out);
+void platform_unmap_file(MappedFile* mf);
+// Hint that [offset, offset + length) of a mapping will be read soon, so the OS can
+// start paging it in while the caller is busy with the previous range.
+void platform_prefetch(const MappedFile* mf, size_t offset, size_t length);
+// --- END: Memory-mapped files ---
+
+// Atomically replaces dst with src (rename over an existing file).
+bool platform_replace_file(const char* src, const char* dst);
+
+// --- START: Time ---
+// Monotonic clock in nanoseconds, arbitrary epoch.
+uint64_t platform_time_ns(void);
+void platform_sleep_ms(int ms);
+// --- END: Time ---
+
+// --- START: Threads ---
+typedef void (*PlatformThreadFn)(void* arg);
+
+typedef struct {
+    void* handle;
+} PlatformThread;
+
+bool platform_thread_start(PlatformThread* t, PlatformThreadFn fn, void* arg);
+void platform_thread_join(PlatformThread* t);
+// Logical processors available to the process, at least 1.
+int platform_cpu_count(void);
+// OS id of the calling thread, unique among the threads alive in the process
+uint32_t platform_thread_id(void);
+
+// Auto-reset wake-up for a thread that would otherwise poll: a signal sets it,
+// the wait that sees it clears it, and signals while it is set are one signal.
+typedef struct {
+    void* handle; // Event HANDLE on Windows, mutex, condition and flag elsewhere
+} PlatformEvent;
+
+bool platform_event_init(PlatformEvent* e);
+void platform_event_free(PlatformEvent* e);
+void platform_event_signal(PlatformEvent* e);
+// Waits up to timeout_ms for a signal; false if none came
+bool platform_event_wait(PlatformEvent* e, int timeout_ms);
+// --- END: Threads ---
+
+// --- START: Atomics ---
+// Sequentially consistent int/pointer access for flags and counters shared between threads.
+// add and exchange take 32-bit ints; load and store anything up to a pointer or
+// uint64_t. platform_atomic_cas64 replaces *p (a uint64_t) with desired if it
+// still holds expected and returns whether it did.
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define platform_atomic_load(p) (_ReadWriteBarrier(), *(p))
+#define platform_atomic_store(p, v) do { _ReadWriteBarrier(); *(p) = (v); _ReadWriteBarrier(); } while (0)
+#define platform_atomic_add(p, v) (_InterlockedExchangeAdd((volatile long*)(p), (v)) + (v))
+#define platform_atomic_exchange(p, v) _InterlockedExchange((volatile long*)(p), (v))
+#define platform_atomic_cas64(p, expected, desired) \
+    (_InterlockedCompareExchange64((volatile long long*)(p), (long long)(desired), (long long)(expected)) == (long long)(expected))
+#elif defined(__TINYC__) || defined(PLATFORM_ATOMIC_ASM)
+// tcc (build.ps1) has no __atomic builtins, but it has GNU inline assembly:
+// x86-64 lock-prefixed instructions, which are full barriers. Define
+// PLATFORM_ATOMIC_ASM to build these with gcc or clang for checking.
+#if !defined(__x86_64__)
+#error "Atomics without __atomic builtins need x86-64"
+#endif
+static inline void platform_fence_(void) {
+    __asm__ __volatile__("mfence" ::: "memory");
+}
+static inline void platform_compiler_barrier_(void) {
+    __asm__ __volatile__("" ::: "memory");
+}
+static inline int platform_atomic_add_(volatile int* p, int v) {
+    int old = v;
+    __asm__ __volatile__("lock; xaddl %0, %1" : "+r"(old), "+m"(*p) : : "memory");
+    return old + v;
+}
+static inline int platform_atomic_exchange_(volatile int* p, int v) {
+    __asm__ __volatile__("xchgl %0, %1" : "+r"(v), "+m"(*p) : : "memory");
+    return v;
+}
+static inline bool platform_atomic_cas64_(volatile uint64_t* p, uint64_t expected, uint64_t desired) {
+    uint64_t previous = expected;
+    __asm__ __volatile__("lock; cmpxchgq %2, %1" : "+a"(previous), "+m"(*p) : "r"(desired) : "memory");
+    return previous == expected;
+}
+// Aligned loads and stores up to 8 bytes are atomic on x86-64; the fence after a
+// store keeps it from passing a later load, as sequential consistency needs
+#define platform_atomic_load(p) (platform_compiler_barrier_(), *(volatile __typeof__(*(p))*)(p))
+#define platform_atomic_store(p, v) do { platform_compiler_barrier_(); *(volatile __typeof__(*(p))*)(p) = (v); platform_fence_(); } while (0)
+#define platform_atomic_add(p, v) platform_atomic_add_((volatile int*)(p), (int)(v))
+#define platform_atomic_exchange(p, v) platform_atomic_exchange_((volatile int*)(p), (int)(v))
+#define platform_atomic_cas64(p, expected, desired) platform_atomic_cas64_((p), (expected), (desired))
+#else
+#define platform_atomic_load(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define platform_atomic_store(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define platform_atomic_add(p, v) __atomic_add_fetch((p), (v), __ATOMIC_SEQ_CST)
+// Stores v and returns what *p held before
+#define platform_atomic_exchange(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+static inline bool platform_atomic_cas64_(volatile uint64_t* p, uint64_t expected, uint64_t desired) {
+    return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+#define platform_atomic_cas64(p, expected, desired) platform_atomic_cas64_((p), (expected), (desired))
+#endif
+// --- END: Atomics ---
+
+#endif // PLATFORM_H
@@ -0,0 +1,221 @@
+#include "prefs.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "platform.h"
+
+static char* dup_range(const char* begin, const char* end) {
+    while (begin < end && isspace((unsigned char)*begin)) begin++;
+    while (end > begin && isspace((unsigned char)end[-1])) end--;
+    char* s = malloc((size_t)(end - begin) + 1);
+    if (!s) return NULL;
+    memcpy(s, begin, (size_t)(end - begin));
+    s[end - begin] = '\0';
+    return s;
+}
+
+static char* dup_string(const char* s) {
+    return dup_range(s, s + strlen(s));
+}
+
+// INI names are case-insensitive, as with GETPRIVATEPROFILESTRING
+static bool names_equal(const char* a, const char* b) {
+    for (; *a && *b; a++, b++) {
+        if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) return false;
+    }
+    return *a == *b;
+}
+
+static PrefLine* insert_line(Prefs* p, int index) {
+    if (p->count == p->capacity) {
+        int new_capacity = p->capacity ? p->capacity * 2 : 32;
+        PrefLine* lines = realloc(p->lines, (size_t)new_capacity * sizeof(PrefLine));
+        if (!lines) return NULL;
+        p->lines = lines;
+        p->capacity = new_capacity;
+    }
+    memmove(&p->lines[index + 1], &p->lines[index], (size_t)(p->count - index) * sizeof(PrefLine));
+    p->count++;
+    memset(&p->lines[index], 0, sizeof(PrefLine));
+    return &p->lines[index];
+}
+
+static PrefLine* find_key(const Prefs* p, const char* section, const char* key) {
+    for (int i = 0; i < p->count; i++) {
+        PrefLine* l = &p->lines[i];
+        if (l->type == PREF_LINE_KEY && names_equal(l->section, section) && names_equal(l->key, key)) return l;
+    }
+    return NULL;
+}
+
+// --- START: Load ---
+bool prefs_load(Prefs* p, const char* path) {
+    memset(p, 0, sizeof(*p));
+    p->path = dup_string(path);
+    if (!p->path) return false;
+
+    MappedFile mf;
+    if (!platform_map_file(path, &mf)) return true; // Nothing saved yet
+
+    const char* cursor = (const char*)mf.data;
+    const char* end = cursor + mf.size;
+    char* section = NULL;
+    bool ok = true;
+    while (ok && cursor < end) {
+        const char* line_end = memchr(cursor, '\n', (size_t)(end - cursor));
+        if (!line_end) line_end = end;
+        const char* content_end = (line_end > cursor && line_end[-1] == '\r') ? line_end - 1 : line_end;
+
+        PrefLine* l = insert_line(p, p->count);
+        if (!l) { ok = false; break; }
+
+        const char* s = cursor;
+        while (s < content_end && isspace((unsigned char)*s)) s++;
+        const char* eq = memchr(s, '=', (size_t)(content_end - s));
+        const char* close = memchr(s, ']', (size_t)(content_end - s));
+        if (s < content_end && *s == '[' && close) {
+            l->type = PREF_LINE_SECTION;
+            section = dup_range(s + 1, close);
+            l->section = section;
+            l->text = dup_range(cursor, content_end);
+        } else if (section && eq && *s != ';' && *s != '#') {
+            l->type = PREF_LINE_KEY;
+            l->section = section;
+            l->key = dup_range(s, eq);
+            l->text = dup_range(eq + 1, content_end);
+        } else {
+            l->type = PREF_LINE_OTHER;
+            l->section = section;
+            l->text = dup_range(cursor, content_end);
+        }
+        ok = l->text && (l->type != PREF_LINE_SECTION || l->section) && (l->type != PREF_LINE_KEY || l->key);
+        cursor = line_end + 1;
+    }
+
+    platform_unmap_file(&mf);
+    return ok;
+}
+
+void prefs_free(Prefs* p) {
+    for (int i = 0; i < p->count; i++) {
+        PrefLine* l = &p->lines[i];
+        if (l->type == PREF_LINE_SECTION) free(l->section); // Owned by its section line
+        free(l->key);
+        free(l->text);
+    }
+    free(p->lines);
+    free(p->path);
+    memset(p, 0, sizeof(*p));
+}
+// --- END: Load ---
+
+// --- START: Access ---
+int prefs_get_int(const Prefs* p, const char* section, const char* key, int default_value) {
+    const PrefLine* l = find_key(p, section, key);
+    if (!l) return default_value;
+    char* end;
+    long v = strtol(l->text, &end, 10);
+    return end == l->text ? default_value : (int)v;
+}
+
+const char* prefs_get_string(const Prefs* p, const char* section, const char* key, const char* default_value) {
+    const PrefLine* l = find_key(p, section, key);
+    return l ? l->text : default_value;
+}
+
+void prefs_set_string(Prefs* p, const char* section, const char* key, const char* value) {
+    PrefLine* l = find_key(p, section, key);
+    if (l) {
+        if (strcmp(l->text, value) == 0) return;
+        char* copy = dup_string(value);
+        if (!copy) return;
+        free(l->text);
+        l->text = copy;
+        p->dirty_keys++;
+        return;
+    }
+
+    // New key: append it after the last line of its section, creating the section if needed
+    int insert_at = -1;
+    char* section_name = NULL;
+    for (int i = 0; i < p->count; i++) {
+        if (p->lines[i].section && names_equal(p->lines[i].section, section)) {
+            section_name = p->lines[i].section;
+            insert_at = i + 1;
+        }
+    }
+    if (insert_at < 0) {
+        PrefLine* header = insert_line(p, p->count);
+        if (!header) return;
+        header->type = PREF_LINE_SECTION;
+        header->section = dup_string(section);
+        header->text = malloc(strlen(section) + 3);
+        if (!header->section || !header->text) return;
+        sprintf(header->text, "[%s]", section);
+        section_name = header->section;
+        insert_at = p->count;
+    }
+    // Keep trailing blank lines of the section after the new key
+    while (insert_at > 0 && p->lines[insert_at - 1].type == PREF_LINE_OTHER && p->lines[insert_at - 1].text[0] == '\0') {
+        insert_at--;
+    }
+
+    l = insert_line(p, insert_at);
+    if (!l) return;
+    l->type = PREF_LINE_KEY;
+    l->section = section_name;
+    l->key = dup_string(key);
+    l->text = dup_string(value);
+    p->dirty_keys++;
+}
+
+void prefs_set_int(Prefs* p, const char* section, const char* key, int value) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%d", value);
+    prefs_set_string(p, section, key, buffer);
+}
+
+bool prefs_is_dirty(const Prefs* p) {
+    return p->dirty_keys > 0;
+}
+// --- END: Access ---
+
+// --- START: Flush ---
+bool prefs_flush(Prefs* p) {
+    if (!prefs_is_dirty(p)) return true;
+
+    size_t path_len = strlen(p->path);
+    char* tmp_path = malloc(path_len + 5);
+    if (!tmp_path) return false;
+    memcpy(tmp_path, p->path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", 5);
+
+    // Build the whole file in memory so it goes out in one write
+    size_t size = 0;
+    for (int i = 0; i < p->count; i++) {
+        const PrefLine* l = &p->lines[i];
+        size += (l->key ? strlen(l->key) + 1 : 0) + strlen(l->text) + 2;
+    }
+    char* buffer = malloc(size + 1);
+    if (!buffer) { free(tmp_path); return false; }
+    char* out = buffer;
+    for (int i = 0; i < p->count; i++) {
+        const PrefLine* l = &p->lines[i];
+        if (l->type == PREF_LINE_KEY) out += sprintf(out, "%s=%s\r\n", l->key, l->text);
+        else out += sprintf(out, "%s\r\n", l->text);
+    }
+
+    FILE* f = fopen(tmp_path, "wb");
+    bool ok = f && fwrite(buffer, 1, (size_t)(out - buffer), f) == (size_t)(out - buffer);
+    if (f) ok = (fclose(f) == 0) && ok;
+    ok = ok && platform_replace_file(tmp_path, p->path);
+    if (!ok) remove(tmp_path);
+    if (ok) p->dirty_keys = 0;
+
+    free(buffer);
+    free(tmp_path);
+    return ok;
+}
+// --- END: Flush ---
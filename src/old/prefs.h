@@ -0,0 +1,52 @@
+#ifndef PREFS_H
+#define PREFS_H
+
+#include <stdbool.h>
+
+// INI-style preferences shared by the remake and the tools.
+//
+// The original (profile_preferences_load/_save in MAMBA_2.c) does one
+// GETPRIVATEPROFILEINT per key on load and one WRITEPRIVATEPROFILESTRING per
+// changed key on save, each rewriting the file. Here the file is read once into
+// memory, setters only mark changed keys dirty, and prefs_flush writes the whole
+// file once through a temp file + rename, so a crash never leaves it half written.
+// Comments, blank lines and unknown keys survive a round trip.
+
+typedef enum {
+    PREF_LINE_OTHER,   // Comment, blank or unparsable line, kept verbatim
+    PREF_LINE_SECTION,
+    PREF_LINE_KEY
+} PrefLineType;
+
+typedef struct {
+    PrefLineType type;
+    char* section; // Section this line belongs to (shared with the section line)
+    char* key;     // PREF_LINE_KEY only
+    char* text;    // Value for keys, raw text otherwise
+} PrefLine;
+
+typedef struct {
+    char* path;
+    PrefLine* lines;
+    int count;
+    int capacity;
+    int dirty_keys;
+} Prefs;
+
+// Missing files are fine and start out empty; only allocation failure returns false.
+bool prefs_load(Prefs* p, const char* path);
+void prefs_free(Prefs* p);
+
+int prefs_get_int(const Prefs* p, const char* section, const char* key, int default_value);
+// Returns default_value if missing; the pointer stays valid until the key is changed.
+const char* prefs_get_string(const Prefs* p, const char* section, const char* key, const char* default_value);
+
+// No-ops (and nothing becomes dirty) when the value is unchanged.
+void prefs_set_int(Prefs* p, const char* section, const char* key, int value);
+void prefs_set_string(Prefs* p, const char* section, const char* key, const char* value);
+
+bool prefs_is_dirty(const Prefs* p);
+// Writes the file once if anything changed.
+bool prefs_flush(Prefs* p);
+
+#endif // PREFS_H
@@ -0,0 +1,346 @@
+#include "render.h"
+
+#include <stdlib.h>
+#include <string.h> // For memset/memcpy
+#include "spider_bmp.h"
+#include "trace.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Colors; the first entries of the palette, in this order
+uint8_t color_black = 0;
+uint8_t color_white = 1;
+uint8_t color_cyan = 2;
+uint8_t color_light_gray = 3;
+uint8_t color_snake = 4;
+
+uint8_t* frame;
+uint32_t* pixels;
+int map_w_pixels, map_h_pixels;
+int win_w, win_h;
+int status_bar_h = 0;
+
+const uint32_t* spider_sprite = spider_pixels;
+
+BmpStream background_picture;
+
+// frame as last expanded, and whether the palette changed since
+static uint8_t* presented;
+static bool palette_changed;
+
+// spider_sprite as indices, one per direction: up, right, down, left
+static uint8_t spider_frames[4][SPIDER_WIDTH * SPIDER_HEIGHT];
+
+// --- START: Palette ---
+uint32_t palette[PALETTE_SIZE];
+static int palette_count; // Entries handed out so far, below PALETTE_TRANSPARENT
+
+static void palette_reset(void) {
+    memset(palette, 0, sizeof(palette));
+    palette[color_black] = 0x000000;
+    palette[color_white] = 0xFFFFFF;
+    palette[color_cyan] = 0xFFFF00; // Corrected: BGR, so Cyan is FFFF00
+    palette[color_light_gray] = 0xC0C0C0;
+    palette[color_snake] = 0x008000;
+    palette[PALETTE_PICTURE] = palette[color_cyan]; // Where the picture has no pixel yet
+    palette_count = 5;
+    palette_changed = true;
+}
+
+uint8_t palette_index(uint32_t rgb) {
+    rgb &= 0xFFFFFF;
+    for (int i = 0; i < palette_count; i++) {
+        if (palette[i] == rgb) return (uint8_t)i;
+    }
+    if (palette_count < PALETTE_TRANSPARENT) {
+        palette[palette_count] = rgb;
+        return (uint8_t)palette_count++;
+    }
+    int best = 0;
+    uint32_t best_distance = UINT32_MAX;
+    for (int i = 0; i < palette_count; i++) {
+        int dr = (int)(palette[i] >> 16 & 0xFF) - (int)(rgb >> 16 & 0xFF);
+        int dg = (int)(palette[i] >> 8 & 0xFF) - (int)(rgb >> 8 & 0xFF);
+        int db = (int)(palette[i] & 0xFF) - (int)(rgb & 0xFF);
+        uint32_t distance = (uint32_t)(dr * dr + dg * dg + db * db);
+        if (distance < best_distance) {
+            best_distance = distance;
+            best = i;
+        }
+    }
+    return (uint8_t)best;
+}
+
+void palette_set(uint8_t index, uint32_t rgb) {
+    if (palette[index] == (rgb & 0xFFFFFF)) return;
+    palette[index] = rgb & 0xFFFFFF;
+    palette_changed = true;
+}
+// --- END: Palette ---
+
+// Rotates the 32-bit sprite and maps its colors to the palette; 0xFF000000 is transparent
+static void index_spider(int angle, uint8_t* out) {
+    uint32_t rotated[SPIDER_WIDTH * SPIDER_HEIGHT];
+    rotate_pixels(spider_sprite, rotated, SPIDER_WIDTH, SPIDER_HEIGHT, angle);
+    for (int i = 0; i < SPIDER_WIDTH * SPIDER_HEIGHT; i++) {
+        out[i] = rotated[i] == 0xFF000000 ? PALETTE_TRANSPARENT : palette_index(rotated[i]);
+    }
+}
+
+bool render_init(const Game* g) {
+    map_w_pixels = g->w * CELL_PITCH - EDGE_SIZE;
+    map_h_pixels = g->h * CELL_PITCH - EDGE_SIZE;
+    win_w = map_w_pixels + 2 * EDGE_SIZE + 2 * WIN_BORDER;
+    win_h = map_h_pixels + 2 * EDGE_SIZE + 2 * WIN_BORDER + status_bar_h;
+    render_free();
+    size_t n = (size_t)win_w * (size_t)win_h;
+    frame = calloc(n, 1);
+    presented = calloc(n, 1);
+    pixels = calloc(n, sizeof(uint32_t));
+    if (!frame || !presented || !pixels) {
+        render_free();
+        return false;
+    }
+
+    // Indices handed out before (counter glyphs) stay valid when the frame is reallocated
+    if (palette_count == 0) palette_reset();
+    palette_changed = true;
+    for (int i = 0; i < 4; i++) index_spider(i * 90, spider_frames[i]);
+    // Counters only ever redraw their own cells, so the rest of the bar is filled once
+    draw_rect(0, win_h - status_bar_h, win_w, status_bar_h, color_light_gray);
+    return true;
+}
+
+void render_free() {
+    free(frame);
+    free(presented);
+    free(pixels);
+    frame = NULL;
+    presented = NULL;
+    pixels = NULL;
+}
+
+void clear_screen(uint8_t color) {
+    memset(frame, color, (size_t)win_w * (size_t)(win_h - status_bar_h));
+}
+
+void draw_rect(int x, int y, int w, int h, uint8_t color) {
+    TRACE_COUNT(TRACE_COUNTER_BLITS, 1);
+    int stride = win_w;
+    int x0 = x < 0 ? 0 : x, x1 = x + w > win_w ? win_w : x + w;
+    int y0 = y < 0 ? 0 : y, y1 = y + h > win_h ? win_h : y + h;
+    if (x0 >= x1) return;
+    for (int py = y0; py < y1; py++) {
+        memset(frame + (size_t)py * stride + x0, color, (size_t)(x1 - x0));
+    }
+}
+
+void draw_background_picture() {
+    int y_begin, y_end;
+    BmpStreamState state = bmp_stream_ready_rows(&background_picture, &y_begin, &y_end);
+    if (state != BMP_STREAM_LOADING && state != BMP_STREAM_DONE) return;
+
+    // Only the rows decoded so far; the rest stays cyan until the worker gets there.
+    // The frame just says "picture here", render_present looks the pixels up.
+    int w = background_picture.info.width < map_w_pixels ? background_picture.info.width : map_w_pixels;
+    if (y_end > map_h_pixels) y_end = map_h_pixels;
+    for (int y = y_begin; y < y_end; y++) {
+        memset(&frame[(WIN_BORDER + EDGE_SIZE + y) * win_w + WIN_BORDER + EDGE_SIZE], PALETTE_PICTURE, (size_t)w);
+    }
+}
+
+void draw_cells(const Game* g) {
+    TRACE_ZONE_BEGIN(zone, "draw_cells");
+    for (int y = 0; y < g->h; y++) {
+        for (int x = 0; x < g->w; x++) {
+            if (GAME_CLAIMED(g, x, y)) {
+                draw_rect(WIN_BORDER + EDGE_SIZE + x * CELL_PITCH, 
+                          WIN_BORDER + EDGE_SIZE + y * CELL_PITCH, 
+                          CELL_SIZE, CELL_SIZE, color_light_gray);
+            }
+        }
+    }
+    TRACE_ZONE_END(zone);
+}
+
+void draw_bitmap(const uint8_t* bitmap, int x, int y, int bitmap_w, int bitmap_h) {
+    TRACE_COUNT(TRACE_COUNTER_BLITS, 1);
+    uint8_t* out = frame;
+    int frame_w = win_w, frame_h = win_h;
+    for (int dy = 0; dy < bitmap_h; dy++) {
+        for (int dx = 0; dx < bitmap_w; dx++) {
+            int px = x + dx;
+            int py = y + dy;
+            if (px >= 0 && px < frame_w && py >= 0 && py < frame_h) {
+                uint8_t color = bitmap[dy * bitmap_w + dx];
+                if (color == PALETTE_TRANSPARENT) continue;
+                out[py * frame_w + px] = color;
+            }
+        }
+    }
+}
+
+void draw_paths(const Game* g, bool is_current_path_drawing) {
+    uint8_t path_color = is_current_path_drawing ? color_white : color_black;
+    const uint8_t* h_paths_to_draw = is_current_path_drawing ? g->path_h : g->past_path_h;
+    const uint8_t* v_paths_to_draw = is_current_path_drawing ? g->path_v : g->past_path_v;
+
+    int baseOffset = WIN_BORDER;
+    TRACE_ZONE_BEGIN(zone, is_current_path_drawing ? "draw_paths current" : "draw_paths past");
+
+    // Draw horizontal edges
+    for (int y = 0; y < g->h + 1; y++) {
+        for (int x = 0; x < g->w; x++) {
+            if (h_paths_to_draw[y * g->w + x]) {
+                int draw_x = baseOffset + x * CELL_PITCH + EDGE_SIZE; // Start after vertical border
+                int draw_y = baseOffset + y * CELL_PITCH;
+                draw_rect(draw_x, draw_y, CELL_SIZE, EDGE_SIZE, path_color);
+            }
+        }
+    }
+    // Draw vertical edges
+    for (int y = 0; y < g->h; y++) {
+        for (int x = 0; x < g->w + 1; x++) {
+            if (v_paths_to_draw[y * (g->w + 1) + x]) {
+                int draw_x = baseOffset + x * CELL_PITCH;
+                int draw_y = baseOffset + y * CELL_PITCH + EDGE_SIZE; // Start after horizontal border
+                draw_rect(draw_x, draw_y, EDGE_SIZE, CELL_SIZE, path_color);
+            }
+        }
+    }
+    TRACE_ZONE_END(zone);
+}
+
+
+void rotate_pixels(const uint32_t* src, uint32_t* dst, int width, int height, int angle) {
+    int out_w = width, out_h = height;
+    if (angle == 90 || angle == 270) {
+        out_w = height;
+        out_h = width;
+    }
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int src_idx = y * width + x;
+            int dst_idx;
+
+            switch (angle) {
+                // Clockwise; rows of the rotated image are out_w (= height) long
+                case 90: dst_idx = x * out_w + (out_w - 1 - y); break;
+                case 180: dst_idx = (height - 1 - y) * width + (width - 1 - x); break;
+                case 270: dst_idx = (out_h - 1 - x) * out_w + y; break;
+                default: dst_idx = src_idx; break;
+            }
+            if (dst_idx < out_w * out_h) dst[dst_idx] = src[src_idx];
+        }
+    }
+}
+
+void draw_snakes(const Game* g) {
+    for (int i = 0; i < g->snake_count; i++) {
+        const Snake* s = &g->snakes[i];
+        if (!s->alive) continue;
+        for (int k = s->tail;; k = (k + 1) % SNAKE_LENGTH) {
+            draw_rect(WIN_BORDER + EDGE_SIZE + s->segments[k].x * CELL_PITCH + 1,
+                      WIN_BORDER + EDGE_SIZE + s->segments[k].y * CELL_PITCH + 1,
+                      CELL_SIZE - 2, CELL_SIZE - 2, color_snake);
+            if (k == s->head) break;
+        }
+    }
+}
+
+void draw_spider(const Game* g) {
+    TRACE_ZONE_BEGIN(zone, "draw_spider");
+    int baseOffset = WIN_BORDER;
+    // Rotated once at render_init; sideways the sprite is SPIDER_HEIGHT wide
+    int direction = g->spider_vx > 0 ? 1 : g->spider_vx < 0 ? 3 : g->spider_vy > 0 ? 2 : 0;
+    int sprite_w_eff = direction % 2 ? SPIDER_HEIGHT : SPIDER_WIDTH;
+    int sprite_h_eff = direction % 2 ? SPIDER_WIDTH : SPIDER_HEIGHT;
+
+    int draw_x = g->spider_x - sprite_w_eff / 2 + EDGE_SIZE;
+    int draw_y = g->spider_y - sprite_h_eff / 2 + EDGE_SIZE;
+    draw_bitmap(spider_frames[direction], baseOffset + draw_x, baseOffset + draw_y, sprite_w_eff, sprite_h_eff);
+    TRACE_ZONE_END(zone);
+}
+
+void render_frame(const Game* g) {
+    clear_screen(color_light_gray); 
+
+    // Map background in cyan (unclaimed areas default)
+    draw_rect(WIN_BORDER + EDGE_SIZE, WIN_BORDER + EDGE_SIZE, map_w_pixels, map_h_pixels, color_cyan);
+    draw_background_picture();
+    
+    draw_cells(g);          // Draw claimed cell interiors (light gray)
+    draw_paths(g, false);   // Draw past paths (black)
+    draw_paths(g, true);    // Draw current path (white)
+    draw_snakes(g);
+    draw_spider(g);
+
+    // Outer border of the map area
+    int map_w_incl_edge = map_w_pixels + 2 * EDGE_SIZE;
+    int map_h_incl_edge = map_h_pixels + 2 * EDGE_SIZE;
+    // Top
+    draw_rect(WIN_BORDER, WIN_BORDER, map_w_incl_edge, EDGE_SIZE, color_black);
+    // Bottom
+    draw_rect(WIN_BORDER, WIN_BORDER + map_h_incl_edge - EDGE_SIZE, map_w_incl_edge, EDGE_SIZE, color_black);
+    // Left
+    draw_rect(WIN_BORDER, WIN_BORDER + EDGE_SIZE, EDGE_SIZE, map_h_pixels, color_black);
+    // Right
+    draw_rect(WIN_BORDER + map_w_incl_edge - EDGE_SIZE, WIN_BORDER + EDGE_SIZE, EDGE_SIZE, map_h_pixels, color_black);
+}
+
+// --- START: Present ---
+// n indices of frame row y from column x on, as 0x00RRGGBB
+static void expand_row(const uint8_t* in, uint32_t* out, int n, int x, int y) {
+    int i = 0;
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) {
+        __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(in + i)));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_i32gather_epi32((const int*)palette, index, 4));
+    }
+#endif
+    for (; i < n; i++) out[i] = palette[in[i]];
+
+    // Picture pixels; draw_background_picture only marks rows and columns it has
+    const uint8_t* p = memchr(in, PALETTE_PICTURE, (size_t)n);
+    if (!p) return;
+    const uint32_t* picture = background_picture.pixels + (size_t)(y - WIN_BORDER - EDGE_SIZE) * background_picture.info.width;
+    int left = WIN_BORDER + EDGE_SIZE - x;
+    for (i = (int)(p - in); i < n; i++) {
+        if (in[i] == PALETTE_PICTURE) out[i] = picture[i - left];
+    }
+}
+
+int render_present(RenderChangedFn changed, void* ctx) {
+    TRACE_ZONE_BEGIN(zone, "render_present");
+    int expanded = 0;
+    bool all = palette_changed;
+    palette_changed = false;
+    for (int y0 = 0; y0 < win_h; y0 += RENDER_TILE) {
+        int y1 = y0 + RENDER_TILE < win_h ? y0 + RENDER_TILE : win_h;
+        for (int x0 = 0; x0 < win_w; x0 += RENDER_TILE) {
+            int w = x0 + RENDER_TILE < win_w ? RENDER_TILE : win_w - x0;
+            int y = y0;
+            while (!all && y < y1 && memcmp(frame + (size_t)y * win_w + x0, presented + (size_t)y * win_w + x0, (size_t)w) == 0) y++;
+            if (y == y1) continue;
+            for (y = y0; y < y1; y++) {
+                size_t at = (size_t)y * win_w + x0;
+                memcpy(presented + at, frame + at, (size_t)w);
+                expand_row(frame + at, pixels + at, w, x0, y);
+            }
+            if (changed) changed(ctx, x0, y0, w, y1 - y0);
+            expanded++;
+        }
+    }
+    TRACE_ZONE_END(zone);
+    return expanded;
+}
+
+void render_expand(uint32_t* out) {
+    for (int y = 0; y < win_h; y++) {
+        expand_row(frame + (size_t)y * win_w, out + (size_t)y * win_w, win_w, 0, y);
+    }
+}
+// --- END: Present ---
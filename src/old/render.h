@@ -0,0 +1,92 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bmp_stream.h"
+#include "counter.h"
+#include "game.h"
+
+// Software rendering of the board into `frame`, win_w x win_h palette indices,
+// sized for the board at render_init. Every fill is a memset of bytes, a quarter
+// of the traffic of 0x00RRGGBB pixels. render_present expands the tiles that
+// changed since the last present into `pixels` through `palette`, which the
+// window (or a benchmark) presents as it likes. Like the original's palette
+// (CREATEPALETTE in FUN_1020_07c2), changing an entry recolors the whole frame
+// without drawing it again.
+
+#define WIN_BORDER 16 
+
+// Frame geometry for the board passed to render_init
+extern int map_w_pixels, map_h_pixels; // Board interior, between the outer border lines
+extern int win_w, win_h;
+// Rows added below the board for counter.h's counters; render_frame leaves them
+// alone. 0 unless set before render_init.
+extern int status_bar_h;
+
+#define STATUS_BAR_H (COUNTER_DIGIT_H + 8)
+
+// --- START: Palette ---
+#define PALETTE_SIZE 256
+#define PALETTE_TRANSPARENT 254 // In sprites: leaves the frame as it is
+#define PALETTE_PICTURE 255     // In the frame: the background picture's pixel there
+
+// 0x00RRGGBB of every index
+extern uint32_t palette[PALETTE_SIZE];
+
+// Index of a color, added to the palette if new; the nearest entry once it is full
+uint8_t palette_index(uint32_t rgb);
+// Recolors an entry; the next render_present expands the whole frame again
+void palette_set(uint8_t index, uint32_t rgb);
+// --- END: Palette ---
+
+// Colors, indices into palette
+extern uint8_t color_black;
+extern uint8_t color_white;
+extern uint8_t color_cyan;
+extern uint8_t color_light_gray;
+extern uint8_t color_snake;
+
+extern uint8_t* frame;
+// frame as 0x00RRGGBB, as of the last render_present
+extern uint32_t* pixels;
+
+#define RENDER_TILE 32 // Side of the squares render_present compares and expands
+
+// Spider sprite, SPIDER_WIDTH x SPIDER_HEIGHT; the embedded one unless mamba.pak overrides it
+extern const uint32_t* spider_sprite;
+
+// Optional background picture (mamba.exe picture.bmp), decoded in the background
+extern BmpStream background_picture;
+
+// Allocates the frame for g's board size and puts the game's and the spider's
+// colors in the palette.
+bool render_init(const Game* g);
+void render_free();
+
+// Everything above the status bar
+void clear_screen(uint8_t color);
+void draw_rect(int x, int y, int w, int h, uint8_t color);
+// Indexed bitmap; PALETTE_TRANSPARENT pixels are skipped
+void draw_bitmap(const uint8_t* bitmap, int x, int y, int bitmap_w, int bitmap_h);
+void rotate_pixels(const uint32_t* src, uint32_t* dst, int width, int height, int angle);
+void draw_background_picture();
+void draw_cells(const Game* g);
+void draw_paths(const Game* g, bool is_current_path_drawing);
+void draw_snakes(const Game* g);
+void draw_spider(const Game* g);
+
+// Composes the whole frame, everything WM_PAINT shows
+void render_frame(const Game* g);
+
+// Called for each tile render_present expanded, in frame pixels
+typedef void (*RenderChangedFn)(void* ctx, int x, int y, int w, int h);
+
+// Expands the tiles of frame that changed since the last present (all of them
+// after render_init or palette_set) into `pixels`. changed may be NULL. Returns
+// the number of tiles expanded.
+int render_present(RenderChangedFn changed, void* ctx);
+// Expands the whole frame into out (win_w x win_h), leaving `pixels` alone
+void render_expand(uint32_t* out);
+
+#endif // RENDER_H
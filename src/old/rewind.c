@@ -0,0 +1,274 @@
+#include "rewind.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Zero runs shorter than this stay inside a literal; a token costs two varints
+#define MIN_ZERO_RUN 4
+
+typedef struct {
+    uint32_t offset, size; // Payload in the ring
+    bool keyframe;
+} RewindEntry;
+
+struct RewindBuffer {
+    size_t state_bytes;
+    int keyframe_interval;
+    uint8_t* newest;      // Flat state of the newest entry
+    uint8_t* work;        // Flat state being encoded or decoded
+    uint8_t* encoded;     // Encoder output, sized for the worst case
+
+    uint8_t* data;        // Ring of payloads
+    size_t capacity;
+    size_t write;         // Where the next payload goes
+    size_t used;          // Payload bytes held
+
+    RewindEntry* entries; // Ring, oldest at `first`; the oldest is always a keyframe
+    int entry_capacity;
+    int first, count;
+    int since_keyframe;   // Entries after the newest keyframe
+};
+
+// --- START: Coding ---
+// Tokens of (zero run, literal length, literal bytes), lengths as LEB128 varints,
+// until the state is covered. Decoding XORs the literals in, so the same decoder
+// applies deltas and (into a zeroed buffer) keyframes.
+static uint8_t* put_varint(uint8_t* out, size_t v) {
+    while (v >= 0x80) {
+        *out++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *out++ = (uint8_t)v;
+    return out;
+}
+
+static const uint8_t* get_varint(const uint8_t* in, size_t* v) {
+    size_t value = 0;
+    int shift = 0;
+    while (*in & 0x80) {
+        value |= (size_t)(*in++ & 0x7f) << shift;
+        shift += 7;
+    }
+    *v = value | (size_t)*in++ << shift;
+    return in;
+}
+
+// Length of the zero run starting at src[i], eight bytes at a time
+static size_t zero_run(const uint8_t* src, size_t i, size_t n) {
+    size_t start = i;
+    while (i + 8 <= n) {
+        uint64_t word;
+        memcpy(&word, src + i, 8);
+        if (word) break;
+        i += 8;
+    }
+    while (i < n && !src[i]) i++;
+    return i - start;
+}
+
+static size_t encode(const uint8_t* src, size_t n, uint8_t* out) {
+    uint8_t* p = out;
+    size_t i = 0;
+    while (i < n) {
+        size_t zeros = zero_run(src, i, n);
+        size_t literal = i + zeros;
+        size_t end = literal;
+        while (end < n) {
+            if (src[end]) {
+                end++;
+                continue;
+            }
+            size_t gap = zero_run(src, end, n);
+            if (gap >= MIN_ZERO_RUN || end + gap == n) break;
+            end += gap;
+        }
+        p = put_varint(p, zeros);
+        p = put_varint(p, end - literal);
+        memcpy(p, src + literal, end - literal);
+        p += end - literal;
+        i = end;
+    }
+    return (size_t)(p - out);
+}
+
+static void decode_xor(const uint8_t* in, size_t size, uint8_t* dst) {
+    const uint8_t* end = in + size;
+    size_t i = 0;
+    while (in < end) {
+        size_t zeros, literal;
+        in = get_varint(in, &zeros);
+        in = get_varint(in, &literal);
+        i += zeros;
+        for (size_t k = 0; k < literal; k++) dst[i + k] ^= in[k];
+        in += literal;
+        i += literal;
+    }
+}
+// --- END: Coding ---
+
+RewindBuffer* rewind_create(const Game* g, size_t budget_bytes, int keyframe_interval) {
+    RewindBuffer* rb = calloc(1, sizeof(RewindBuffer));
+    if (!rb) return NULL;
+    rb->state_bytes = game_state_bytes(g);
+    rb->keyframe_interval = keyframe_interval > 0 ? keyframe_interval : REWIND_DEFAULT_KEYFRAME_INTERVAL;
+    rb->capacity = budget_bytes;
+    rb->newest = malloc(rb->state_bytes);
+    rb->work = malloc(rb->state_bytes);
+    rb->encoded = malloc(rb->state_bytes * 2 + 32); // Alternating bytes: 3 per 2, plus varints
+    rb->data = malloc(rb->capacity ? rb->capacity : 1);
+    if (!rb->newest || !rb->work || !rb->encoded || !rb->data) {
+        rewind_destroy(rb);
+        return NULL;
+    }
+    return rb;
+}
+
+void rewind_destroy(RewindBuffer* rb) {
+    if (!rb) return;
+    free(rb->entries);
+    free(rb->data);
+    free(rb->encoded);
+    free(rb->work);
+    free(rb->newest);
+    free(rb);
+}
+
+void rewind_clear(RewindBuffer* rb) {
+    rb->first = rb->count = 0;
+    rb->write = rb->used = 0;
+    rb->since_keyframe = 0;
+}
+
+// --- START: Entries ---
+static RewindEntry* entry(const RewindBuffer* rb, int index) {
+    return &rb->entries[(rb->first + index) % rb->entry_capacity];
+}
+
+static bool grow_entries(RewindBuffer* rb) {
+    int capacity = rb->entry_capacity ? rb->entry_capacity * 2 : 1024;
+    RewindEntry* entries = malloc((size_t)capacity * sizeof(RewindEntry));
+    if (!entries) return false;
+    for (int i = 0; i < rb->count; i++) entries[i] = *entry(rb, i);
+    free(rb->entries);
+    rb->entries = entries;
+    rb->entry_capacity = capacity;
+    rb->first = 0;
+    return true;
+}
+
+// Drops the oldest keyframe and the deltas that depend on it
+static void drop_oldest_group(RewindBuffer* rb) {
+    do {
+        rb->used -= entry(rb, 0)->size;
+        rb->first = (rb->first + 1) % rb->entry_capacity;
+        rb->count--;
+    } while (rb->count > 0 && !entry(rb, 0)->keyframe);
+    if (rb->count == 0) rewind_clear(rb);
+}
+
+// Ring offset for `size` bytes, dropping old groups until they fit; SIZE_MAX if
+// the buffer had to be emptied (then the caller's delta has no base left)
+static size_t place(RewindBuffer* rb, size_t size) {
+    for (;;) {
+        if (rb->count == 0) return 0;
+        size_t head = entry(rb, 0)->offset;
+        if (rb->write > head) { // Free space is after write, then before head
+            if (rb->capacity - rb->write >= size) return rb->write;
+            if (head >= size) return 0;
+        } else if (head - rb->write >= size) { // Wrapped: free space is between
+            return rb->write;
+        }
+        drop_oldest_group(rb);
+        if (rb->count == 0) return SIZE_MAX;
+    }
+}
+
+bool rewind_push(RewindBuffer* rb, const Game* g) {
+    game_save_state(g, rb->work);
+    bool keyframe = rb->count == 0 || rb->since_keyframe + 1 >= rb->keyframe_interval;
+    size_t size;
+    if (keyframe) {
+        size = encode(rb->work, rb->state_bytes, rb->encoded);
+    } else {
+        for (size_t i = 0; i < rb->state_bytes; i++) rb->newest[i] ^= rb->work[i]; // newest becomes the delta
+        size = encode(rb->newest, rb->state_bytes, rb->encoded);
+    }
+    memcpy(rb->newest, rb->work, rb->state_bytes);
+    if (size > rb->capacity) {
+        rewind_clear(rb);
+        return false;
+    }
+
+    size_t offset = place(rb, size);
+    if (offset == SIZE_MAX) { // Everything before was dropped: store the state itself
+        keyframe = true;
+        size = encode(rb->work, rb->state_bytes, rb->encoded);
+        offset = 0;
+        if (size > rb->capacity) return false;
+    }
+    if (rb->count == rb->entry_capacity && !grow_entries(rb)) return false;
+
+    memcpy(rb->data + offset, rb->encoded, size);
+    RewindEntry* e = &rb->entries[(rb->first + rb->count) % rb->entry_capacity];
+    e->offset = (uint32_t)offset;
+    e->size = (uint32_t)size;
+    e->keyframe = keyframe;
+    rb->count++;
+    rb->write = offset + size;
+    rb->used += size;
+    rb->since_keyframe = keyframe ? 0 : rb->since_keyframe + 1;
+    return true;
+}
+// --- END: Entries ---
+
+// --- START: Seeking ---
+// Rebuilds the state of entry `index` (0 = oldest) in rb->work
+static void rebuild(RewindBuffer* rb, int index) {
+    int key = index;
+    while (!entry(rb, key)->keyframe) key--;
+    int newest = rb->count - 1;
+
+    if (newest - index < index - key && newest - index <= rb->since_keyframe) {
+        // Nearer the newest state, with only deltas in between: undo them back from it
+        memcpy(rb->work, rb->newest, rb->state_bytes);
+        for (int i = newest; i > index; i--) {
+            const RewindEntry* e = entry(rb, i);
+            decode_xor(rb->data + e->offset, e->size, rb->work);
+        }
+        return;
+    }
+    memset(rb->work, 0, rb->state_bytes);
+    for (int i = key; i <= index; i++) {
+        const RewindEntry* e = entry(rb, i);
+        decode_xor(rb->data + e->offset, e->size, rb->work);
+    }
+}
+
+bool rewind_seek(RewindBuffer* rb, int ticks_back, Game* g) {
+    if (ticks_back < 0 || ticks_back >= rb->count || game_state_bytes(g) != rb->state_bytes) return false;
+    rebuild(rb, rb->count - 1 - ticks_back);
+    game_load_state(g, rb->work);
+    return true;
+}
+
+bool rewind_step_back(RewindBuffer* rb, int ticks_back, Game* g) {
+    if (!rewind_seek(rb, ticks_back, g)) return false;
+    for (int i = 0; i < ticks_back; i++) rb->used -= entry(rb, rb->count - 1 - i)->size;
+    rb->count -= ticks_back;
+    const RewindEntry* last = entry(rb, rb->count - 1);
+    rb->write = last->offset + last->size;
+    memcpy(rb->newest, rb->work, rb->state_bytes);
+    rb->since_keyframe = 0;
+    for (int i = rb->count - 1; i > 0 && !entry(rb, i)->keyframe; i--) rb->since_keyframe++;
+    return true;
+}
+
+int rewind_count(const RewindBuffer* rb) {
+    return rb->count;
+}
+
+size_t rewind_bytes(const RewindBuffer* rb) {
+    return rb->used;
+}
+// --- END: Seeking ---
@@ -0,0 +1,40 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "game.h"
+
+// The last few minutes of a game, one state per tick, to scrub backwards through.
+//
+// Each pushed state (game_save_state's flat form) is stored as the XOR with the
+// previous one, run-length coded: a tick changes a handful of bytes, so most
+// entries are a few dozen bytes. Every keyframe_interval ticks the state itself
+// is stored instead, coded the same way. Entries go into one ring of the given
+// byte budget; when it is full the oldest keyframe and its deltas are dropped
+// together. A seek decodes at most keyframe_interval / 2 entries in the usual
+// case: forward from the keyframe before the target, or back from the newest
+// state when that is nearer (XOR deltas undo themselves).
+
+#define REWIND_DEFAULT_KEYFRAME_INTERVAL 64
+
+typedef struct RewindBuffer RewindBuffer;
+
+// For games the size of g, in at most budget_bytes of entries; keyframe_interval
+// 0 = REWIND_DEFAULT_KEYFRAME_INTERVAL. NULL if out of memory.
+RewindBuffer* rewind_create(const Game* g, size_t budget_bytes, int keyframe_interval);
+void rewind_destroy(RewindBuffer* rb);
+void rewind_clear(RewindBuffer* rb);
+
+// Records g as the newest state; call once per tick. False if one state does not
+// fit in the budget at all.
+bool rewind_push(RewindBuffer* rb, const Game* g);
+// Puts the state from `ticks_back` ticks before the newest (0 = newest) into g
+bool rewind_seek(RewindBuffer* rb, int ticks_back, Game* g);
+// Seeks, then forgets everything newer, so play continues from there
+bool rewind_step_back(RewindBuffer* rb, int ticks_back, Game* g);
+
+int rewind_count(const RewindBuffer* rb);    // States held
+size_t rewind_bytes(const RewindBuffer* rb); // Bytes of entries held
+
+#endif // REWIND_H
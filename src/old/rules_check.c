@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <string.h>
+#include "game.h"
+
+// Checks claim rules that are easy to break without noticing in play. Runs and
+// prints every case, then exits 1 if any of them failed.
+//
+//     rules_check
+//
+// Every case draws whole paths with game_play_path on an empty default board and
+// compares the claimed cells with what the rule says.
+
+static int failures;
+
+// Draws `count` edges in direction dir from vertex (vx, vy)
+static void cut(Game* g, int vx, int vy, int dir, int count) {
+    uint8_t dirs[GAME_MAX_CELLS];
+    memset(dirs, dir, (size_t)count);
+    game_play_path(g, vx, vy, dirs, count);
+}
+
+static void expect_claimed(const char* name, const Game* g, int expected) {
+    bool ok = g->claimed_cell_count == expected;
+    printf("%-48s %s (claimed %d, expected %d)\n", name, ok ? "ok" : "FAILED", g->claimed_cell_count, expected);
+    if (!ok) failures++;
+}
+
+int main(void) {
+    Game g;
+    if (!game_init(&g, GAME_DEFAULT_W, GAME_DEFAULT_H, 0)) return 1;
+    int w = g.w, h = g.h;
+
+    // A first cut claims the smaller side
+    initialize_game_state(&g);
+    cut(&g, 3, 0, SNAKE_DOWN, h);
+    expect_claimed("first cut claims the smaller side", &g, 3 * h);
+
+    // The outer border stays claimed ground after the first claim, so a cut far
+    // from the claims also takes its smaller side, not the one by the claims
+    cut(&g, w - 3, 0, SNAKE_DOWN, h);
+    expect_claimed("later cut by the border claims the smaller side", &g, 6 * h);
+
+    // Same for a corner snipped off after a claim on the other side
+    initialize_game_state(&g);
+    cut(&g, 3, 0, SNAKE_DOWN, h);
+    uint8_t corner[4] = { SNAKE_UP, SNAKE_UP, SNAKE_RIGHT, SNAKE_RIGHT };
+    game_play_path(&g, w - 2, h, corner, 4);
+    expect_claimed("later corner cut claims the corner", &g, 3 * h + 4);
+
+    game_free(&g);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,309 @@
+#include "scaler.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "platform.h"
+#include "trace.h"
+#include "work_pool.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// work_pool_run starts its threads per run, which costs more than a few tiles take
+// to scale: smaller runs stay on the calling thread
+#define TILES_PER_WORKER 16
+
+// --- START: Kernels ---
+// Scale2x of E from its neighbours B (above), D (left), F (right) and H (below)
+static inline void scale2x_pixel(uint32_t b, uint32_t d, uint32_t e, uint32_t f, uint32_t h, uint32_t* o0, uint32_t* o1) {
+    if (b != h && d != f) {
+        o0[0] = d == b ? d : e;
+        o0[1] = b == f ? f : e;
+        o1[0] = d == h ? d : e;
+        o1[1] = h == f ? f : e;
+    } else {
+        o0[0] = o0[1] = o1[0] = o1[1] = e;
+    }
+}
+
+#if defined(__SSE2__)
+static inline __m128i select128(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+#endif
+
+// Scale2x of the rect [x0, x1) x [y0, y1) of a w x h image; pixel (x0, y0) lands on
+// dst[0]. Neighbours come from the whole image, clamped at its edges.
+static void scale2x_rect(const uint32_t* img, int w, int h, int stride, int x0, int x1, int y0, int y1,
+                         uint32_t* dst, int dst_stride) {
+    for (int y = y0; y < y1; y++) {
+        const uint32_t* up = img + (size_t)(y > 0 ? y - 1 : 0) * stride;
+        const uint32_t* row = img + (size_t)y * stride;
+        const uint32_t* down = img + (size_t)(y < h - 1 ? y + 1 : h - 1) * stride;
+        uint32_t* o0 = dst + (size_t)(2 * (y - y0)) * dst_stride - 2 * x0;
+        uint32_t* o1 = o0 + dst_stride;
+
+        // Columns with both side neighbours inside the image take the vector path
+        int x = x0;
+        for (; x < 1 && x < x1; x++) {
+            scale2x_pixel(up[x], row[x > 0 ? x - 1 : 0], row[x], row[x < w - 1 ? x + 1 : w - 1], down[x],
+                          o0 + 2 * x, o1 + 2 * x);
+        }
+#if defined(__SSE2__)
+        const __m128i ones = _mm_set1_epi32(-1);
+        int xb = x1 < w - 1 ? x1 : w - 1;
+        for (; x + 4 <= xb; x += 4) {
+            __m128i b = _mm_loadu_si128((const __m128i*)(up + x));
+            __m128i d = _mm_loadu_si128((const __m128i*)(row + x - 1));
+            __m128i e = _mm_loadu_si128((const __m128i*)(row + x));
+            __m128i f = _mm_loadu_si128((const __m128i*)(row + x + 1));
+            __m128i hh = _mm_loadu_si128((const __m128i*)(down + x));
+            __m128i active = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi32(b, hh), _mm_cmpeq_epi32(d, f)), ones);
+            __m128i e0 = select128(_mm_and_si128(active, _mm_cmpeq_epi32(d, b)), d, e);
+            __m128i e1 = select128(_mm_and_si128(active, _mm_cmpeq_epi32(b, f)), f, e);
+            __m128i e2 = select128(_mm_and_si128(active, _mm_cmpeq_epi32(d, hh)), d, e);
+            __m128i e3 = select128(_mm_and_si128(active, _mm_cmpeq_epi32(hh, f)), f, e);
+            _mm_storeu_si128((__m128i*)(o0 + 2 * x), _mm_unpacklo_epi32(e0, e1));
+            _mm_storeu_si128((__m128i*)(o0 + 2 * x + 4), _mm_unpackhi_epi32(e0, e1));
+            _mm_storeu_si128((__m128i*)(o1 + 2 * x), _mm_unpacklo_epi32(e2, e3));
+            _mm_storeu_si128((__m128i*)(o1 + 2 * x + 4), _mm_unpackhi_epi32(e2, e3));
+        }
+#endif
+        for (; x < x1; x++) {
+            scale2x_pixel(up[x], row[x > 0 ? x - 1 : 0], row[x], row[x < w - 1 ? x + 1 : w - 1], down[x],
+                          o0 + 2 * x, o1 + 2 * x);
+        }
+    }
+}
+
+// Scale3x (AdvMAME3x), same conventions as scale2x_rect
+static void scale3x_rect(const uint32_t* img, int w, int h, int stride, int x0, int x1, int y0, int y1,
+                         uint32_t* dst, int dst_stride) {
+    for (int y = y0; y < y1; y++) {
+        const uint32_t* up = img + (size_t)(y > 0 ? y - 1 : 0) * stride;
+        const uint32_t* row = img + (size_t)y * stride;
+        const uint32_t* down = img + (size_t)(y < h - 1 ? y + 1 : h - 1) * stride;
+        uint32_t* o0 = dst + (size_t)(3 * (y - y0)) * dst_stride - 3 * x0;
+        uint32_t* o1 = o0 + dst_stride;
+        uint32_t* o2 = o1 + dst_stride;
+        for (int x = x0; x < x1; x++) {
+            int l = x > 0 ? x - 1 : 0, r = x < w - 1 ? x + 1 : w - 1;
+            uint32_t a = up[l], b = up[x], c = up[r];
+            uint32_t d = row[l], e = row[x], f = row[r];
+            uint32_t g = down[l], hh = down[x], i = down[r];
+            uint32_t* p0 = o0 + 3 * x;
+            uint32_t* p1 = o1 + 3 * x;
+            uint32_t* p2 = o2 + 3 * x;
+            if (b != hh && d != f) {
+                p0[0] = d == b ? d : e;
+                p0[1] = (d == b && e != c) || (b == f && e != a) ? b : e;
+                p0[2] = b == f ? f : e;
+                p1[0] = (d == b && e != g) || (d == hh && e != a) ? d : e;
+                p1[1] = e;
+                p1[2] = (b == f && e != i) || (hh == f && e != c) ? f : e;
+                p2[0] = d == hh ? d : e;
+                p2[1] = (d == hh && e != i) || (hh == f && e != g) ? hh : e;
+                p2[2] = hh == f ? f : e;
+            } else {
+                p0[0] = p0[1] = p0[2] = p1[0] = p1[1] = p1[2] = p2[0] = p2[1] = p2[2] = e;
+            }
+        }
+    }
+}
+
+// Every pixel of the rect as a scale x scale block
+static void nearest_rect(const uint32_t* img, int stride, int x0, int x1, int y0, int y1, int scale,
+                         uint32_t* dst, int dst_stride) {
+    int out_w = (x1 - x0) * scale;
+    for (int y = y0; y < y1; y++) {
+        const uint32_t* row = img + (size_t)y * stride;
+        uint32_t* out = dst + (size_t)(scale * (y - y0)) * dst_stride;
+        int x = x0;
+        uint32_t* o = out;
+        if (scale == 2) {
+#if defined(__SSE2__)
+            for (; x + 4 <= x1; x += 4, o += 8) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(row + x));
+                _mm_storeu_si128((__m128i*)o, _mm_unpacklo_epi32(v, v));
+                _mm_storeu_si128((__m128i*)(o + 4), _mm_unpackhi_epi32(v, v));
+            }
+#endif
+            for (; x < x1; x++, o += 2) o[0] = o[1] = row[x];
+        } else {
+            for (; x < x1; x++) {
+                for (int k = 0; k < scale; k++) *o++ = row[x];
+            }
+        }
+        for (int k = 1; k < scale; k++) {
+            memcpy(out + (size_t)k * dst_stride, out, (size_t)out_w * sizeof(uint32_t));
+        }
+    }
+}
+// --- END: Kernels ---
+
+bool scaler_init(Scaler* s, int src_w, int src_h, int scale, ScalerFilter filter, int threads) {
+    memset(s, 0, sizeof(Scaler));
+    if (scale < 1) scale = 1;
+    if (scale > SCALER_MAX_SCALE) scale = SCALER_MAX_SCALE;
+    if (threads <= 0) threads = platform_cpu_count();
+    if (threads > WORK_POOL_MAX_THREADS) threads = WORK_POOL_MAX_THREADS;
+    s->src_w = src_w;
+    s->src_h = src_h;
+    s->scale = scale;
+    s->filter = filter;
+    s->threads = threads;
+    s->out_w = src_w * scale;
+    s->out_h = src_h * scale;
+    s->tiles_x = (src_w + SCALER_TILE - 1) / SCALER_TILE;
+    s->tiles_y = (src_h + SCALER_TILE - 1) / SCALER_TILE;
+    int tiles = s->tiles_x * s->tiles_y;
+    s->scratch_pixels = (size_t)(2 * (SCALER_TILE + 2)) * (size_t)(2 * (SCALER_TILE + 2));
+
+    s->out = calloc((size_t)s->out_w * (size_t)s->out_h, sizeof(uint32_t));
+    s->previous = malloc((size_t)src_w * (size_t)src_h * sizeof(uint32_t));
+    s->dirty = calloc((size_t)tiles, 1);
+    s->dirty_list = malloc((size_t)tiles * sizeof(int));
+    if (scale == 4 && filter == SCALER_SMOOTH) s->scratch = malloc(s->scratch_pixels * (size_t)threads * sizeof(uint32_t));
+    if (!s->out || !s->previous || !s->dirty || !s->dirty_list || (scale == 4 && filter == SCALER_SMOOTH && !s->scratch)) {
+        scaler_free(s);
+        return false;
+    }
+    return true;
+}
+
+void scaler_free(Scaler* s) {
+    free(s->out);
+    free(s->previous);
+    free(s->dirty);
+    free(s->dirty_list);
+    free(s->scratch);
+    memset(s, 0, sizeof(Scaler));
+}
+
+int scaler_fit_scale(int src_w, int src_h, int avail_w, int avail_h) {
+    int scale = SCALER_MAX_SCALE;
+    while (scale > 1 && (src_w * scale > avail_w || src_h * scale > avail_h)) scale--;
+    return scale;
+}
+
+void scaler_mark_dirty(Scaler* s, int x, int y, int w, int h) {
+    int x1 = x + w, y1 = y + h;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x1 > s->src_w) x1 = s->src_w;
+    if (y1 > s->src_h) y1 = s->src_h;
+    if (x >= x1 || y >= y1) return;
+    for (int ty = y / SCALER_TILE; ty <= (y1 - 1) / SCALER_TILE; ty++) {
+        for (int tx = x / SCALER_TILE; tx <= (x1 - 1) / SCALER_TILE; tx++) s->dirty[ty * s->tiles_x + tx] = 1;
+    }
+}
+
+void scaler_invalidate(Scaler* s) {
+    s->compare = false;
+}
+
+// --- START: Tiles ---
+typedef struct {
+    Scaler* s;
+    const uint32_t* src;
+} ScaleJob;
+
+static void scale_tile(void* ctx, int index, int worker) {
+    ScaleJob* job = ctx;
+    Scaler* s = job->s;
+    int tile = s->dirty_list[index];
+    int w = s->src_w, h = s->src_h, scale = s->scale;
+    int x0 = tile % s->tiles_x * SCALER_TILE, y0 = tile / s->tiles_x * SCALER_TILE;
+    int x1 = x0 + SCALER_TILE < w ? x0 + SCALER_TILE : w;
+    int y1 = y0 + SCALER_TILE < h ? y0 + SCALER_TILE : h;
+    uint32_t* dst = s->out + (size_t)(y0 * scale) * s->out_w + (size_t)(x0 * scale);
+
+    if (s->filter == SCALER_NEAREST || scale == 1) {
+        nearest_rect(job->src, w, x0, x1, y0, y1, scale, dst, s->out_w);
+    } else if (scale == 2) {
+        scale2x_rect(job->src, w, h, w, x0, x1, y0, y1, dst, s->out_w);
+    } else if (scale == 3) {
+        scale3x_rect(job->src, w, h, w, x0, x1, y0, y1, dst, s->out_w);
+    } else {
+        // Scale2x of the tile and a 1 pixel ring, then Scale2x of that without the ring
+        int rx0 = x0 > 0 ? x0 - 1 : 0, rx1 = x1 < w ? x1 + 1 : w;
+        int ry0 = y0 > 0 ? y0 - 1 : 0, ry1 = y1 < h ? y1 + 1 : h;
+        int sw = 2 * (rx1 - rx0), sh = 2 * (ry1 - ry0);
+        uint32_t* scratch = s->scratch + s->scratch_pixels * (size_t)worker;
+        scale2x_rect(job->src, w, h, w, rx0, rx1, ry0, ry1, scratch, sw);
+        scale2x_rect(scratch, sw, sh, sw, 2 * (x0 - rx0), 2 * (x1 - rx0), 2 * (y0 - ry0), 2 * (y1 - ry0), dst, s->out_w);
+    }
+}
+
+// Sets the dirty flag of every tile that differs from `previous` and updates it
+static void compare_tiles(Scaler* s, const uint32_t* src) {
+    int w = s->src_w;
+    for (int ty = 0; ty < s->tiles_y; ty++) {
+        int y0 = ty * SCALER_TILE, y1 = y0 + SCALER_TILE < s->src_h ? y0 + SCALER_TILE : s->src_h;
+        for (int tx = 0; tx < s->tiles_x; tx++) {
+            int x0 = tx * SCALER_TILE, x1 = x0 + SCALER_TILE < w ? x0 + SCALER_TILE : w;
+            size_t bytes = (size_t)(x1 - x0) * sizeof(uint32_t);
+            int y = y0;
+            while (y < y1 && memcmp(src + (size_t)y * w + x0, s->previous + (size_t)y * w + x0, bytes) == 0) y++;
+            if (y == y1) continue;
+            s->dirty[ty * s->tiles_x + tx] = 1;
+            for (; y < y1; y++) memcpy(s->previous + (size_t)y * w + x0, src + (size_t)y * w + x0, bytes);
+        }
+    }
+}
+// --- END: Tiles ---
+
+int scaler_run(Scaler* s, const uint32_t* src, ScalerRect* changed) {
+    TRACE_ZONE_BEGIN(zone, "scaler_run");
+    int tiles = s->tiles_x * s->tiles_y;
+    if (!s->compare) {
+        memcpy(s->previous, src, (size_t)s->src_w * (size_t)s->src_h * sizeof(uint32_t));
+        memset(s->dirty, 1, (size_t)tiles);
+        s->compare = true;
+    } else if (!s->marked_only) {
+        compare_tiles(s, src);
+    }
+
+    // Smoothed pixels on a tile's edge read the neighbouring tile
+    bool spread = s->filter == SCALER_SMOOTH && s->scale > 1;
+    int count = 0;
+    int bx0 = s->tiles_x, by0 = s->tiles_y, bx1 = -1, by1 = -1;
+    for (int ty = 0; ty < s->tiles_y; ty++) {
+        for (int tx = 0; tx < s->tiles_x; tx++) {
+            bool dirty = s->dirty[ty * s->tiles_x + tx] != 0;
+            for (int ny = ty - 1; spread && !dirty && ny <= ty + 1; ny++) {
+                for (int nx = tx - 1; !dirty && nx <= tx + 1; nx++) {
+                    if (nx >= 0 && ny >= 0 && nx < s->tiles_x && ny < s->tiles_y) dirty = s->dirty[ny * s->tiles_x + nx] != 0;
+                }
+            }
+            if (!dirty) continue;
+            s->dirty_list[count++] = ty * s->tiles_x + tx;
+            if (tx < bx0) bx0 = tx;
+            if (tx > bx1) bx1 = tx;
+            if (ty < by0) by0 = ty;
+            if (ty > by1) by1 = ty;
+        }
+    }
+    memset(s->dirty, 0, (size_t)tiles);
+
+    ScaleJob job = { s, src };
+    int threads = count / TILES_PER_WORKER;
+    if (threads > s->threads) threads = s->threads;
+    if (threads < 1) threads = 1;
+    work_pool_run(threads, count, scale_tile, &job);
+    s->last_tiles = count;
+
+    if (changed) {
+        memset(changed, 0, sizeof(ScalerRect));
+        if (count > 0) {
+            int unit = SCALER_TILE * s->scale;
+            changed->x = bx0 * unit;
+            changed->y = by0 * unit;
+            changed->w = ((bx1 + 1) * unit < s->out_w ? (bx1 + 1) * unit : s->out_w) - changed->x;
+            changed->h = ((by1 + 1) * unit < s->out_h ? (by1 + 1) * unit : s->out_h) - changed->y;
+        }
+    }
+    TRACE_ZONE_END(zone);
+    return count;
+}
@@ -0,0 +1,67 @@
+#ifndef SCALER_H
+#define SCALER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Integer upscaling of the 0x00RRGGBB frame for presenting, so GDI only ever copies.
+//
+// The frame is split into SCALER_TILE x SCALER_TILE tiles. scaler_run compares each
+// tile with the copy it kept from the previous run (or, with marked_only, takes
+// the caller's scaler_mark_dirty calls for it) and scales only those that
+// changed (plus their neighbours when smoothing, whose output reads one pixel
+// across the tile edge), spread over a work_pool when there are enough of them.
+// SCALER_SMOOTH is Scale2x/Scale3x (AdvMAME), 4x being Scale2x twice: it keeps the
+// game's flat colors and only rounds off stair steps, unlike bilinear stretching.
+// The Scale2x and nearest 2x kernels use SSE2 when the compiler targets it
+// (x86-64 always does), plain C otherwise.
+
+#define SCALER_TILE 32
+#define SCALER_MAX_SCALE 4
+
+typedef enum {
+    SCALER_NEAREST,
+    SCALER_SMOOTH
+} ScalerFilter;
+
+typedef struct {
+    int x, y, w, h;
+} ScalerRect;
+
+typedef struct {
+    int src_w, src_h;
+    int scale;
+    ScalerFilter filter;
+    int threads;              // Most workers per run; 0 = one per processor
+    int out_w, out_h;
+    uint32_t* out;            // out_w x out_h, what scaler_run has scaled so far
+    // Tiles
+    int tiles_x, tiles_y;
+    uint8_t* dirty;           // Per tile, set by scaler_mark_dirty or the comparison
+    int* dirty_list;          // Tiles to scale in this run
+    uint32_t* previous;       // src as of the last run, to find the changed tiles
+    bool compare;             // False until the first run: everything is dirty
+    bool marked_only;         // The caller marks every change; skip the comparison
+    // Per worker, for 4x smoothing: a tile plus a 1 pixel ring at 2x
+    uint32_t* scratch;
+    size_t scratch_pixels;
+    int last_tiles;           // Tiles scaled by the last run
+} Scaler;
+
+// src_w x src_h in, scale (1..SCALER_MAX_SCALE) times that out. False if out of memory.
+bool scaler_init(Scaler* s, int src_w, int src_h, int scale, ScalerFilter filter, int threads);
+void scaler_free(Scaler* s);
+
+// Largest scale whose output fits avail_w x avail_h, at least 1
+int scaler_fit_scale(int src_w, int src_h, int avail_w, int avail_h);
+
+// Scales the rect on the next run even if it looks unchanged
+void scaler_mark_dirty(Scaler* s, int x, int y, int w, int h);
+void scaler_invalidate(Scaler* s);
+
+// Brings s->out up to date with src and returns the number of tiles scaled;
+// `changed` (may be NULL) gets the rect of out they cover, empty if none
+int scaler_run(Scaler* s, const uint32_t* src, ScalerRect* changed);
+
+#endif // SCALER_H
@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "batch.h"
+#include "platform.h"
+
+// Plays thousands of headless bot games across all cores and prints their stats.
+//
+//     simulate [--games n] [--threads n] [--seed n] [--level n] [--snakes n] [--lives n]
+//              [--max-ticks n] [--board WxH] [--levels file] [--csv results.csv] [--scaling]
+//
+// --levels plays on the walls the level file (src/levels.txt) gives --level.
+//
+// --scaling repeats the batch on 1, 2, 4, ... threads up to --threads (default: all
+// processors) and reports the speed-up over one thread.
+
+static void print_stats(const BatchStats* s) {
+    double games = s->games > 0 ? (double)s->games : 1.0;
+    uint64_t attempts = s->claims + s->failed_claims;
+    printf("games            %d on %d threads, %.3f s (%.0f games/s, %.2f M ticks/s)\n",
+           s->games, s->threads, s->seconds, s->games / s->seconds, (double)s->ticks / s->seconds * 1e-6);
+    printf("won              %.1f%%\n", 100.0 * s->won / games);
+    printf("claimed          %.1f%% of the board on average\n", s->claimed_percent_mean);
+    printf("claims           %.1f per game, %.1f%% of attempts succeeded\n",
+           (double)s->claims / games, attempts ? 100.0 * (double)s->claims / (double)attempts : 0.0);
+    printf("deaths           %.2f per game\n", (double)s->deaths / games);
+    printf("snakes killed    %.2f per game\n", (double)s->snakes_killed / games);
+    printf("ticks            %.0f per game\n", (double)s->ticks / games);
+}
+
+static bool write_csv(const char* path, const GameResult* results, int games) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "game,ticks,claims,failed_claims,deaths,snakes_killed,claimed_percent,won\n");
+    for (int i = 0; i < games; i++) {
+        const GameResult* r = &results[i];
+        fprintf(f, "%d,%u,%d,%d,%d,%d,%.2f,%d\n", i, r->ticks, r->claims, r->failed_claims,
+                r->deaths, r->snakes_killed, r->claimed_percent, r->won ? 1 : 0);
+    }
+    return fclose(f) == 0;
+}
+
+int main(int argc, char** argv) {
+    BatchConfig config;
+    batch_default_config(&config);
+    int games = 1000;
+    int threads = 0;
+    const char* csv_path = NULL;
+    const char* levels_path = NULL;
+    bool scaling = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) games = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) config.seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) config.level = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--snakes") == 0 && i + 1 < argc) config.snakes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--lives") == 0 && i + 1 < argc) config.lives = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) config.max_ticks = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csv_path = argv[++i];
+        else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc) levels_path = argv[++i];
+        else if (strcmp(argv[i], "--scaling") == 0) scaling = true;
+        else if (strcmp(argv[i], "--board") == 0 && i + 1 < argc &&
+                 sscanf(argv[++i], "%dx%d", &config.board_w, &config.board_h) == 2) {}
+        else {
+            fprintf(stderr, "usage: %s [--games n] [--threads n] [--seed n] [--level n] [--snakes n] [--lives n]\n"
+                            "       [--max-ticks n] [--board WxH] [--levels file] [--csv results.csv] [--scaling]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (games < 1) games = 1;
+    if (config.level < 1) config.level = 1;
+    if (config.level > 10) config.level = 10;
+    if (config.snakes < 0) config.snakes = 0;
+    if (config.lives < 1) config.lives = 1;
+    if (threads <= 0) threads = platform_cpu_count();
+
+    LevelSet levels = {0};
+    char error[128];
+    if (levels_path && !level_set_load(&levels, levels_path, error, sizeof(error))) {
+        fprintf(stderr, "%s: %s\n", levels_path, error);
+        return 1;
+    }
+    config.layout = level_set_find(&levels, config.level);
+
+    GameResult* results = malloc((size_t)games * sizeof(GameResult));
+    if (!results) {
+        fprintf(stderr, "Out of memory for %d games\n", games);
+        level_set_free(&levels);
+        return 1;
+    }
+
+    BatchStats stats;
+    if (scaling) {
+        double single = 0.0;
+        for (int t = 1;; t = t * 2 < threads ? t * 2 : threads) {
+            if (!batch_run(&config, games, t, results, &stats)) break;
+            if (t == 1) single = stats.seconds;
+            printf("%3d threads  %8.3f s  %8.0f games/s  speed-up %.2fx\n",
+                   t, stats.seconds, games / stats.seconds, single / stats.seconds);
+            if (t == threads) break;
+        }
+    }
+    if (!batch_run(&config, games, threads, results, &stats)) {
+        fprintf(stderr, "Out of memory for a %dx%d board\n", config.board_w, config.board_h);
+        free(results);
+        level_set_free(&levels);
+        return 1;
+    }
+    print_stats(&stats);
+
+    if (csv_path && !write_csv(csv_path, results, games)) {
+        fprintf(stderr, "Cannot write %s\n", csv_path);
+        free(results);
+        level_set_free(&levels);
+        return 1;
+    }
+    free(results);
+    level_set_free(&levels);
+    return 0;
+}
@@ -0,0 +1,228 @@
+#include "snake.h"
+
+#include <string.h> // For memcpy
+#include "trace.h"
+
+static void play_sound(SoundId id) {
+    if (game_sound_handler) game_sound_handler(id);
+}
+
+static const int dir_dx[4] = { 0, 1, 0, -1 };
+static const int dir_dy[4] = { -1, 0, 1, 0 };
+
+// --- START: Board Queries ---
+// Whether a finished line (past_path) or, with `current`, the path being drawn runs
+// along side `dir` of cell (x, y). The outer border counts as a finished line.
+static bool cell_side_has_line(const Game* g, int x, int y, int dir, bool current) {
+    const uint8_t* h_edges = current ? g->path_h : g->past_path_h;
+    const uint8_t* v_edges = current ? g->path_v : g->past_path_v;
+    switch (dir) {
+        case SNAKE_UP:    return h_edges[y * g->w + x] != 0;
+        case SNAKE_DOWN:  return h_edges[(y + 1) * g->w + x] != 0;
+        case SNAKE_LEFT:  return v_edges[y * (g->w + 1) + x] != 0;
+        default:          return v_edges[y * (g->w + 1) + x + 1] != 0;
+    }
+}
+
+// FUN_1038_1bb6: the neighbour in `dir` is on the board, unclaimed, free of snakes
+// and not behind a finished line
+static bool can_enter(const Game* g, int x, int y, int dir) {
+    int nx = x + dir_dx[dir], ny = y + dir_dy[dir];
+    if (nx < 0 || nx >= g->w || ny < 0 || ny >= g->h) return false;
+    if (GAME_CLAIMED(g, nx, ny) || GAME_SNAKE_CELL(g, nx, ny)) return false;
+    return !cell_side_has_line(g, x, y, dir, false);
+}
+
+// Marks in danger_bits the cells whose outline the drawing spider is on: one on
+// an edge's side, two across an edge, four around a vertex. Done once per step of
+// all snakes; the spider does not move in between.
+static void mark_danger(Game* g) {
+    uint32_t* cells = g->danger_cells;
+    for (uint32_t i = 1; i <= cells[0]; i++) g->danger_bits[cells[i] >> 6] &= ~(1ull << (cells[i] & 63));
+    cells[0] = 0;
+    if (g->spider_state != SPIDER_DRAWING_PATH) return;
+
+    // Cell x qualifies when x * CELL_PITCH <= spider_x <= (x + 1) * CELL_PITCH
+    int x1 = g->spider_x / CELL_PITCH, y1 = g->spider_y / CELL_PITCH;
+    int x0 = g->spider_x % CELL_PITCH == 0 ? x1 - 1 : x1;
+    int y0 = g->spider_y % CELL_PITCH == 0 ? y1 - 1 : y1;
+    for (int y = y0; y <= y1; y++) {
+        if (y < 0 || y >= g->h) continue;
+        for (int x = x0; x <= x1; x++) {
+            if (x < 0 || x >= g->w) continue;
+            uint32_t cell = (uint32_t)(y * g->w + x);
+            g->danger_bits[cell >> 6] |= 1ull << (cell & 63);
+            cells[++cells[0]] = cell;
+        }
+    }
+}
+
+// The spider, still drawing, is on the outline of the cell
+static bool spider_touches_cell(const Game* g, int cell) {
+    return g->spider_state == SPIDER_DRAWING_PATH && GAME_DANGER(g, cell);
+}
+// --- END: Board Queries ---
+
+// --- START: Movement ---
+// A random direction one time in three, otherwise `current` (FUN_1038_16d2's wander)
+static int wander(Game* g, int current) {
+    if (game_random(g) % 3 != 0) return current;
+    return game_random(g) % 4;
+}
+
+// FUN_1038_16d2. Positions are compared on the original's fine grid, where cells
+// sit at odd and lines at even coordinates, so the distance thresholds match.
+static int choose_direction(Game* g, Snake* s) {
+    const SnakeSegment* head = &s->segments[s->head];
+    int x = head->x, y = head->y;
+    int current = head->dir;
+
+    if (s->grown < SNAKE_LENGTH) { // Still coming out of its hole: straight on
+        s->grown++;
+        return current;
+    }
+    if (g->level <= 0) return wander(g, current);
+
+    // Go for the line being drawn if it runs along the head
+    if (cell_side_has_line(g, x, y, SNAKE_LEFT, true)) return SNAKE_LEFT;
+    if (cell_side_has_line(g, x, y, SNAKE_RIGHT, true)) return SNAKE_RIGHT;
+    if (cell_side_has_line(g, x, y, SNAKE_UP, true)) return SNAKE_UP;
+    if (cell_side_has_line(g, x, y, SNAKE_DOWN, true)) return SNAKE_DOWN;
+
+    int head_fx = 2 * x + 1, head_fy = 2 * y + 1;
+    int spider_fx = 2 * g->spider_x / CELL_PITCH, spider_fy = 2 * g->spider_y / CELL_PITCH;
+    int dx = spider_fx < head_fx ? head_fx - spider_fx : spider_fx - head_fx;
+    int dy = spider_fy < head_fy ? head_fy - spider_fy : spider_fy - head_fy;
+
+    // Chasing skill 1..3, repeating every three levels
+    int skill = (g->level - 1) % 3 + 1;
+    if (dx + dy > skill * 3) {
+        int odds = g->spider_state == SPIDER_DRAWING_PATH ? 24 : 36;
+        if (game_random(g) % odds >= skill) return wander(g, current);
+    }
+
+    int toward_x = spider_fx < head_fx ? SNAKE_LEFT : SNAKE_RIGHT;
+    int toward_y = spider_fy < head_fy ? SNAKE_UP : SNAKE_DOWN;
+    int r1 = game_random(g), r2 = game_random(g);
+    bool horizontal_first = r2 % (dy + 1) < r1 % 191;
+    int first = horizontal_first ? toward_x : toward_y;
+    int second = horizontal_first ? toward_y : toward_x;
+    if (can_enter(g, x, y, first)) return first;
+    if (can_enter(g, x, y, second)) return second;
+    return wander(g, current);
+}
+
+// FUN_1038_1d0e: a full-grown snake with nowhere to go turns around in place
+static void reverse(Snake* s) {
+    if (s->grown < SNAKE_LENGTH) return;
+    SnakeSegment old[SNAKE_LENGTH];
+    memcpy(old, s->segments, sizeof(old));
+    int src = s->head, dst = s->tail;
+    for (int i = 0; i < SNAKE_LENGTH; i++) {
+        int behind = (src + SNAKE_LENGTH - 1) % SNAKE_LENGTH;
+        s->segments[dst] = old[src];
+        s->segments[dst].dir = (uint8_t)((old[behind].dir + 2) % 4);
+        src = behind;
+        dst = (dst + 1) % SNAKE_LENGTH;
+    }
+    s->segments[s->head].dir = (uint8_t)((old[s->tail].dir + 2) % 4);
+}
+
+// FUN_1038_0ffc
+static void snake_step(Game* g, Snake* s) {
+    int x = s->segments[s->head].x, y = s->segments[s->head].y;
+
+    if (!can_enter(g, x, y, SNAKE_UP) && !can_enter(g, x, y, SNAKE_RIGHT) &&
+        !can_enter(g, x, y, SNAKE_DOWN) && !can_enter(g, x, y, SNAKE_LEFT)) {
+        reverse(s);
+    } else {
+        if (s->grown == 1) play_sound(SOUND_SNAKE_STEP);
+        if (s->grown == SNAKE_LENGTH) { // Tail moves up first, so the head may follow it
+            const SnakeSegment* tail = &s->segments[s->tail];
+            game_add_snake_cell(g, tail->x, tail->y, -1);
+            s->tail = (uint8_t)((s->tail + 1) % SNAKE_LENGTH);
+        }
+
+        int dir = choose_direction(g, s);
+        if (!can_enter(g, x, y, dir)) {
+            dir = game_random(g) % 4;
+            while (!can_enter(g, x, y, dir)) dir = (dir + 1) % 4;
+        }
+        // Biting through the line being drawn catches the spider
+        if (cell_side_has_line(g, x, y, dir, true)) game_spider_hit(g);
+
+        s->segments[s->head].dir = (uint8_t)dir;
+        s->head = (uint8_t)((s->head + 1) % SNAKE_LENGTH);
+        SnakeSegment* head = &s->segments[s->head];
+        head->x = (int16_t)(x + dir_dx[dir]);
+        head->y = (int16_t)(y + dir_dy[dir]);
+        head->dir = (uint8_t)dir;
+        game_add_snake_cell(g, head->x, head->y, 1);
+    }
+
+    const SnakeSegment* head = &s->segments[s->head];
+    if (spider_touches_cell(g, head->y * g->w + head->x)) game_spider_hit(g);
+}
+// --- END: Movement ---
+
+void snakes_spawn(Game* g, int count) {
+    if (count > g->snake_capacity) count = g->snake_capacity;
+    for (int i = 0; i < count; i++) {
+        Snake* s = &g->snakes[g->snake_count];
+        int cells = g->w * g->h;
+        int cell = -1;
+        for (int attempt = 0; attempt < 64 && cell < 0; attempt++) {
+            int c = (int)(((uint32_t)game_random(g) << 15 | (uint32_t)game_random(g)) % (uint32_t)cells);
+            if (!g->claimed[c] && !g->snake_cells[c]) cell = c;
+        }
+        for (int c = 0; c < cells && cell < 0; c++) { // Crowded board
+            if (!g->claimed[c] && !g->snake_cells[c]) cell = c;
+        }
+        if (cell < 0) return;
+
+        memset(s, 0, sizeof(*s));
+        s->grown = 1;
+        s->alive = true;
+        s->segments[0].x = (int16_t)(cell % g->w);
+        s->segments[0].y = (int16_t)(cell / g->w);
+        s->segments[0].dir = (uint8_t)(game_random(g) % 4);
+        game_add_snake_cell(g, cell % g->w, cell / g->w, 1);
+        g->snake_count++;
+    }
+}
+
+void snakes_step(Game* g) {
+    int stepped = 0;
+    mark_danger(g);
+    for (int i = 0; i < g->snake_count; i++) {
+        if (!g->snakes[i].alive) continue;
+        snake_step(g, &g->snakes[i]);
+        stepped++;
+    }
+    TRACE_COUNT(TRACE_COUNTER_SNAKES_STEPPED, stepped);
+}
+
+void snakes_kill_in_region(Game* g, const Region* region, int label) {
+    for (int i = 0; i < g->snake_count; i++) {
+        Snake* s = &g->snakes[i];
+        if (!s->alive) continue;
+        const SnakeSegment* head = &s->segments[s->head];
+        if (head->x < region->min_x || head->x > region->max_x ||
+            head->y < region->min_y || head->y > region->max_y) continue;
+        if (g->region_labels[head->y * g->w + head->x] != label) continue;
+
+        for (int k = s->tail;; k = (k + 1) % SNAKE_LENGTH) {
+            game_add_snake_cell(g, s->segments[k].x, s->segments[k].y, -1);
+            if (k == s->head) break;
+        }
+        s->alive = false;
+        g->snakes_killed++;
+        play_sound(SOUND_SNAKE_KILLED);
+    }
+}
+
+int snakes_alive(const Game* g) {
+    int alive = 0;
+    for (int i = 0; i < g->snake_count; i++) alive += g->snakes[i].alive;
+    return alive;
+}
@@ -0,0 +1,24 @@
+#ifndef SNAKE_H
+#define SNAKE_H
+
+#include <stdbool.h>
+#include "game.h"
+
+// The snakes of the original (FUN_1038_0ffc and its helpers), moved from the
+// original's fine grid onto the remake's cells.
+//
+// A snake's segments occupy free cells (counted in Game.snake_cells) and it never
+// crosses a finished line. Crossing the line the spider is drawing, or having its
+// head touch the drawing spider, is a hit (game_spider_hit). Snakes left inside a
+// claimed area die. All randomness comes from game_random, so a seeded game
+// replays exactly.
+
+// Places `count` (at most Game.snake_capacity) newborn snakes on random free cells
+void snakes_spawn(Game* g, int count);
+// Moves every live snake one cell
+void snakes_step(Game* g);
+// Kills the snakes whose head is in the region just claimed with `label`
+void snakes_kill_in_region(Game* g, const Region* region, int label);
+int snakes_alive(const Game* g);
+
+#endif // SNAKE_H
@@ -0,0 +1,200 @@
+#include "snapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PAGES_PER_CHUNK 256
+
+struct SnapshotPool {
+    size_t page_size;
+    size_t state_bytes;      // game_state_bytes of the pool's games
+    int pages_per_snapshot;
+    uint8_t* scratch;        // One flat state
+
+    // Pages live in chunks of PAGES_PER_CHUNK, found by id
+    uint8_t** chunks;
+    int chunk_count;
+    uint32_t* refs;          // Per page; 0 = free
+    int32_t* next_free_page;
+    int32_t free_page;
+    int page_capacity;
+    int pages_in_use;
+
+    // Snapshot i uses page ids pages[i * pages_per_snapshot ...]
+    int32_t* pages;
+    uint8_t* live;
+    int32_t* next_free_snapshot;
+    int32_t free_snapshot;
+    int snapshot_capacity;
+    int snapshot_count;
+};
+
+static uint8_t* page_data(const SnapshotPool* pool, int32_t page) {
+    return pool->chunks[page / PAGES_PER_CHUNK] + (size_t)(page % PAGES_PER_CHUNK) * pool->page_size;
+}
+
+SnapshotPool* snapshot_pool_create(const Game* g, size_t page_size) {
+    SnapshotPool* pool = calloc(1, sizeof(SnapshotPool));
+    if (!pool) return NULL;
+    pool->page_size = page_size ? page_size : SNAPSHOT_DEFAULT_PAGE_SIZE;
+    pool->state_bytes = game_state_bytes(g);
+    pool->pages_per_snapshot = (int)((pool->state_bytes + pool->page_size - 1) / pool->page_size);
+    pool->scratch = malloc(pool->state_bytes);
+    pool->free_page = SNAPSHOT_NONE;
+    pool->free_snapshot = SNAPSHOT_NONE;
+    if (!pool->scratch) {
+        snapshot_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void snapshot_pool_destroy(SnapshotPool* pool) {
+    if (!pool) return;
+    for (int i = 0; i < pool->chunk_count; i++) free(pool->chunks[i]);
+    free(pool->chunks);
+    free(pool->refs);
+    free(pool->next_free_page);
+    free(pool->pages);
+    free(pool->live);
+    free(pool->next_free_snapshot);
+    free(pool->scratch);
+    free(pool);
+}
+
+// --- START: Pages ---
+// Adds a chunk of free pages; false if out of memory
+static bool grow_pages(SnapshotPool* pool) {
+    int capacity = pool->page_capacity + PAGES_PER_CHUNK;
+    uint8_t** chunks = realloc(pool->chunks, (size_t)(pool->chunk_count + 1) * sizeof(uint8_t*));
+    if (!chunks) return false;
+    pool->chunks = chunks;
+    uint32_t* refs = realloc(pool->refs, (size_t)capacity * sizeof(uint32_t));
+    if (!refs) return false;
+    pool->refs = refs;
+    int32_t* next = realloc(pool->next_free_page, (size_t)capacity * sizeof(int32_t));
+    if (!next) return false;
+    pool->next_free_page = next;
+    uint8_t* chunk = malloc(PAGES_PER_CHUNK * pool->page_size);
+    if (!chunk) return false;
+    pool->chunks[pool->chunk_count++] = chunk;
+
+    for (int page = capacity - 1; page >= pool->page_capacity; page--) {
+        pool->refs[page] = 0;
+        pool->next_free_page[page] = pool->free_page;
+        pool->free_page = page;
+    }
+    pool->page_capacity = capacity;
+    return true;
+}
+
+static int32_t new_page(SnapshotPool* pool, const uint8_t* data, size_t bytes) {
+    if (pool->free_page == SNAPSHOT_NONE && !grow_pages(pool)) return SNAPSHOT_NONE;
+    int32_t page = pool->free_page;
+    pool->free_page = pool->next_free_page[page];
+    pool->refs[page] = 1;
+    pool->pages_in_use++;
+    memcpy(page_data(pool, page), data, bytes);
+    return page;
+}
+
+static void drop_page(SnapshotPool* pool, int32_t page) {
+    if (--pool->refs[page]) return;
+    pool->next_free_page[page] = pool->free_page;
+    pool->free_page = page;
+    pool->pages_in_use--;
+}
+// --- END: Pages ---
+
+// --- START: Snapshots ---
+static bool is_live(const SnapshotPool* pool, SnapshotId id) {
+    return id >= 0 && id < pool->snapshot_capacity && pool->live[id];
+}
+
+static SnapshotId new_snapshot(SnapshotPool* pool) {
+    if (pool->free_snapshot == SNAPSHOT_NONE) {
+        int capacity = pool->snapshot_capacity ? pool->snapshot_capacity * 2 : 64;
+        int32_t* pages = realloc(pool->pages, (size_t)capacity * (size_t)pool->pages_per_snapshot * sizeof(int32_t));
+        if (!pages) return SNAPSHOT_NONE;
+        pool->pages = pages;
+        uint8_t* live = realloc(pool->live, (size_t)capacity);
+        if (!live) return SNAPSHOT_NONE;
+        pool->live = live;
+        int32_t* next = realloc(pool->next_free_snapshot, (size_t)capacity * sizeof(int32_t));
+        if (!next) return SNAPSHOT_NONE;
+        pool->next_free_snapshot = next;
+        for (int id = capacity - 1; id >= pool->snapshot_capacity; id--) {
+            pool->live[id] = 0;
+            pool->next_free_snapshot[id] = pool->free_snapshot;
+            pool->free_snapshot = id;
+        }
+        pool->snapshot_capacity = capacity;
+    }
+    SnapshotId id = pool->free_snapshot;
+    pool->free_snapshot = pool->next_free_snapshot[id];
+    pool->live[id] = 1;
+    pool->snapshot_count++;
+    return id;
+}
+
+SnapshotId snapshot_save(SnapshotPool* pool, const Game* g, SnapshotId base) {
+    if (game_state_bytes(g) != pool->state_bytes) return SNAPSHOT_NONE;
+    SnapshotId id = new_snapshot(pool);
+    if (id == SNAPSHOT_NONE) return SNAPSHOT_NONE;
+    if (!is_live(pool, base)) base = SNAPSHOT_NONE;
+
+    game_save_state(g, pool->scratch);
+    int32_t* pages = pool->pages + (size_t)id * (size_t)pool->pages_per_snapshot;
+    const int32_t* base_pages = base == SNAPSHOT_NONE ? NULL : pool->pages + (size_t)base * (size_t)pool->pages_per_snapshot;
+    for (int i = 0; i < pool->pages_per_snapshot; i++) {
+        size_t offset = (size_t)i * pool->page_size;
+        size_t bytes = pool->state_bytes - offset < pool->page_size ? pool->state_bytes - offset : pool->page_size;
+        const uint8_t* data = pool->scratch + offset;
+        if (base_pages && memcmp(page_data(pool, base_pages[i]), data, bytes) == 0) {
+            pages[i] = base_pages[i];
+            pool->refs[pages[i]]++;
+            continue;
+        }
+        pages[i] = new_page(pool, data, bytes);
+        if (pages[i] == SNAPSHOT_NONE) {
+            for (int k = 0; k < i; k++) drop_page(pool, pages[k]);
+            pool->live[id] = 0;
+            pool->next_free_snapshot[id] = pool->free_snapshot;
+            pool->free_snapshot = id;
+            pool->snapshot_count--;
+            return SNAPSHOT_NONE;
+        }
+    }
+    return id;
+}
+
+bool snapshot_restore(SnapshotPool* pool, SnapshotId id, Game* g) {
+    if (!is_live(pool, id) || game_state_bytes(g) != pool->state_bytes) return false;
+    const int32_t* pages = pool->pages + (size_t)id * (size_t)pool->pages_per_snapshot;
+    for (int i = 0; i < pool->pages_per_snapshot; i++) {
+        size_t offset = (size_t)i * pool->page_size;
+        size_t bytes = pool->state_bytes - offset < pool->page_size ? pool->state_bytes - offset : pool->page_size;
+        memcpy(pool->scratch + offset, page_data(pool, pages[i]), bytes);
+    }
+    game_load_state(g, pool->scratch);
+    return true;
+}
+
+void snapshot_release(SnapshotPool* pool, SnapshotId id) {
+    if (!is_live(pool, id)) return;
+    const int32_t* pages = pool->pages + (size_t)id * (size_t)pool->pages_per_snapshot;
+    for (int i = 0; i < pool->pages_per_snapshot; i++) drop_page(pool, pages[i]);
+    pool->live[id] = 0;
+    pool->next_free_snapshot[id] = pool->free_snapshot;
+    pool->free_snapshot = id;
+    pool->snapshot_count--;
+}
+
+int snapshot_pool_count(const SnapshotPool* pool) {
+    return pool->snapshot_count;
+}
+
+size_t snapshot_pool_bytes(const SnapshotPool* pool) {
+    return (size_t)pool->pages_in_use * pool->page_size;
+}
+// --- END: Snapshots ---
@@ -0,0 +1,39 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+// Many snapshots of one game's state for rewinding, rollouts and replay seeking.
+//
+// A snapshot is the flat state of game_save_state cut into fixed-size pages.
+// Saving against a base snapshot (usually the previous one) compares page by page
+// and shares every unchanged page with it, reference counted, so each snapshot
+// costs only the pages that differ: after one tick that is the page with the
+// spider fields and the few the path touched, not the whole board. Pages are
+// never written after they are filled, which is what makes sharing them safe.
+
+#define SNAPSHOT_NONE -1
+#define SNAPSHOT_DEFAULT_PAGE_SIZE 256
+
+typedef int32_t SnapshotId;
+typedef struct SnapshotPool SnapshotPool;
+
+// For games the size of g; page_size 0 = SNAPSHOT_DEFAULT_PAGE_SIZE. NULL if out of memory.
+SnapshotPool* snapshot_pool_create(const Game* g, size_t page_size);
+void snapshot_pool_destroy(SnapshotPool* pool);
+
+// Saves g sharing unchanged pages with `base` (SNAPSHOT_NONE to share nothing).
+// SNAPSHOT_NONE if out of memory or g is of another size.
+SnapshotId snapshot_save(SnapshotPool* pool, const Game* g, SnapshotId base);
+// Puts the saved state into g, which must be of the pool's size. False for an unknown id.
+bool snapshot_restore(SnapshotPool* pool, SnapshotId id, Game* g);
+// Drops a snapshot; its pages go when no other snapshot shares them
+void snapshot_release(SnapshotPool* pool, SnapshotId id);
+
+// Snapshots held, and the page memory they use between them
+int snapshot_pool_count(const SnapshotPool* pool);
+size_t snapshot_pool_bytes(const SnapshotPool* pool);
+
+#endif // SNAPSHOT_H
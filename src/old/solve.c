@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "game.h"
+#include "level.h"
+#include "platform.h"
+#include "solver.h"
+
+// Finds the fewest claims that win each level and prints them, move by move.
+//
+//     solve [--level n] [--levels file] [--beam n] [--claims n] [--target percent]
+//           [--threads n] [--board WxH] [--all-lengths]
+//
+// Levels come from the level file (default src/levels.txt), scaled to the board.
+// Without --level it solves every level in the file; a level the file does not
+// define, such as 0, is the empty board.
+
+static const char* dir_names[4] = { "up", "right", "down", "left" };
+
+static void print_result(int level, const SolverResult* r) {
+    double total = r->total_cells ? (double)r->total_cells : 1.0;
+    printf("level %d: %s %.1f%% in %d claims, %d path edges\n", level,
+           r->reached_target ? "reached" : "best", 100.0 * (r->claims ? r->claimed_after[r->claims - 1] : r->start_cells) / total,
+           r->claims, r->edges);
+    printf("  start        %5.1f%%\n", 100.0 * r->start_cells / total);
+    for (int i = 0; i < r->claims; i++) {
+        const SolverMove* m = &r->moves[i];
+        printf("  %2d  %5.1f%%  from (%d,%d):", i + 1, 100.0 * r->claimed_after[i] / total, m->x, m->y);
+        for (int leg = 0; leg < m->legs; leg++) printf(" %s %d", dir_names[m->dir[leg]], m->len[leg]);
+        printf("\n");
+    }
+    printf("  %llu candidate claims in %.3f s (%.0f per second), %llu repeated states dropped\n",
+           (unsigned long long)r->candidates, r->seconds, r->seconds > 0 ? (double)r->candidates / r->seconds : 0.0,
+           (unsigned long long)r->repeats);
+}
+
+int main(int argc, char** argv) {
+    SolverConfig config;
+    solver_default_config(&config);
+    int board_w = GAME_DEFAULT_W, board_h = GAME_DEFAULT_H;
+    int only_level = -1;
+    const char* levels_path = "src/levels.txt";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) only_level = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc) levels_path = argv[++i];
+        else if (strcmp(argv[i], "--beam") == 0 && i + 1 < argc) config.beam_width = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--claims") == 0 && i + 1 < argc) config.max_claims = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--target") == 0 && i + 1 < argc) config.target_percent = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) config.threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--all-lengths") == 0) config.all_lengths = true;
+        else if (strcmp(argv[i], "--board") == 0 && i + 1 < argc &&
+                 sscanf(argv[++i], "%dx%d", &board_w, &board_h) == 2) {}
+        else {
+            fprintf(stderr, "usage: %s [--level n] [--levels file] [--beam n] [--claims n] [--target percent]\n"
+                            "       [--threads n] [--board WxH] [--all-lengths]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (config.threads <= 0) config.threads = platform_cpu_count();
+
+    LevelSet levels;
+    char error[128];
+    if (!level_set_load(&levels, levels_path, error, sizeof(error))) {
+        fprintf(stderr, "%s: %s\n", levels_path, error);
+        return 1;
+    }
+    Game g;
+    if (!game_init(&g, board_w, board_h, 0)) {
+        fprintf(stderr, "Out of memory for a %dx%d board\n", board_w, board_h);
+        level_set_free(&levels);
+        return 1;
+    }
+    printf("%dx%d board, beam %d, up to %d claims, target %d%%, %d threads\n",
+           g.w, g.h, config.beam_width, config.max_claims, config.target_percent, config.threads);
+    int runs = only_level >= 0 ? 1 : levels.count;
+    for (int i = 0; i < runs; i++) {
+        int level = only_level >= 0 ? only_level : levels.levels[i].number;
+        initialize_game_state(&g);
+        g.level = level;
+        level_apply(&g, level_set_find(&levels, level));
+        SolverResult result;
+        if (!solver_run(&g, &config, &result)) {
+            fprintf(stderr, "Out of memory solving level %d\n", level);
+            game_free(&g);
+            level_set_free(&levels);
+            return 1;
+        }
+        print_result(level, &result);
+    }
+    game_free(&g);
+    level_set_free(&levels);
+    return 0;
+}
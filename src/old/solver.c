@@ -0,0 +1,317 @@
+#include "solver.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "platform.h"
+#include "work_pool.h"
+
+// Leg lengths tried by default; longer ones than the board are skipped
+static const uint8_t sparse_lengths[] = {
+    1, 2, 3, 4, 5, 6, 8, 10, 12, 15, 18, 22, 27, 33, 40, 50, 64, 80, 100, 128, 160, 200, 255
+};
+
+typedef struct {
+    uint64_t hash; // Game.hash after the move
+    int parent;   // Index in the beam it was expanded from
+    int claimed;
+    int edges;    // Path edges from the start, this move included
+    SolverMove move;
+} Child;
+
+typedef struct {
+    Child* items;
+    int count, capacity;
+    bool out_of_memory;
+    uint64_t candidates;
+    uint8_t* dirs;  // Move being played, one SnakeDir per edge
+    Game scratch;
+} Worker;
+
+typedef struct {
+    Game game;
+    uint64_t hash;
+    int edges;
+    int claims;
+    SolverMove moves[SOLVER_MAX_CLAIMS];
+    int claimed_after[SOLVER_MAX_CLAIMS];
+} BeamState;
+
+typedef struct {
+    uint8_t lengths[256];
+    int length_count;
+    int reach;           // Edges enough for any leg
+    BeamState* beam;
+    int beam_count;
+    Worker workers[WORK_POOL_MAX_THREADS];
+} Solver;
+
+void solver_default_config(SolverConfig* config) {
+    memset(config, 0, sizeof(*config));
+    config->beam_width = 16;
+    config->max_claims = 24;
+    config->target_percent = GAME_WIN_PERCENT;
+    config->threads = 0;
+    config->all_lengths = false;
+}
+
+// --- START: Transposition Table ---
+// Open addressing over `mask + 1` slots of Game.hash values; true if the hash was
+// there already
+static bool table_insert(uint64_t* table, size_t mask, uint64_t hash) {
+    if (!hash) hash = 1; // 0 marks an empty slot
+    for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask) {
+        if (table[i] == hash) return true;
+        if (!table[i]) {
+            table[i] = hash;
+            return false;
+        }
+    }
+}
+// --- END: Transposition Table ---
+
+// --- START: Moves ---
+// Writes the move's directions; the last leg runs `reach` edges unless len says otherwise
+static int move_dirs(const SolverMove* m, uint8_t* dirs, int reach, bool open_end) {
+    int n = 0;
+    for (int leg = 0; leg < m->legs; leg++) {
+        int len = open_end && leg == m->legs - 1 ? reach : m->len[leg];
+        for (int i = 0; i < len; i++) dirs[n++] = m->dir[leg];
+    }
+    return n;
+}
+
+// Between moves a board differs from its parent only in claimed cells and walls,
+// which lead the block, so that is all a scratch board needs back
+static void restore_board(Game* dst, const Game* src) {
+    memcpy(dst->claimed, src->claimed, (size_t)(src->path_h - src->claimed));
+    dst->claimed_cell_count = src->claimed_cell_count;
+    dst->hash = src->hash;
+}
+
+// Plays the move on a copy of the parent and records it if it claimed anything.
+// Returns the edges it used, 0 if the path never closed.
+static int try_move(Solver* s, Worker* wk, int parent_index, SolverMove* m) {
+    const BeamState* parent = &s->beam[parent_index];
+    Game* g = &wk->scratch;
+    restore_board(g, &parent->game);
+    int used = game_play_path(g, m->x, m->y, wk->dirs, move_dirs(m, wk->dirs, s->reach, true));
+    wk->candidates++;
+    if (!used || g->claimed_cell_count <= parent->game.claimed_cell_count) return used;
+
+    if (wk->count == wk->capacity) {
+        int capacity = wk->capacity ? wk->capacity * 2 : 4096;
+        Child* items = realloc(wk->items, (size_t)capacity * sizeof(Child));
+        if (!items) {
+            wk->out_of_memory = true;
+            return used;
+        }
+        wk->items = items;
+        wk->capacity = capacity;
+    }
+    Child* c = &wk->items[wk->count++];
+    c->hash = g->hash;
+    c->parent = parent_index;
+    c->claimed = g->claimed_cell_count;
+    c->edges = parent->edges + used;
+    c->move = *m;
+    // Trim the legs to what was drawn before the path closed
+    int left = used;
+    for (int leg = 0; leg < m->legs; leg++) {
+        int len = leg == m->legs - 1 || m->len[leg] > left ? left : m->len[leg];
+        c->move.len[leg] = (uint8_t)len;
+        left -= len;
+        if (!left) {
+            c->move.legs = (uint8_t)(leg + 1);
+            break;
+        }
+    }
+    return used;
+}
+
+static void expand_state(void* ctx, int index, int worker) {
+    Solver* s = ctx;
+    Worker* wk = &s->workers[worker];
+    const Game* from = &s->beam[index].game;
+
+    for (int vy = 0; vy <= from->h; vy++) {
+        for (int vx = 0; vx <= from->w; vx++) {
+            for (int d = 0; d < 4; d++) {
+                if (!game_can_start_path(from, vx, vy, d)) continue;
+                SolverMove m = { (int16_t)vx, (int16_t)vy, 1, { (uint8_t)d }, { 0 } };
+                try_move(s, wk, index, &m); // Straight cut
+
+                // Boxes: out k, sideways j, back. Once the path closes on an earlier
+                // leg, longer legs give the same move again.
+                m.legs = 3;
+                m.dir[2] = (uint8_t)((d + 2) & 3);
+                bool closed_going_out = false;
+                for (int ki = 0; ki < s->length_count && !closed_going_out; ki++) {
+                    m.len[0] = s->lengths[ki];
+                    for (int side = 1; side <= 3 && !closed_going_out; side += 2) {
+                        m.dir[1] = (uint8_t)((d + side) & 3);
+                        for (int ji = 0; ji < s->length_count; ji++) {
+                            m.len[1] = s->lengths[ji];
+                            int used = try_move(s, wk, index, &m);
+                            if (!used) continue;
+                            if (used <= m.len[0]) closed_going_out = true;
+                            if (used <= m.len[0] + m.len[1]) break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+// --- END: Moves ---
+
+// --- START: Search ---
+static int compare_children(const void* a, const void* b) {
+    const Child* x = a;
+    const Child* y = b;
+    if (x->claimed != y->claimed) return x->claimed > y->claimed ? -1 : 1;
+    if (x->edges != y->edges) return x->edges < y->edges ? -1 : 1;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    if (x->parent != y->parent) return x->parent < y->parent ? -1 : 1;
+    // Same order on any number of threads
+    const SolverMove* mx = &x->move;
+    const SolverMove* my = &y->move;
+    if (mx->y != my->y) return mx->y < my->y ? -1 : 1;
+    if (mx->x != my->x) return mx->x < my->x ? -1 : 1;
+    if (mx->legs != my->legs) return mx->legs < my->legs ? -1 : 1;
+    int order = memcmp(mx->dir, my->dir, sizeof(mx->dir));
+    return order ? order : memcmp(mx->len, my->len, sizeof(mx->len));
+}
+
+static bool reaches(const Game* g, int percent) {
+    return g->claimed_cell_count * 100 >= g->total_cells * percent;
+}
+
+bool solver_run(const Game* start, const SolverConfig* config, SolverResult* result) {
+    memset(result, 0, sizeof(*result));
+    result->start_cells = start->claimed_cell_count;
+    result->total_cells = start->total_cells;
+
+    int threads = config->threads > 0 ? config->threads : platform_cpu_count();
+    if (threads > WORK_POOL_MAX_THREADS) threads = WORK_POOL_MAX_THREADS;
+    int width = config->beam_width > 0 ? config->beam_width : 1;
+    int depth = config->max_claims < 1 ? 1 : config->max_claims > SOLVER_MAX_CLAIMS ? SOLVER_MAX_CLAIMS : config->max_claims;
+    int w = start->w, h = start->h;
+
+    Solver* s = calloc(1, sizeof(Solver));
+    if (!s) return false;
+    s->reach = (w > h ? w : h) + 1;
+    if (config->all_lengths) {
+        for (int len = 1; len < s->reach && len <= 255; len++) s->lengths[s->length_count++] = (uint8_t)len;
+    } else {
+        for (int i = 0; i < (int)sizeof(sparse_lengths) && sparse_lengths[i] < s->reach; i++) {
+            s->lengths[s->length_count++] = sparse_lengths[i];
+        }
+    }
+
+    size_t table_size = 1024;
+    while (table_size < (size_t)width * (size_t)(depth + 1) * 4) table_size *= 2;
+    uint64_t* table = calloc(table_size, sizeof(uint64_t));
+    BeamState* beams = calloc((size_t)width * 2, sizeof(BeamState));
+    Child* merged = NULL;
+    int merged_capacity = 0;
+    bool ok = table && beams;
+    for (int i = 0; ok && i < width * 2; i++) ok = game_init(&beams[i].game, w, h, start->snake_capacity);
+    for (int i = 0; ok && i < threads; i++) {
+        ok = game_init(&s->workers[i].scratch, w, h, start->snake_capacity) &&
+             (s->workers[i].dirs = malloc((size_t)s->reach * 3)) != NULL;
+    }
+
+    uint64_t t0 = platform_time_ns();
+    BeamState* beam = beams;
+    BeamState* next = beams + width;
+    if (ok) {
+        game_copy(&beam[0].game, start);
+        beam[0].hash = start->hash;
+        table_insert(table, table_size - 1, beam[0].hash);
+        s->beam = beam;
+        s->beam_count = 1;
+    }
+
+    bool reached = ok && reaches(start, config->target_percent);
+    for (int level = 0; ok && !reached && level < depth; level++) {
+        for (int i = 0; i < threads; i++) s->workers[i].count = 0;
+        work_pool_run(threads, s->beam_count, expand_state, s);
+
+        int total = 0;
+        for (int i = 0; i < threads; i++) {
+            if (s->workers[i].out_of_memory) ok = false;
+            total += s->workers[i].count;
+        }
+        if (!ok || total == 0) break;
+        if (total > merged_capacity) {
+            Child* grown = realloc(merged, (size_t)total * sizeof(Child));
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            merged = grown;
+            merged_capacity = total;
+        }
+        total = 0;
+        for (int i = 0; i < threads; i++) {
+            if (s->workers[i].count == 0) continue; // items may still be NULL
+            memcpy(merged + total, s->workers[i].items, (size_t)s->workers[i].count * sizeof(Child));
+            total += s->workers[i].count;
+        }
+        qsort(merged, (size_t)total, sizeof(Child), compare_children);
+
+        // Best children first, each state once; replay their moves to get the boards
+        int kept = 0;
+        for (int i = 0; i < total && kept < width; i++) {
+            const Child* c = &merged[i];
+            if (table_insert(table, table_size - 1, c->hash)) {
+                result->repeats++;
+                continue;
+            }
+            const BeamState* parent = &beam[c->parent];
+            BeamState* b = &next[kept++];
+            game_copy(&b->game, &parent->game);
+            uint8_t* dirs = s->workers[0].dirs;
+            game_play_path(&b->game, c->move.x, c->move.y, dirs, move_dirs(&c->move, dirs, s->reach, false));
+            b->hash = c->hash;
+            b->edges = c->edges;
+            b->claims = parent->claims + 1;
+            memcpy(b->moves, parent->moves, (size_t)parent->claims * sizeof(SolverMove));
+            memcpy(b->claimed_after, parent->claimed_after, (size_t)parent->claims * sizeof(int));
+            b->moves[parent->claims] = c->move;
+            b->claimed_after[parent->claims] = b->game.claimed_cell_count;
+        }
+        if (kept == 0) break;
+        BeamState* swap = beam;
+        beam = next;
+        next = swap;
+        s->beam = beam;
+        s->beam_count = kept;
+        reached = reaches(&beam[0].game, config->target_percent);
+    }
+    result->seconds = (double)(platform_time_ns() - t0) * 1e-9;
+
+    if (ok) {
+        const BeamState* best = &beam[0];
+        result->claims = best->claims;
+        memcpy(result->moves, best->moves, (size_t)best->claims * sizeof(SolverMove));
+        memcpy(result->claimed_after, best->claimed_after, (size_t)best->claims * sizeof(int));
+        result->edges = best->edges;
+        result->reached_target = reached;
+    }
+    for (int i = 0; i < WORK_POOL_MAX_THREADS; i++) {
+        result->candidates += s->workers[i].candidates;
+        if (s->workers[i].scratch.block) game_free(&s->workers[i].scratch);
+        free(s->workers[i].dirs);
+        free(s->workers[i].items);
+    }
+    for (int i = 0; beams && i < width * 2; i++) {
+        if (beams[i].game.block) game_free(&beams[i].game);
+    }
+    free(merged);
+    free(beams);
+    free(table);
+    free(s);
+    return ok;
+}
+// --- END: Search ---
@@ -0,0 +1,57 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+
+// Searches for the fewest claims that win a level, for level analysis.
+//
+// A move is a path drawn from claimed ground in up to three straight legs: out,
+// sideways and back (a straight cut is one leg, an L two, a box three). Moves are
+// played with game_play_path, so the game's own claim rules decide what they
+// take; snakes and timing are left out, which makes the result the geometric
+// best case of a level.
+//
+// Beam search: each depth expands every state of the beam with every move from
+// every vertex on claimed ground, one state per job on the work pool, and keeps
+// the beam_width children with the most claimed cells (then the shortest paths).
+// A transposition table of Game.hash values drops children that repeat a state
+// kept before, whatever order of claims led there.
+
+#define SOLVER_MAX_CLAIMS 64
+
+typedef struct {
+    int16_t x, y;    // Start vertex
+    uint8_t legs;    // 1..3
+    uint8_t dir[3];  // SnakeDir of each leg
+    uint8_t len[3];  // Edges of each leg
+} SolverMove;
+
+typedef struct {
+    int beam_width;
+    int max_claims;     // Search depth, at most SOLVER_MAX_CLAIMS
+    int target_percent; // Stop at the first depth where a state reaches it
+    int threads;        // 0 = one per processor
+    bool all_lengths;   // Try every leg length instead of a sparse set
+} SolverConfig;
+
+typedef struct {
+    int claims;
+    SolverMove moves[SOLVER_MAX_CLAIMS];
+    int claimed_after[SOLVER_MAX_CLAIMS]; // Claimed cells after each move
+    int start_cells;      // Claimed before the first move (level walls)
+    int total_cells;
+    int edges;            // Path edges drawn over all moves
+    bool reached_target;
+    uint64_t candidates;  // Moves played
+    uint64_t repeats;     // Children dropped by the transposition table
+    double seconds;
+} SolverResult;
+
+void solver_default_config(SolverConfig* config);
+
+// Searches from `start` (idle spider, no path). False if out of memory.
+bool solver_run(const Game* start, const SolverConfig* config, SolverResult* result);
+
+#endif // SOLVER_H
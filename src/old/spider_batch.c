@@ -0,0 +1,204 @@
+#include "spider_batch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// x / 12 as (x * 0xAAAB) >> 19, exact for 0 <= x < 70000 (a 1024-cell board
+// is 12288 pixels wide); SIMD has no integer divide
+#define DIV_PITCH_MUL 0xAAAB
+#define DIV_PITCH_SHIFT 19
+
+// --- START: Allocation ---
+bool spider_batch_init(SpiderBatch* b, Game** games, int count) {
+    memset(b, 0, sizeof(*b));
+    if (count <= 0) return false;
+    b->count = count;
+    b->lanes = (count + SPIDER_BATCH_WIDTH - 1) / SPIDER_BATCH_WIDTH * SPIDER_BATCH_WIDTH;
+
+    // Six lane arrays, each 64-byte aligned, then the game pointers
+    size_t array = ((size_t)b->lanes * sizeof(int32_t) + 63) & ~(size_t)63;
+    b->block = malloc(64 + 6 * array + (size_t)count * sizeof(Game*));
+    if (!b->block) return false;
+    uint8_t* base = (uint8_t*)(((uintptr_t)b->block + 63) & ~(uintptr_t)63);
+    int32_t** arrays[6] = { &b->x, &b->y, &b->vx, &b->vy, &b->intent, &b->state };
+    for (int i = 0; i < 6; i++) *arrays[i] = (int32_t*)(base + (size_t)i * array);
+    b->games = (Game**)(base + 6 * array);
+    memcpy(b->games, games, (size_t)count * sizeof(Game*));
+
+    b->max_x = games[0]->w * CELL_PITCH;
+    b->max_y = games[0]->h * CELL_PITCH;
+    for (int lane = count; lane < b->lanes; lane++) {
+        // Parked mid-edge, drawing, not moving: always on the vector path, never changes
+        b->x[lane] = 1;
+        b->y[lane] = 1;
+        b->vx[lane] = b->vy[lane] = 0;
+        b->intent[lane] = 0;
+        b->state[lane] = SPIDER_DRAWING_PATH;
+    }
+    spider_batch_load(b);
+    return true;
+}
+
+void spider_batch_free(SpiderBatch* b) {
+    free(b->block);
+    memset(b, 0, sizeof(*b));
+}
+// --- END: Allocation ---
+
+static void load_lane(SpiderBatch* b, int lane) {
+    const Game* g = b->games[lane];
+    b->x[lane] = g->spider_x;
+    b->y[lane] = g->spider_y;
+    b->vx[lane] = g->spider_vx;
+    b->vy[lane] = g->spider_vy;
+    b->intent[lane] = g->input_vx_intent | g->input_vy_intent;
+    b->state[lane] = g->spider_state;
+}
+
+static void store_lane(const SpiderBatch* b, int lane) {
+    Game* g = b->games[lane];
+    g->spider_x = b->x[lane];
+    g->spider_y = b->y[lane];
+    g->spider_vx = b->vx[lane];
+    g->spider_vy = b->vy[lane];
+}
+
+void spider_batch_load(SpiderBatch* b) {
+    for (int lane = 0; lane < b->count; lane++) load_lane(b, lane);
+}
+
+void spider_batch_store(const SpiderBatch* b) {
+    for (int lane = 0; lane < b->count; lane++) store_lane(b, lane);
+}
+
+// --- START: Vector Step ---
+// Each step_* moves the lanes [base, base + SPIDER_BATCH_WIDTH) that need nothing
+// but the add and clamp, and returns a bit mask of the others. A lane needs
+// update_spider if it is on a vertex before or after the move, has an intent
+// queued, is idle, or is about to go idle (moving with no velocity).
+#if defined(__AVX512F__)
+
+static __mmask16 on_vertex_512(__m512i x, __m512i y) {
+    const __m512i mul = _mm512_set1_epi32(DIV_PITCH_MUL);
+    const __m512i pitch = _mm512_set1_epi32(CELL_PITCH);
+    __m512i qx = _mm512_srli_epi32(_mm512_mullo_epi32(x, mul), DIV_PITCH_SHIFT);
+    __m512i qy = _mm512_srli_epi32(_mm512_mullo_epi32(y, mul), DIV_PITCH_SHIFT);
+    return _mm512_cmpeq_epi32_mask(_mm512_mullo_epi32(qx, pitch), x) &
+           _mm512_cmpeq_epi32_mask(_mm512_mullo_epi32(qy, pitch), y);
+}
+
+static uint32_t step_lanes(SpiderBatch* b, int base) {
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i x = _mm512_load_si512(b->x + base);
+    __m512i y = _mm512_load_si512(b->y + base);
+    __m512i vx = _mm512_load_si512(b->vx + base);
+    __m512i vy = _mm512_load_si512(b->vy + base);
+    __m512i intent = _mm512_load_si512(b->intent + base);
+    __m512i state = _mm512_load_si512(b->state + base);
+
+    __m512i nx = _mm512_min_epi32(_mm512_max_epi32(_mm512_add_epi32(x, vx), zero), _mm512_set1_epi32(b->max_x));
+    __m512i ny = _mm512_min_epi32(_mm512_max_epi32(_mm512_add_epi32(y, vy), zero), _mm512_set1_epi32(b->max_y));
+
+    __mmask16 still = _mm512_cmpeq_epi32_mask(_mm512_or_si512(vx, vy), zero);
+    __mmask16 slow = on_vertex_512(x, y) | on_vertex_512(nx, ny) |
+                     _mm512_cmpneq_epi32_mask(intent, zero) |
+                     _mm512_cmpeq_epi32_mask(state, _mm512_set1_epi32(SPIDER_IDLE_ON_CLAIMED)) |
+                     (still & _mm512_cmpeq_epi32_mask(state, _mm512_set1_epi32(SPIDER_MOVING_ON_CLAIMED)));
+    _mm512_mask_store_epi32(b->x + base, (__mmask16)~slow, nx);
+    _mm512_mask_store_epi32(b->y + base, (__mmask16)~slow, ny);
+    return slow;
+}
+
+#elif defined(__AVX2__)
+
+static __m256i on_vertex_256(__m256i x, __m256i y) {
+    const __m256i mul = _mm256_set1_epi32(DIV_PITCH_MUL);
+    const __m256i pitch = _mm256_set1_epi32(CELL_PITCH);
+    __m256i qx = _mm256_srli_epi32(_mm256_mullo_epi32(x, mul), DIV_PITCH_SHIFT);
+    __m256i qy = _mm256_srli_epi32(_mm256_mullo_epi32(y, mul), DIV_PITCH_SHIFT);
+    return _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_mullo_epi32(qx, pitch), x),
+                            _mm256_cmpeq_epi32(_mm256_mullo_epi32(qy, pitch), y));
+}
+
+static uint32_t step_lanes(SpiderBatch* b, int base) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i x = _mm256_load_si256((const __m256i*)(b->x + base));
+    __m256i y = _mm256_load_si256((const __m256i*)(b->y + base));
+    __m256i vx = _mm256_load_si256((const __m256i*)(b->vx + base));
+    __m256i vy = _mm256_load_si256((const __m256i*)(b->vy + base));
+    __m256i intent = _mm256_load_si256((const __m256i*)(b->intent + base));
+    __m256i state = _mm256_load_si256((const __m256i*)(b->state + base));
+
+    __m256i nx = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(x, vx), zero), _mm256_set1_epi32(b->max_x));
+    __m256i ny = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(y, vy), zero), _mm256_set1_epi32(b->max_y));
+
+    __m256i still = _mm256_cmpeq_epi32(_mm256_or_si256(vx, vy), zero);
+    __m256i moving = _mm256_cmpeq_epi32(state, _mm256_set1_epi32(SPIDER_MOVING_ON_CLAIMED));
+    __m256i slow = _mm256_or_si256(on_vertex_256(x, y), on_vertex_256(nx, ny));
+    slow = _mm256_or_si256(slow, _mm256_xor_si256(_mm256_cmpeq_epi32(intent, zero), _mm256_set1_epi32(-1)));
+    slow = _mm256_or_si256(slow, _mm256_cmpeq_epi32(state, _mm256_set1_epi32(SPIDER_IDLE_ON_CLAIMED)));
+    slow = _mm256_or_si256(slow, _mm256_and_si256(still, moving));
+
+    // Slow lanes keep their old position for update_spider
+    _mm256_store_si256((__m256i*)(b->x + base), _mm256_blendv_epi8(nx, x, slow));
+    _mm256_store_si256((__m256i*)(b->y + base), _mm256_blendv_epi8(ny, y, slow));
+    return (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(slow));
+}
+
+#else
+
+static uint32_t step_lanes(SpiderBatch* b, int base) {
+    uint32_t slow = 0;
+    for (int i = 0; i < SPIDER_BATCH_WIDTH; i++) {
+        int lane = base + i;
+        int32_t x = b->x[lane], y = b->y[lane], vx = b->vx[lane], vy = b->vy[lane];
+        int32_t nx = x + vx, ny = y + vy;
+        nx = nx < 0 ? 0 : nx > b->max_x ? b->max_x : nx;
+        ny = ny < 0 ? 0 : ny > b->max_y ? b->max_y : ny;
+        bool on_vertex = x % CELL_PITCH == 0 && y % CELL_PITCH == 0;
+        bool next_on_vertex = nx % CELL_PITCH == 0 && ny % CELL_PITCH == 0;
+        if (on_vertex || next_on_vertex || b->intent[lane] || b->state[lane] == SPIDER_IDLE_ON_CLAIMED ||
+            (b->state[lane] == SPIDER_MOVING_ON_CLAIMED && vx == 0 && vy == 0)) {
+            slow |= 1u << i;
+        } else {
+            b->x[lane] = nx;
+            b->y[lane] = ny;
+        }
+    }
+    return slow;
+}
+
+#endif
+// --- END: Vector Step ---
+
+static int lowest_bit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    int i = 0;
+    while (!(mask & 1)) { mask >>= 1; i++; }
+    return i;
+#endif
+}
+
+void spider_batch_tick(SpiderBatch* b, SpiderBatchSteer steer, void* ctx) {
+    for (int base = 0; base < b->lanes; base += SPIDER_BATCH_WIDTH) {
+        uint32_t slow = step_lanes(b, base);
+        while (slow) {
+            int lane = base + lowest_bit(slow);
+            slow &= slow - 1;
+            if (lane >= b->count) continue;
+
+            Game* g = b->games[lane];
+            store_lane(b, lane);
+            if (steer && is_spider_on_cross_section(g)) steer(g, lane, ctx);
+            update_spider(g);
+            load_lane(b, lane);
+            b->scalar_ticks++;
+        }
+    }
+}
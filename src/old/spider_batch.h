@@ -0,0 +1,58 @@
+#ifndef SPIDER_BATCH_H
+#define SPIDER_BATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+
+// update_spider for many games in lockstep, SPIDER_BATCH_WIDTH games per instruction.
+//
+// Between vertices a tick is nothing but a position add and a clamp, the same for
+// every game, so the hot spider fields live here as structure-of-arrays and are
+// stepped with AVX-512 (16 lanes) or AVX2 (8 lanes) when the compiler targets them
+// (-mavx512f / -mavx2), plain C otherwise. A lane that starts or ends the tick on a
+// vertex, has an intent queued or is idle takes the scalar path instead: its
+// fields are written back to its Game, the steer callback and update_spider run on
+// it as usual (claims included), and the result is read back.
+//
+// While a batch runs, spider_x/y and spider_vx/vy in the Games are stale; call
+// spider_batch_store before reading them and spider_batch_load after changing
+// them (or intents) from outside the steer callback.
+
+#if defined(__AVX512F__)
+#define SPIDER_BATCH_WIDTH 16
+#else
+#define SPIDER_BATCH_WIDTH 8
+#endif
+
+// Called for a lane at the start of every tick it spends on a vertex, right
+// before its update_spider; the place to set input intents
+typedef void (*SpiderBatchSteer)(Game* g, int lane, void* ctx);
+
+typedef struct {
+    int count;        // Games
+    int lanes;        // count rounded up to SPIDER_BATCH_WIDTH; the extra lanes never move
+    Game** games;
+    int32_t* x;       // Spider position in pixels
+    int32_t* y;
+    int32_t* vx;      // Spider velocity
+    int32_t* vy;
+    int32_t* intent;  // Non-zero while an input intent is queued
+    int32_t* state;   // SpiderState
+    int32_t max_x, max_y;
+    void* block;
+    uint64_t scalar_ticks; // Lane ticks that went through update_spider, for tuning
+} SpiderBatch;
+
+// Batches `count` games, which must all have the same board size. False if out of memory.
+bool spider_batch_init(SpiderBatch* b, Game** games, int count);
+void spider_batch_free(SpiderBatch* b);
+
+// Game -> batch and batch -> Game for every lane
+void spider_batch_load(SpiderBatch* b);
+void spider_batch_store(const SpiderBatch* b);
+
+// One update_spider for every game; steer may be NULL
+void spider_batch_tick(SpiderBatch* b, SpiderBatchSteer steer, void* ctx);
+
+#endif // SPIDER_BATCH_H
@@ -0,0 +1,109 @@
+#include "trace.h"
+
+#ifdef MAMBA_TRACE
+
+#include <stdio.h>
+#include "platform.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define TRACE_USE_RDTSC 1
+#endif
+
+typedef enum { TRACE_EVENT_ZONE, TRACE_EVENT_COUNTERS } TraceEventType;
+
+typedef struct {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    uint32_t counters[TRACE_COUNTER_COUNT];
+    uint32_t thread;   // platform_thread_id of zones
+    uint8_t type;
+} TraceEvent;
+
+static const char* const counter_names[TRACE_COUNTER_COUNT] = {
+    "cells_filled", "snakes_stepped", "blits"
+};
+
+static TraceEvent trace_ring[TRACE_RING_SIZE];
+static unsigned trace_next; // Total events ever written; atomic so worker threads can record too
+static uint64_t trace_origin;
+static double trace_ticks_per_us = 1000.0; // platform_time_ns fallback: ns per us
+
+uint32_t trace_counters[TRACE_COUNTER_COUNT];
+
+uint64_t trace_now(void) {
+#ifdef TRACE_USE_RDTSC
+    return __rdtsc();
+#else
+    return platform_time_ns();
+#endif
+}
+
+void trace_init(void) {
+#ifdef TRACE_USE_RDTSC
+    // Calibrate the TSC against the monotonic clock over ~20 ms
+    uint64_t ns0 = platform_time_ns(), tsc0 = __rdtsc();
+    platform_sleep_ms(20);
+    uint64_t ns1 = platform_time_ns(), tsc1 = __rdtsc();
+    trace_ticks_per_us = (double)(tsc1 - tsc0) * 1000.0 / (double)(ns1 - ns0);
+#endif
+    trace_origin = trace_now();
+}
+
+static TraceEvent* next_event(void) {
+    unsigned index = platform_atomic_add(&trace_next, 1) - 1;
+    return &trace_ring[index % TRACE_RING_SIZE];
+}
+
+void trace_zone_end(const TraceZone* zone) {
+    uint64_t end = trace_now();
+    TraceEvent* e = next_event();
+    e->type = TRACE_EVENT_ZONE;
+    e->name = zone->name;
+    e->start = zone->start;
+    e->end = end;
+    e->thread = platform_thread_id();
+}
+
+void trace_tick(void) {
+    TraceEvent* e = next_event();
+    e->type = TRACE_EVENT_COUNTERS;
+    e->name = "tick";
+    e->start = e->end = trace_now();
+    for (int i = 0; i < TRACE_COUNTER_COUNT; i++) {
+        e->counters[i] = (uint32_t)platform_atomic_exchange(&trace_counters[i], 0);
+    }
+}
+
+static double to_us(uint64_t t) {
+    return t < trace_origin ? 0.0 : (double)(t - trace_origin) / trace_ticks_per_us;
+}
+
+int trace_write_chrome_json(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return 0;
+
+    unsigned total = platform_atomic_load(&trace_next);
+    unsigned first = total > TRACE_RING_SIZE ? total - TRACE_RING_SIZE : 0;
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (unsigned i = first; i < total; i++) {
+        const TraceEvent* e = &trace_ring[i % TRACE_RING_SIZE];
+        const char* sep = i + 1 < total ? "," : "";
+        if (e->type == TRACE_EVENT_ZONE) {
+            fprintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                    e->name, e->thread, to_us(e->start), (double)(e->end - e->start) / trace_ticks_per_us, sep);
+        } else {
+            fprintf(f, "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{", e->name, to_us(e->start));
+            for (int c = 0; c < TRACE_COUNTER_COUNT; c++) {
+                fprintf(f, "%s\"%s\":%u", c ? "," : "", counter_names[c], e->counters[c]);
+            }
+            fprintf(f, "}}%s\n", sep);
+        }
+    }
+    fprintf(f, "]}\n");
+    return fclose(f) == 0;
+}
+
+#endif // MAMBA_TRACE
@@ -0,0 +1,68 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "platform.h"
+
+// Profiling zones and per-tick counters, exported as Chrome trace JSON
+// (load the file in chrome://tracing or ui.perfetto.dev).
+//
+// Everything here compiles to nothing unless MAMBA_TRACE is defined, so release
+// builds carry no cost. Zones are explicit begin/end pairs:
+//
+//     TRACE_ZONE_BEGIN(zone, "attempt_claim_territory");
+//     ...
+//     TRACE_ZONE_END(zone);
+//
+// Each zone goes on the track of the thread that ran it. Counters are
+// shared by all threads and added to atomically; a tick's counter event holds
+// what every thread counted since the previous tick.
+//
+// Timestamps come from RDTSC on x86 gcc/clang builds (calibrated against the
+// monotonic clock at trace_init) and from platform_time_ns everywhere else.
+
+typedef enum {
+    TRACE_COUNTER_CELLS_FILLED,
+    TRACE_COUNTER_SNAKES_STEPPED,
+    TRACE_COUNTER_BLITS,
+    TRACE_COUNTER_COUNT
+} TraceCounter;
+
+#define TRACE_RING_SIZE 65536 // Events kept; older ones are overwritten
+
+#ifdef MAMBA_TRACE
+
+typedef struct {
+    const char* name;
+    uint64_t start;
+} TraceZone;
+
+void trace_init(void);
+uint64_t trace_now(void);
+void trace_zone_end(const TraceZone* zone);
+// Closes the current tick: records the counters as a counter event and resets them,
+// each in one atomic exchange, so counts from other threads go to one tick or the next.
+void trace_tick(void);
+int trace_write_chrome_json(const char* path);
+
+extern uint32_t trace_counters[TRACE_COUNTER_COUNT];
+
+#define TRACE_INIT() trace_init()
+#define TRACE_ZONE_BEGIN(var, zone_name) TraceZone var = { (zone_name), trace_now() }
+#define TRACE_ZONE_END(var) trace_zone_end(&(var))
+#define TRACE_COUNT(counter, n) ((void)platform_atomic_add(&trace_counters[(counter)], (n)))
+#define TRACE_TICK() trace_tick()
+#define TRACE_WRITE(path) trace_write_chrome_json(path)
+
+#else
+
+#define TRACE_INIT() ((void)0)
+#define TRACE_ZONE_BEGIN(var, zone_name) ((void)0)
+#define TRACE_ZONE_END(var) ((void)0)
+#define TRACE_COUNT(counter, n) ((void)0)
+#define TRACE_TICK() ((void)0)
+#define TRACE_WRITE(path) ((void)0)
+
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,23 @@
+#include "triple_buffer.h"
+
+#include "platform.h"
+
+void triple_buffer_init(TripleBuffer* t) {
+    t->write = 0;
+    t->middle = 1;
+    t->read = 2;
+}
+
+int triple_buffer_publish(TripleBuffer* t) {
+    int previous = platform_atomic_exchange(&t->middle, t->write | TRIPLE_BUFFER_FRESH);
+    t->write = previous & ~TRIPLE_BUFFER_FRESH;
+    return t->write;
+}
+
+bool triple_buffer_acquire(TripleBuffer* t) {
+    if (!(platform_atomic_load(&t->middle) & TRIPLE_BUFFER_FRESH)) return false;
+    // Only the writer sets the flag, so it is still there and this takes it with the slot
+    int previous = platform_atomic_exchange(&t->middle, t->read);
+    t->read = previous & ~TRIPLE_BUFFER_FRESH;
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <stdbool.h>
+
+// Hands whole values (frames, snapshots) from one writer thread to one reader
+// thread without either ever waiting for the other.
+//
+// The caller keeps three slots; the buffer only tracks which is which. The
+// writer fills its slot and publishes it, getting back the one that was
+// waiting in the middle, which the reader had not taken (or had let go). The
+// reader takes the middle slot only if something newer was published since, so
+// it always sees the latest value and skips the ones it was too slow for. A slot
+// stays untouched by the writer from its publish until the reader lets it go, so
+// the reader can use it in place for as long as it likes.
+
+#define TRIPLE_BUFFER_FRESH 4 // In `middle`: published since the reader last took it
+
+typedef struct {
+    int write;  // Slot the writer fills; writer only
+    int middle; // Slot in between, plus TRIPLE_BUFFER_FRESH; atomic
+    int read;   // Slot the reader holds; reader only
+} TripleBuffer;
+
+// Slots 0, 1, 2 to the writer, the middle and the reader; nothing published yet
+void triple_buffer_init(TripleBuffer* t);
+// Writer: publishes slot t->write and moves on to the one returned (the new t->write)
+int triple_buffer_publish(TripleBuffer* t);
+// Reader: moves t->read to the newest published slot; false if there was none newer
+bool triple_buffer_acquire(TripleBuffer* t);
+
+#endif // TRIPLE_BUFFER_H
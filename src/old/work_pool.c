@@ -0,0 +1,113 @@
+#include "work_pool.h"
+
+#include <stdbool.h>
+#include "platform.h"
+
+// One worker's remaining jobs, begin in the low and end in the high 32 bits,
+// padded to a cache line so stealing doesn't slow down the owner's neighbours
+typedef struct {
+    volatile uint64_t range;
+    uint8_t pad[64 - sizeof(uint64_t)];
+} WorkSlice;
+
+typedef struct WorkPool WorkPool;
+
+typedef struct {
+    WorkPool* pool;
+    int index;
+} WorkerArg;
+
+struct WorkPool {
+    WorkSlice slices[WORK_POOL_MAX_THREADS];
+    WorkerArg args[WORK_POOL_MAX_THREADS];
+    int threads;
+    WorkPoolFn fn;
+    void* ctx;
+};
+
+static uint64_t pack_range(uint32_t begin, uint32_t end) {
+    return (uint64_t)end << 32 | begin;
+}
+
+// Takes the front job of the worker's own slice; false when the slice is empty
+static bool pop_own(WorkSlice* slice, int* job) {
+    for (;;) {
+        uint64_t range = platform_atomic_load(&slice->range);
+        uint32_t begin = (uint32_t)range, end = (uint32_t)(range >> 32);
+        if (begin >= end) return false;
+        if (platform_atomic_cas64(&slice->range, range, pack_range(begin + 1, end))) {
+            *job = (int)begin;
+            return true;
+        }
+    }
+}
+
+// Moves the back half of the fullest other slice into worker `self`'s (empty) slice
+static bool steal(WorkPool* pool, int self) {
+    for (;;) {
+        int victim = -1;
+        uint64_t victim_range = 0;
+        uint32_t most = 0;
+        for (int i = 0; i < pool->threads; i++) {
+            if (i == self) continue;
+            uint64_t range = platform_atomic_load(&pool->slices[i].range);
+            uint32_t begin = (uint32_t)range, end = (uint32_t)(range >> 32);
+            if (end > begin && end - begin > most) {
+                most = end - begin;
+                victim = i;
+                victim_range = range;
+            }
+        }
+        if (victim < 0) return false; // Jobs are only ever split, so nothing new will show up
+
+        uint32_t begin = (uint32_t)victim_range, end = (uint32_t)(victim_range >> 32);
+        uint32_t mid = begin + (end - begin) / 2;
+        if (platform_atomic_cas64(&pool->slices[victim].range, victim_range, pack_range(begin, mid))) {
+            platform_atomic_store(&pool->slices[self].range, pack_range(mid, end));
+            return true;
+        }
+    }
+}
+
+static void worker_main(void* arg) {
+    WorkerArg* worker = arg;
+    WorkPool* pool = worker->pool;
+    int job;
+    do {
+        while (pop_own(&pool->slices[worker->index], &job)) {
+            pool->fn(pool->ctx, job, worker->index);
+        }
+    } while (steal(pool, worker->index));
+}
+
+void work_pool_run(int threads, int count, WorkPoolFn fn, void* ctx) {
+    if (count <= 0) return;
+    if (threads <= 0) threads = platform_cpu_count();
+    if (threads > WORK_POOL_MAX_THREADS) threads = WORK_POOL_MAX_THREADS;
+    if (threads > count) threads = count;
+
+    if (threads == 1) {
+        for (int i = 0; i < count; i++) fn(ctx, i, 0);
+        return;
+    }
+
+    WorkPool pool; // About 5 KB; each run has its own, so runs may nest or overlap
+    pool.threads = threads;
+    pool.fn = fn;
+    pool.ctx = ctx;
+    for (int i = 0; i < threads; i++) {
+        uint32_t begin = (uint32_t)((int64_t)count * i / threads);
+        uint32_t end = (uint32_t)((int64_t)count * (i + 1) / threads);
+        pool.slices[i].range = pack_range(begin, end);
+        pool.args[i].pool = &pool;
+        pool.args[i].index = i;
+    }
+
+    PlatformThread handles[WORK_POOL_MAX_THREADS] = {{0}};
+    for (int i = 1; i < threads; i++) {
+        // A worker that fails to start leaves its slice to be stolen by the others
+        platform_thread_start(&handles[i], worker_main, &pool.args[i]);
+    }
+    worker_main(&pool.args[0]);
+    for (int i = 1; i < threads; i++) platform_thread_join(&handles[i]);
+}
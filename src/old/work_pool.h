@@ -0,0 +1,23 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <stdint.h>
+
+// Parallel for-loop over independent jobs (whole games, rollouts, tiles).
+//
+// Each worker starts with an equal slice of the index range and takes jobs from
+// its front; a worker that runs dry steals the back half of the largest slice
+// left. Slices are (begin, end) pairs in one 64-bit word updated by compare-and-
+// swap, so nothing ever blocks and uneven job lengths still keep every core busy.
+
+#define WORK_POOL_MAX_THREADS 64
+
+// fn(ctx, index, worker) for every index in [0, count); worker is 0..threads-1, so
+// callers can keep per-worker scratch without locking
+typedef void (*WorkPoolFn)(void* ctx, int index, int worker);
+
+// Runs all jobs on `threads` threads (0 = one per processor) and returns when they
+// are done. The calling thread is worker 0.
+void work_pool_run(int threads, int count, WorkPoolFn fn, void* ctx);
+
+#endif // WORK_POOL_H